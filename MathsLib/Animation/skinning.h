@@ -0,0 +1,260 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Containers/vec4.h"
+#include "../Containers/mat4.h"
+#include "../Containers/quat.h"
+#include "../Containers/dualquat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/lanes.h"
+#include "../Utils/parallel.h"
+#include "../Utils/scalar.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Maths::Animation {
+
+	using namespace Maths::Containers;
+
+	// Four joint indices into the palette and their weights, which should sum to one
+	template <typename T>
+	struct skin_influence
+	{
+		uint32_t Joints[4];
+		T Weights[4];
+	};
+
+	// Dual quaternion skinning. normals and outNormals may be null when only positions
+	// are needed. Vertices are split into ranges across threads, and float vertices are
+	// skinned four at a time in SSE lanes, bit-identical to the scalar path.
+	template <typename T>
+	void SkinDualQuat(const dualquat<T>* palette, const skin_influence<T>* influences,
+		const vec3<T>* positions, const vec3<T>* normals, size_t count,
+		vec3<T>* outPositions, vec3<T>* outNormals);
+
+	// Linear blend skinning over a mat4 palette, kept as the reference the dual
+	// quaternion path is compared against. Its per-vertex body is a 16-wide weighted sum
+	// the compiler already vectorises across the matrix elements.
+	template <typename T>
+	void SkinLinear(const mat4<T>* palette, const skin_influence<T>* influences,
+		const vec3<T>* positions, const vec3<T>* normals, size_t count,
+		vec3<T>* outPositions, vec3<T>* outNormals);
+
+	namespace Detail {
+
+		// joints[i] is the i-th influence's dual quaternion as Real XYZW then Dual XYZW;
+		// p and n are XYZ, and n is null when there are no normals
+		template <typename L>
+		void BlendDualQuat(const L (&joints)[4][8], const L* weights, const L* p, const L* n, L* outP, L* outN)
+		{
+			const L* pivot = joints[0];
+
+			L r[4] = { L(0.0f), L(0.0f), L(0.0f), L(0.0f) };
+			L d[4] = { L(0.0f), L(0.0f), L(0.0f), L(0.0f) };
+			for (int i = 0; i < 4; i++)
+			{
+				const L* dq = joints[i];
+
+				// Keep every joint in the same hemisphere as the first so the blend takes the short path
+				L dot = pivot[0] * dq[0] + pivot[1] * dq[1] + pivot[2] * dq[2] + pivot[3] * dq[3];
+				L w = Utils::Select(Utils::Less(dot, L(0.0f)), -weights[i], weights[i]);
+
+				for (int c = 0; c < 4; c++)
+				{
+					r[c] = r[c] + dq[c] * w;
+					d[c] = d[c] + dq[4 + c] * w;
+				}
+			}
+
+			L invLength = L(1.0f) / Utils::Sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+			for (int c = 0; c < 4; c++)
+			{
+				r[c] = r[c] * invLength;
+				d[c] = d[c] * invLength;
+			}
+			L rx = r[0], ry = r[1], rz = r[2], rw = r[3];
+			L dx = d[0], dy = d[1], dz = d[2], dw = d[3];
+
+			// Translation part: 2 * (rw * d.xyz - dw * r.xyz + r.xyz x d.xyz)
+			L tx = L(2.0f) * (rw * dx - dw * rx + ry * dz - rz * dy);
+			L ty = L(2.0f) * (rw * dy - dw * ry + rz * dx - rx * dz);
+			L tz = L(2.0f) * (rw * dz - dw * rz + rx * dy - ry * dx);
+
+			// Rotation part: p + 2 * r.xyz x (r.xyz x p + rw * p)
+			L cx = ry * p[2] - rz * p[1] + rw * p[0];
+			L cy = rz * p[0] - rx * p[2] + rw * p[1];
+			L cz = rx * p[1] - ry * p[0] + rw * p[2];
+			outP[0] = p[0] + L(2.0f) * (ry * cz - rz * cy) + tx;
+			outP[1] = p[1] + L(2.0f) * (rz * cx - rx * cz) + ty;
+			outP[2] = p[2] + L(2.0f) * (rx * cy - ry * cx) + tz;
+
+			if (n)
+			{
+				cx = ry * n[2] - rz * n[1] + rw * n[0];
+				cy = rz * n[0] - rx * n[2] + rw * n[1];
+				cz = rx * n[1] - ry * n[0] + rw * n[2];
+				outN[0] = n[0] + L(2.0f) * (ry * cz - rz * cy);
+				outN[1] = n[1] + L(2.0f) * (rz * cx - rx * cz);
+				outN[2] = n[2] + L(2.0f) * (rx * cy - ry * cx);
+			}
+		}
+
+		template <typename T>
+		const T* Components(const dualquat<T>& dq, int c)
+		{
+			const quat<T>& q = c < 4 ? dq.Real : dq.Dual;
+			switch (c & 3)
+			{
+			case 0: return &q.X;
+			case 1: return &q.Y;
+			case 2: return &q.Z;
+			default: return &q.W;
+			}
+		}
+
+		// Skins [begin, end): four vertices per lanes4 for float, the rest one at a time
+		template <typename T>
+		void SkinDualQuatRange(const dualquat<T>* palette, const skin_influence<T>* influences,
+			const vec3<T>* positions, const vec3<T>* normals, size_t begin, size_t end,
+			vec3<T>* outPositions, vec3<T>* outNormals)
+		{
+			bool withNormals = normals && outNormals;
+
+			size_t v = begin;
+#ifdef MATHS_SSE
+			if constexpr (std::is_same_v<T, float>)
+			{
+				for (; v + 4 <= end; v += 4)
+				{
+					const skin_influence<T>* s = influences + v;
+					const vec3<T>* p = positions + v;
+
+					Utils::lanes4 joints[4][8], weights[4], position[3], normal[3], outPosition[3], outNormal[3];
+					for (int i = 0; i < 4; i++)
+					{
+						const dualquat<T>& j0 = palette[s[0].Joints[i]];
+						const dualquat<T>& j1 = palette[s[1].Joints[i]];
+						const dualquat<T>& j2 = palette[s[2].Joints[i]];
+						const dualquat<T>& j3 = palette[s[3].Joints[i]];
+						for (int c = 0; c < 8; c++)
+							joints[i][c] = Utils::Gather(Components(j0, c), Components(j1, c), Components(j2, c), Components(j3, c));
+						weights[i] = Utils::Gather(&s[0].Weights[i], &s[1].Weights[i], &s[2].Weights[i], &s[3].Weights[i]);
+					}
+					position[0] = Utils::Gather(&p[0].X, &p[1].X, &p[2].X, &p[3].X);
+					position[1] = Utils::Gather(&p[0].Y, &p[1].Y, &p[2].Y, &p[3].Y);
+					position[2] = Utils::Gather(&p[0].Z, &p[1].Z, &p[2].Z, &p[3].Z);
+
+					if (withNormals)
+					{
+						const vec3<T>* n = normals + v;
+						normal[0] = Utils::Gather(&n[0].X, &n[1].X, &n[2].X, &n[3].X);
+						normal[1] = Utils::Gather(&n[0].Y, &n[1].Y, &n[2].Y, &n[3].Y);
+						normal[2] = Utils::Gather(&n[0].Z, &n[1].Z, &n[2].Z, &n[3].Z);
+					}
+
+					BlendDualQuat(joints, weights, position, withNormals ? normal : nullptr, outPosition, outNormal);
+
+					vec3<T>* op = outPositions + v;
+					Utils::Scatter(outPosition[0], &op[0].X, &op[1].X, &op[2].X, &op[3].X);
+					Utils::Scatter(outPosition[1], &op[0].Y, &op[1].Y, &op[2].Y, &op[3].Y);
+					Utils::Scatter(outPosition[2], &op[0].Z, &op[1].Z, &op[2].Z, &op[3].Z);
+
+					if (withNormals)
+					{
+						vec3<T>* on = outNormals + v;
+						Utils::Scatter(outNormal[0], &on[0].X, &on[1].X, &on[2].X, &on[3].X);
+						Utils::Scatter(outNormal[1], &on[0].Y, &on[1].Y, &on[2].Y, &on[3].Y);
+						Utils::Scatter(outNormal[2], &on[0].Z, &on[1].Z, &on[2].Z, &on[3].Z);
+					}
+				}
+			}
+#endif
+			for (; v < end; v++)
+			{
+				const skin_influence<T>& influence = influences[v];
+
+				T joints[4][8];
+				for (int i = 0; i < 4; i++)
+				{
+					const dualquat<T>& joint = palette[influence.Joints[i]];
+					for (int c = 0; c < 8; c++)
+						joints[i][c] = *Components(joint, c);
+				}
+
+				const vec3<T>& p = positions[v];
+				T position[3] = { p.X, p.Y, p.Z };
+				T normal[3], outPosition[3], outNormal[3];
+				if (withNormals)
+				{
+					const vec3<T>& n = normals[v];
+					normal[0] = n.X;
+					normal[1] = n.Y;
+					normal[2] = n.Z;
+				}
+
+				BlendDualQuat(joints, influence.Weights, position, withNormals ? normal : nullptr, outPosition, outNormal);
+
+				outPositions[v] = vec3<T>(outPosition[0], outPosition[1], outPosition[2]);
+				if (withNormals)
+					outNormals[v] = vec3<T>(outNormal[0], outNormal[1], outNormal[2]);
+			}
+		}
+
+	}
+
+	template <typename T>
+	void SkinDualQuat(const dualquat<T>* palette, const skin_influence<T>* influences,
+		const vec3<T>* positions, const vec3<T>* normals, size_t count,
+		vec3<T>* outPositions, vec3<T>* outNormals)
+	{
+		MATHS_PROFILE_KERNEL("SkinDualQuat", count, count * (sizeof(skin_influence<T>) + 4 * sizeof(vec3<T>)));
+
+		Utils::ParallelFor(count, 4096, [=](size_t begin, size_t end)
+		{
+			Detail::SkinDualQuatRange(palette, influences, positions, normals, begin, end, outPositions, outNormals);
+		});
+	}
+
+	template <typename T>
+	void SkinLinear(const mat4<T>* palette, const skin_influence<T>* influences,
+		const vec3<T>* positions, const vec3<T>* normals, size_t count,
+		vec3<T>* outPositions, vec3<T>* outNormals)
+	{
+		MATHS_PROFILE_KERNEL("SkinLinear", count, count * (sizeof(skin_influence<T>) + 4 * sizeof(vec3<T>)));
+
+		Utils::ParallelFor(count, 4096, [=](size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				const skin_influence<T>& influence = influences[v];
+
+				T m[16] = {};
+				for (int i = 0; i < 4; i++)
+				{
+					const T* joint = palette[influence.Joints[i]].Elements;
+					T w = influence.Weights[i];
+					for (int e = 0; e < 16; e++)
+						m[e] += joint[e] * w;
+				}
+
+				const vec3<T>& p = positions[v];
+				outPositions[v] = vec3<T>(
+					m[0] * p.X + m[4] * p.Y + m[8] * p.Z + m[12],
+					m[1] * p.X + m[5] * p.Y + m[9] * p.Z + m[13],
+					m[2] * p.X + m[6] * p.Y + m[10] * p.Z + m[14]);
+
+				if (normals && outNormals)
+				{
+					const vec3<T>& n = normals[v];
+					outNormals[v] = vec3<T>(
+						m[0] * n.X + m[4] * n.Y + m[8] * n.Z,
+						m[1] * n.X + m[5] * n.Y + m[9] * n.Z,
+						m[2] * n.X + m[6] * n.Y + m[10] * n.Z).Normalise();
+				}
+			}
+		});
+	}
+
+}
\ No newline at end of file
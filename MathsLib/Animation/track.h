@@ -0,0 +1,311 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Containers/vec4.h"
+#include "../Containers/mat4.h"
+#include "../Containers/quat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/lanes.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Maths::Animation {
+
+	using namespace Maths::Containers;
+
+	enum class interpolation
+	{
+		Step,
+		Linear,		// Lerp for vectors, slerp for quaternions
+		Cubic		// Cubic Hermite using the per-key in/out tangents
+	};
+
+	// Keyframe track stored as parallel arrays (structure of arrays). InTangents and
+	// OutTangents are only read for cubic tracks and must then be the same size as Values.
+	//
+	// A track holds no playback state, so one track can be sampled from several threads.
+	// Each playback instead owns a cursor: the index of the key that started its last
+	// sampled segment. Playback is almost always monotonic so the next sample is usually
+	// in the same or the following segment, which avoids the binary search. Cursors start
+	// at 0 and any value is valid.
+	template <typename V, typename T = float>
+	struct track
+	{
+		std::vector<T> Times;
+		std::vector<V> Values;
+		std::vector<V> InTangents;
+		std::vector<V> OutTangents;
+		interpolation Interpolation = interpolation::Linear;
+
+		void AddKey(T time, const V& value);
+		void AddKey(T time, const V& value, const V& inTangent, const V& outTangent);
+
+		// Index of the key starting the segment that contains time, updating cursor
+		size_t FindSegment(T time, size_t& cursor) const;
+
+		V Sample(T time, size_t& cursor) const;
+
+		// Without a cursor every call does the binary search
+		V Sample(T time) const;
+
+		T StartTime() const;
+		T EndTime() const;
+	};
+
+	namespace Detail {
+
+		// Lerp and Hermite also take lanes4 for V and T, interpolating one component of
+		// four tracks at once with the same operations as the scalar path
+		template <typename V, typename T>
+		V Lerp(const V& a, const V& b, T t)
+		{
+			return a * (T(1) - t) + b * t;
+		}
+
+		template <typename T>
+		quat<T> Lerp(const quat<T>& a, const quat<T>& b, T t)
+		{
+			return quat<T>::Slerp(a, b, t);
+		}
+
+		template <typename V, typename T>
+		V Hermite(const V& p0, const V& m0, const V& p1, const V& m1, T t, T dt)
+		{
+			T t2 = t * t;
+			T t3 = t2 * t;
+			T h00 = T(2) * t3 - T(3) * t2 + T(1);
+			T h10 = t3 - T(2) * t2 + t;
+			T h01 = T(-2) * t3 + T(3) * t2;
+			T h11 = t3 - t2;
+
+			return p0 * h00 + m0 * (h10 * dt) + p1 * h01 + m1 * (h11 * dt);
+		}
+
+		template <typename T>
+		quat<T> Hermite(const quat<T>& p0, const quat<T>& m0, const quat<T>& p1, const quat<T>& m1, T t, T dt)
+		{
+			vec4<T> r = Hermite(vec4<T>(p0.X, p0.Y, p0.Z, p0.W), vec4<T>(m0.X, m0.Y, m0.Z, m0.W),
+				vec4<T>(p1.X, p1.Y, p1.Z, p1.W), vec4<T>(m1.X, m1.Y, m1.Z, m1.W), t, dt);
+			return quat<T>(r.X, r.Y, r.Z, r.W).Normalise();
+		}
+
+		// Components of the values SampleTracks interpolates four tracks per lanes4: float
+		// vectors. Quaternion slerp needs acos and sin per lane, so rotations are sampled
+		// one track at a time.
+		template <typename V>
+		constexpr size_t LaneComponents = 0;
+
+		template <size_t N>
+		constexpr size_t LaneComponents<vec<N, float>> = N;
+
+#ifdef MATHS_SSE
+		// Samples four tracks in lanes4 when they share the Linear or Cubic mode and each
+		// cursor's segment still contains time, which is exactly when Sample would neither
+		// clamp nor move the cursor. Otherwise returns false without writing anything.
+		template <typename V>
+		bool SampleLanes(const track<V, float>* tracks, float time, const size_t* cursors, V* out)
+		{
+			interpolation mode = tracks[0].Interpolation;
+			if (mode == interpolation::Step)
+				return false;
+
+			const float* times[4];
+			const V* keys[4];
+			size_t segments[4];
+			for (int l = 0; l < 4; l++)
+			{
+				const track<V, float>& track = tracks[l];
+				size_t i = cursors[l];
+				if (track.Interpolation != mode || i + 1 >= track.Times.size())
+					return false;
+
+				// At or before the first key Sample returns that key rather than interpolating
+				const float* keyTimes = track.Times.data();
+				if (!(keyTimes[i] <= time && time < keyTimes[i + 1]) || time <= keyTimes[0])
+					return false;
+
+				times[l] = keyTimes + i;
+				keys[l] = track.Values.data() + i;
+				segments[l] = i;
+			}
+
+			Utils::lanes4 start = Utils::Gather(times[0], times[1], times[2], times[3]);
+			Utils::lanes4 end = Utils::Gather(times[0] + 1, times[1] + 1, times[2] + 1, times[3] + 1);
+			Utils::lanes4 dt = end - start;
+			Utils::lanes4 t = (Utils::lanes4(time) - start) / dt;
+
+			if (mode == interpolation::Linear)
+			{
+				for (size_t c = 0; c < LaneComponents<V>; c++)
+				{
+					Utils::lanes4 a = Utils::Gather(&keys[0][0][c], &keys[1][0][c], &keys[2][0][c], &keys[3][0][c]);
+					Utils::lanes4 b = Utils::Gather(&keys[0][1][c], &keys[1][1][c], &keys[2][1][c], &keys[3][1][c]);
+					Utils::Scatter(Lerp(a, b, t), &out[0][c], &out[1][c], &out[2][c], &out[3][c]);
+				}
+				return true;
+			}
+
+			// Cubic: the segment's out tangent and the next key's in tangent
+			const V* outTangents[4];
+			const V* inTangents[4];
+			for (int l = 0; l < 4; l++)
+			{
+				outTangents[l] = tracks[l].OutTangents.data() + segments[l];
+				inTangents[l] = tracks[l].InTangents.data() + segments[l] + 1;
+			}
+
+			for (size_t c = 0; c < LaneComponents<V>; c++)
+			{
+				Utils::lanes4 p0 = Utils::Gather(&keys[0][0][c], &keys[1][0][c], &keys[2][0][c], &keys[3][0][c]);
+				Utils::lanes4 m0 = Utils::Gather(&outTangents[0][0][c], &outTangents[1][0][c], &outTangents[2][0][c], &outTangents[3][0][c]);
+				Utils::lanes4 p1 = Utils::Gather(&keys[0][1][c], &keys[1][1][c], &keys[2][1][c], &keys[3][1][c]);
+				Utils::lanes4 m1 = Utils::Gather(&inTangents[0][0][c], &inTangents[1][0][c], &inTangents[2][0][c], &inTangents[3][0][c]);
+				Utils::Scatter(Hermite(p0, m0, p1, m1, t, dt), &out[0][c], &out[1][c], &out[2][c], &out[3][c]);
+			}
+			return true;
+		}
+#endif
+
+	}
+
+	template <typename V, typename T>
+	void track<V, T>::AddKey(T time, const V& value)
+	{
+		Times.push_back(time);
+		Values.push_back(value);
+	}
+
+	template <typename V, typename T>
+	void track<V, T>::AddKey(T time, const V& value, const V& inTangent, const V& outTangent)
+	{
+		Times.push_back(time);
+		Values.push_back(value);
+		InTangents.push_back(inTangent);
+		OutTangents.push_back(outTangent);
+	}
+
+	template <typename V, typename T>
+	size_t track<V, T>::FindSegment(T time, size_t& cursor) const
+	{
+		size_t count = Times.size();
+		if (count < 2 || time <= Times[0])
+			return 0;
+		if (time >= Times[count - 1])
+			return count - 2;
+
+		size_t hint = cursor < count - 1 ? cursor : 0;
+		if (Times[hint] <= time)
+		{
+			if (time < Times[hint + 1])
+				return hint;
+			if (hint + 2 < count && time < Times[hint + 2])
+				return cursor = hint + 1;
+		}
+
+		// Seek or loop: fall back to a binary search
+		size_t index = size_t(std::upper_bound(Times.begin(), Times.end(), time) - Times.begin()) - 1;
+		return cursor = index;
+	}
+
+	template <typename V, typename T>
+	V track<V, T>::Sample(T time, size_t& cursor) const
+	{
+		size_t count = Times.size();
+		if (count == 0)
+			return V();
+		if (count == 1 || time <= Times[0])
+			return Values[0];
+		if (time >= Times[count - 1])
+			return Values[count - 1];
+
+		size_t i = FindSegment(time, cursor);
+		T dt = Times[i + 1] - Times[i];
+		T t = (time - Times[i]) / dt;
+
+		switch (Interpolation)
+		{
+		case interpolation::Step:
+			return Values[i];
+		case interpolation::Cubic:
+			return Detail::Hermite(Values[i], OutTangents[i], Values[i + 1], InTangents[i + 1], t, dt);
+		default:
+			return Detail::Lerp(Values[i], Values[i + 1], t);
+		}
+	}
+
+	template <typename V, typename T>
+	V track<V, T>::Sample(T time) const
+	{
+		size_t cursor = 0;
+		return Sample(time, cursor);
+	}
+
+	template <typename V, typename T>
+	T track<V, T>::StartTime() const
+	{
+		return Times.empty() ? T(0) : Times.front();
+	}
+
+	template <typename V, typename T>
+	T track<V, T>::EndTime() const
+	{
+		return Times.empty() ? T(0) : Times.back();
+	}
+
+	// Samples every track at the same time value, with cursors[i] the caller's cursor for
+	// tracks[i]. Float vector tracks go four at a time: while their cursors still hold
+	// the segment being played, which is nearly every frame of steady playback, the
+	// weights and interpolation run in lanes4 with one division for all four. Groups that
+	// change segment, clamp or mix modes, and rotation tracks, fall back to Sample.
+	// Results are identical to calling Sample on each track.
+	template <typename V, typename T>
+	void SampleTracks(const track<V, T>* tracks, size_t count, T time, size_t* cursors, V* out)
+	{
+		MATHS_PROFILE_KERNEL("SampleTracks", count, count * sizeof(V));
+
+		size_t n = 0;
+#ifdef MATHS_SSE
+		if constexpr (std::is_same_v<T, float> && Detail::LaneComponents<V> > 0)
+		{
+			for (; n < count - count % 4; n += 4)
+			{
+				if (Detail::SampleLanes(tracks + n, time, cursors + n, out + n))
+					continue;
+
+				for (size_t l = n; l < n + 4; l++)
+					out[l] = tracks[l].Sample(time, cursors[l]);
+			}
+		}
+#endif
+		for (; n < count; n++)
+			out[n] = tracks[n].Sample(time, cursors[n]);
+	}
+
+	// Builds Translation * Rotation * Scale directly into the columns of a mat4,
+	// instead of building three matrices and multiplying them together.
+	template <typename T>
+	mat4<T> ComposeTransform(const vec3<T>& translation, const quat<T>& rotation, const vec3<T>& scale)
+	{
+		mat4<T> result = quat<T>::ToMatrix(rotation);
+
+		result.Cols[0] *= scale.X;
+		result.Cols[1] *= scale.Y;
+		result.Cols[2] *= scale.Z;
+		result.Cols[3] = vec4<T>(translation, T(1));
+
+		return result;
+	}
+
+	template <typename T>
+	void ComposeTransforms(const vec3<T>* translations, const quat<T>* rotations, const vec3<T>* scales, size_t count, mat4<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("ComposeTransforms", count, count * (2 * sizeof(vec3<T>) + sizeof(quat<T>) + sizeof(mat4<T>)));
+
+		for (size_t i = 0; i < count; i++)
+			out[i] = ComposeTransform(translations[i], rotations[i], scales[i]);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat.h"
+#include "../Utils/instrumentation.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace Maths::Containers {
+
+	// Affine transform stored as a mat4x3, four columns of vec3 (48 bytes), with an
+	// implicit last row of [0 0 0 1]. A plain mat4x3 has no such row, so its products
+	// follow the shapes and mat4x3 * mat4x3 is not defined; affine adds the operations
+	// that rely on the row. Composition needs 36 multiplies instead of the 64 of a mat4.
+	template <typename T>
+	struct affine : mat4x3<T>
+	{
+		affine();
+		affine(T diagonal);
+		affine(const vec3<T>& col0, const vec3<T>& col1, const vec3<T>& col2, const vec3<T>& col3);
+		affine(const mat4x3<T>& matrix);
+		explicit affine(const mat4<T>& matrix);
+
+		affine<T>& Multiply(const affine<T>& other);
+
+		affine<T>& operator *= (const affine<T>& other);
+
+		vec3<T> TransformPoint(const vec3<T>& point) const;
+		vec3<T> TransformDirection(const vec3<T>& direction) const;
+
+		static affine<T> Identity();
+		static affine<T> Translation(const vec3<T>& translation);
+		static affine<T> Scale(const vec3<T>& scale);
+		static affine<T> Rotation(T angle, const vec3<T>& axis);
+		static affine<T> Inverse(const affine<T>& matrix);
+		static affine<T> InverseRigid(const affine<T>& matrix);
+		static mat4<T> ToMat4(const affine<T>& matrix);
+		static mat4x3<T> ToMat4x3(const affine<T>& matrix);
+
+		friend affine<T> operator * (affine<T> lhs, const affine<T>& rhs)
+		{
+			return lhs.Multiply(rhs);
+		}
+	};
+
+	template <typename T>
+	affine<T>::affine()
+	{
+
+	}
+
+	template <typename T>
+	affine<T>::affine(T diagonal) : mat4x3<T>(diagonal)
+	{
+
+	}
+
+	template <typename T>
+	affine<T>::affine(const vec3<T>& col0, const vec3<T>& col1, const vec3<T>& col2, const vec3<T>& col3) : mat4x3<T>(col0, col1, col2, col3)
+	{
+
+	}
+
+	template <typename T>
+	affine<T>::affine(const mat4x3<T>& matrix) : mat4x3<T>(matrix)
+	{
+
+	}
+
+	// Drops the last row, which must be [0 0 0 1] for the result to be exact
+	template <typename T>
+	affine<T>::affine(const mat4<T>& matrix) : mat4x3<T>(matrix)
+	{
+
+	}
+
+	template <typename T>
+	affine<T>& affine<T>::Multiply(const affine<T>& other)
+	{
+		const T* a = this->Elements;
+		const T* b = other.Elements;
+		T data[12];
+
+		for (int col = 0; col < 4; col++)
+		{
+			for (int row = 0; row < 3; row++)
+				data[col * 3 + row] = a[row] * b[col * 3] + a[3 + row] * b[col * 3 + 1] + a[6 + row] * b[col * 3 + 2];
+		}
+
+		// The implicit bottom row of other contributes our translation to its last column
+		data[9] += a[9];
+		data[10] += a[10];
+		data[11] += a[11];
+
+		memcpy(this->Elements, data, 12 * sizeof(T));
+		return *this;
+	}
+
+	template <typename T>
+	affine<T>& affine<T>::operator *= (const affine<T>& other)
+	{
+		return Multiply(other);
+	}
+
+	template <typename T>
+	vec3<T> affine<T>::TransformPoint(const vec3<T>& point) const
+	{
+		const T* m = this->Elements;
+		return vec3<T>(
+			m[0] * point.X + m[3] * point.Y + m[6] * point.Z + m[9],
+			m[1] * point.X + m[4] * point.Y + m[7] * point.Z + m[10],
+			m[2] * point.X + m[5] * point.Y + m[8] * point.Z + m[11]);
+	}
+
+	template <typename T>
+	vec3<T> affine<T>::TransformDirection(const vec3<T>& direction) const
+	{
+		const T* m = this->Elements;
+		return vec3<T>(
+			m[0] * direction.X + m[3] * direction.Y + m[6] * direction.Z,
+			m[1] * direction.X + m[4] * direction.Y + m[7] * direction.Z,
+			m[2] * direction.X + m[5] * direction.Y + m[8] * direction.Z);
+	}
+
+	template <typename T>
+	affine<T> affine<T>::Identity()
+	{
+		return affine<T>(T(1));
+	}
+
+	template <typename T>
+	affine<T> affine<T>::Translation(const vec3<T>& translation)
+	{
+		affine<T> result(T(1));
+		result.Cols[3] = translation;
+		return result;
+	}
+
+	template <typename T>
+	affine<T> affine<T>::Scale(const vec3<T>& scale)
+	{
+		affine<T> result;
+
+		result.Elements[0] = scale.X;
+		result.Elements[4] = scale.Y;
+		result.Elements[8] = scale.Z;
+
+		return result;
+	}
+
+	template <typename T>
+	affine<T> affine<T>::Rotation(T angle, const vec3<T>& axis)
+	{
+		return affine<T>(mat4<T>::Rotation(angle, axis));
+	}
+
+	template <typename T>
+	affine<T> affine<T>::Inverse(const affine<T>& matrix)
+	{
+		// Invert the linear 3x3 part, then the translation is -inverse(L) * t
+		mat3<T> linear(matrix.Cols[0], matrix.Cols[1], matrix.Cols[2]);
+		mat3<T> inverse = mat3<T>::Inverse(linear);
+
+		affine<T> result(inverse.Cols[0], inverse.Cols[1], inverse.Cols[2], vec3<T>(T(0)));
+		vec3<T> t = result.TransformDirection(matrix.Cols[3]);
+		result.Cols[3] = vec3<T>(-t.X, -t.Y, -t.Z);
+
+		return result;
+	}
+
+	template <typename T>
+	affine<T> affine<T>::InverseRigid(const affine<T>& matrix)
+	{
+		// Only valid when the linear part is a pure rotation: its inverse is its transpose
+		const T* m = matrix.Elements;
+		affine<T> result(
+			vec3<T>(m[0], m[3], m[6]),
+			vec3<T>(m[1], m[4], m[7]),
+			vec3<T>(m[2], m[5], m[8]),
+			vec3<T>(T(0)));
+
+		vec3<T> t = result.TransformDirection(matrix.Cols[3]);
+		result.Cols[3] = vec3<T>(-t.X, -t.Y, -t.Z);
+
+		return result;
+	}
+
+	template <typename T>
+	mat4<T> affine<T>::ToMat4(const affine<T>& matrix)
+	{
+		return mat4<T>(
+			vec4<T>(matrix.Cols[0], T(0)),
+			vec4<T>(matrix.Cols[1], T(0)),
+			vec4<T>(matrix.Cols[2], T(0)),
+			vec4<T>(matrix.Cols[3], T(1)));
+	}
+
+	template <typename T>
+	mat4x3<T> affine<T>::ToMat4x3(const affine<T>& matrix)
+	{
+		return matrix;
+	}
+
+	// Transforms an array of points by one affine matrix
+	template <typename T>
+	void TransformPoints(const affine<T>& matrix, const vec3<T>* points, size_t count, vec3<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("TransformPoints", count, count * 2 * sizeof(vec3<T>));
+
+		for (size_t i = 0; i < count; i++)
+			out[i] = matrix.TransformPoint(points[i]);
+	}
+
+	// Transforms an array of directions by one affine matrix, ignoring translation
+	template <typename T>
+	void TransformDirections(const affine<T>& matrix, const vec3<T>* directions, size_t count, vec3<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("TransformDirections", count, count * 2 * sizeof(vec3<T>));
+
+		for (size_t i = 0; i < count; i++)
+			out[i] = matrix.TransformDirection(directions[i]);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+#include "quat.h"
+
+#include <ostream>
+
+namespace Maths::Containers {
+
+	// Rigid transform stored as Real + eps * Dual, where Real is the rotation and
+	// Dual = 0.5 * translation * Real. Blending dual quaternions keeps the result a
+	// rigid transform, which avoids the volume loss of blending matrices.
+	template <typename T>
+	struct dualquat
+	{
+		quat<T> Real;
+		quat<T> Dual;
+
+		dualquat() = default;
+		dualquat(const quat<T>& real, const quat<T>& dual);
+		dualquat(const quat<T>& rotation, const vec3<T>& translation);
+		dualquat(const mat4<T>& matrix);
+
+		dualquat<T>& Multiply(const dualquat<T>& other);
+
+		dualquat<T>& operator *= (const dualquat<T>& other);
+
+		dualquat<T> Normalise() const;
+		vec3<T> Translation() const;
+		vec3<T> TransformPoint(const vec3<T>& point) const;
+		vec3<T> TransformVector(const vec3<T>& vector) const;
+
+		static dualquat<T> Identity();
+		static mat4<T> ToMatrix(const dualquat<T>& transform);
+
+		friend dualquat<T> operator * (dualquat<T> lhs, const dualquat<T>& rhs)
+		{
+			return lhs.Multiply(rhs);
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const dualquat<T>& transform)
+		{
+			os << transform.Real << transform.Dual;
+			return os;
+		}
+	};
+
+	template <typename T>
+	dualquat<T>::dualquat(const quat<T>& real, const quat<T>& dual) : Real(real), Dual(dual)
+	{
+
+	}
+
+	template <typename T>
+	dualquat<T>::dualquat(const quat<T>& rotation, const vec3<T>& translation) : Real(rotation)
+	{
+		quat<T> t(translation, T(0));
+		Dual = t * rotation;
+		Dual.X *= T(0.5f);
+		Dual.Y *= T(0.5f);
+		Dual.Z *= T(0.5f);
+		Dual.W *= T(0.5f);
+	}
+
+	template <typename T>
+	dualquat<T>::dualquat(const mat4<T>& matrix)
+		: dualquat(quat<T>::FromMatrix(matrix), vec3<T>(matrix.Cols[3].X, matrix.Cols[3].Y, matrix.Cols[3].Z))
+	{
+
+	}
+
+	template <typename T>
+	dualquat<T>& dualquat<T>::Multiply(const dualquat<T>& other)
+	{
+		quat<T> dual = Real * other.Dual;
+		quat<T> rhs = Dual * other.Real;
+		dual.X += rhs.X;
+		dual.Y += rhs.Y;
+		dual.Z += rhs.Z;
+		dual.W += rhs.W;
+
+		Real *= other.Real;
+		Dual = dual;
+
+		return *this;
+	}
+
+	template <typename T>
+	dualquat<T>& dualquat<T>::operator *= (const dualquat<T>& other)
+	{
+		return Multiply(other);
+	}
+
+	template <typename T>
+	dualquat<T> dualquat<T>::Normalise() const
+	{
+		T invLength = T(1) / Real.Magnitude();
+		return dualquat<T>(
+			quat<T>(Real.X * invLength, Real.Y * invLength, Real.Z * invLength, Real.W * invLength),
+			quat<T>(Dual.X * invLength, Dual.Y * invLength, Dual.Z * invLength, Dual.W * invLength));
+	}
+
+	template <typename T>
+	vec3<T> dualquat<T>::Translation() const
+	{
+		// t = 2 * Dual * conjugate(Real)
+		quat<T> t = Dual * Real.Conjugate();
+		return vec3<T>(T(2) * t.X, T(2) * t.Y, T(2) * t.Z);
+	}
+
+	template <typename T>
+	vec3<T> dualquat<T>::TransformPoint(const vec3<T>& point) const
+	{
+		return Real.Rotate(point) + Translation();
+	}
+
+	template <typename T>
+	vec3<T> dualquat<T>::TransformVector(const vec3<T>& vector) const
+	{
+		return Real.Rotate(vector);
+	}
+
+	template <typename T>
+	dualquat<T> dualquat<T>::Identity()
+	{
+		return dualquat<T>(quat<T>::Identity(), quat<T>(T(0), T(0), T(0), T(0)));
+	}
+
+	template <typename T>
+	mat4<T> dualquat<T>::ToMatrix(const dualquat<T>& transform)
+	{
+		mat4<T> result = quat<T>::ToMatrix(transform.Real);
+		result.Cols[3] = vec4<T>(transform.Translation(), T(1));
+		return result;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,512 @@
+#pragma once
+
+#include "vec3.h"
+#include "mat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+#include "../Utils/scalar.h"
+#include "../Utils/simd.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace Maths::Containers {
+
+	namespace Detail {
+
+		template <int Bits>
+		struct fixed_storage;
+
+		template <>
+		struct fixed_storage<32>
+		{
+			using raw_type = int32_t;
+			using unsigned_type = uint32_t;
+			using wide_type = int64_t;
+			using unsigned_wide_type = uint64_t;
+		};
+
+#if defined(__SIZEOF_INT128__)
+		template <>
+		struct fixed_storage<64>
+		{
+			using raw_type = int64_t;
+			using unsigned_type = uint64_t;
+			__extension__ typedef __int128 wide_type;
+			__extension__ typedef unsigned __int128 unsigned_wide_type;
+		};
+#endif
+
+	}
+
+	// Signed fixed point number with I integer bits (including the sign) and F fraction
+	// bits, stored as a two's complement integer Raw = value * 2^F. Results only depend on
+	// integer arithmetic, so they are identical on every machine and compiler.
+	//
+	// Addition and subtraction wrap on overflow; multiplication rounds to nearest and
+	// division truncates towards zero. fixed<16, 16> works everywhere; fixed<32, 32>
+	// needs a compiler with 128-bit integers for its intermediate products.
+	template <int I, int F>
+	struct fixed
+	{
+		static_assert(I + F == 32 || I + F == 64, "fixed supports 32 and 64 bit storage");
+		static_assert(F > 0 && I > 1, "fixed needs fraction bits, a sign bit and an integer bit");
+
+		using raw_type = typename Detail::fixed_storage<I + F>::raw_type;
+		using unsigned_type = typename Detail::fixed_storage<I + F>::unsigned_type;
+		using wide_type = typename Detail::fixed_storage<I + F>::wide_type;
+
+		static constexpr int IntegerBits = I;
+		static constexpr int FractionBits = F;
+		static constexpr raw_type One = raw_type(1) << F;
+
+		raw_type Raw;
+
+		constexpr fixed() : Raw(0)
+		{
+
+		}
+
+		// Integers convert exactly (wrapping if out of range), floating point values round
+		// to the nearest representable value
+		template <typename U, typename = std::enable_if_t<std::is_arithmetic_v<U>>>
+		constexpr fixed(U value) : Raw(FromValue(value))
+		{
+
+		}
+
+		static constexpr fixed<I, F> FromRaw(raw_type raw);
+
+		template <typename U, typename = std::enable_if_t<std::is_arithmetic_v<U>>>
+		explicit constexpr operator U() const
+		{
+			if constexpr (std::is_floating_point_v<U>)
+				return U(double(Raw) / double(One));
+			else
+				return U(Raw >> F);
+		}
+
+		fixed<I, F>& operator += (fixed<I, F> other)
+		{
+			Raw = raw_type(unsigned_type(Raw) + unsigned_type(other.Raw));
+			return *this;
+		}
+
+		fixed<I, F>& operator -= (fixed<I, F> other)
+		{
+			Raw = raw_type(unsigned_type(Raw) - unsigned_type(other.Raw));
+			return *this;
+		}
+
+		fixed<I, F>& operator *= (fixed<I, F> other)
+		{
+			Raw = raw_type((wide_type(Raw) * other.Raw + (wide_type(1) << (F - 1))) >> F);
+			return *this;
+		}
+
+		fixed<I, F>& operator /= (fixed<I, F> other)
+		{
+			Raw = raw_type(wide_type(Raw) * (wide_type(1) << F) / other.Raw);
+			return *this;
+		}
+
+		friend fixed<I, F> operator + (fixed<I, F> lhs, fixed<I, F> rhs)
+		{
+			return lhs += rhs;
+		}
+
+		friend fixed<I, F> operator - (fixed<I, F> lhs, fixed<I, F> rhs)
+		{
+			return lhs -= rhs;
+		}
+
+		friend fixed<I, F> operator * (fixed<I, F> lhs, fixed<I, F> rhs)
+		{
+			return lhs *= rhs;
+		}
+
+		friend fixed<I, F> operator / (fixed<I, F> lhs, fixed<I, F> rhs)
+		{
+			return lhs /= rhs;
+		}
+
+		friend fixed<I, F> operator - (fixed<I, F> value)
+		{
+			return FromRaw(raw_type(unsigned_type(0) - unsigned_type(value.Raw)));
+		}
+
+		friend bool operator == (fixed<I, F> lhs, fixed<I, F> rhs) { return lhs.Raw == rhs.Raw; }
+		friend bool operator != (fixed<I, F> lhs, fixed<I, F> rhs) { return lhs.Raw != rhs.Raw; }
+		friend bool operator < (fixed<I, F> lhs, fixed<I, F> rhs) { return lhs.Raw < rhs.Raw; }
+		friend bool operator <= (fixed<I, F> lhs, fixed<I, F> rhs) { return lhs.Raw <= rhs.Raw; }
+		friend bool operator > (fixed<I, F> lhs, fixed<I, F> rhs) { return lhs.Raw > rhs.Raw; }
+		friend bool operator >= (fixed<I, F> lhs, fixed<I, F> rhs) { return lhs.Raw >= rhs.Raw; }
+
+		friend std::ostream& operator << (std::ostream& os, fixed<I, F> value)
+		{
+			os << double(value);
+			return os;
+		}
+
+	private:
+		template <typename U>
+		static constexpr raw_type FromValue(U value)
+		{
+			if constexpr (std::is_floating_point_v<U>)
+			{
+				double scaled = double(value) * double(One);
+				return raw_type(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+			}
+			else
+			{
+				return raw_type(unsigned_type(value) << F);
+			}
+		}
+	};
+
+	template <int I, int F>
+	constexpr fixed<I, F> fixed<I, F>::FromRaw(raw_type raw)
+	{
+		fixed<I, F> result;
+		result.Raw = raw;
+		return result;
+	}
+
+	using fixed16 = fixed<16, 16>;
+	using fixed32 = fixed<32, 32>;
+
+	namespace Detail {
+
+		// Q30 tables built once from the deterministic software functions, so every
+		// machine gets the same entries
+		inline const std::array<int32_t, 4097>& SineTable()
+		{
+			static const std::array<int32_t, 4097> table = []()
+			{
+				std::array<int32_t, 4097> values{};
+				for (int i = 0; i <= 4096; i++)
+				{
+					double s, c;
+					Utils::Detail::SinCos(double(i) * (6.28318530717958647692 / 4096.0), s, c);
+					double scaled = s * 1073741824.0;
+					values[i] = int32_t(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+				}
+				return values;
+			}();
+			return table;
+		}
+
+		// atan(t) for t = i / 1024 in [0, 1]
+		inline const std::array<int32_t, 1025>& ArcTangentTable()
+		{
+			static const std::array<int32_t, 1025> table = []()
+			{
+				std::array<int32_t, 1025> values{};
+				for (int i = 0; i <= 1024; i++)
+				{
+					double t = double(i) / 1024.0;
+					values[i] = int32_t(Utils::Detail::Acos(1.0 / std::sqrt(1.0 + t * t)) * 1073741824.0 + 0.5);
+				}
+				return values;
+			}();
+			return table;
+		}
+
+		// Linear interpolation between two Q30 entries by a 16 bit fraction
+		inline int64_t LerpTable(const int32_t* table, uint32_t index, uint32_t fraction)
+		{
+			int64_t a = table[index];
+			int64_t b = table[index + 1];
+			return a + (((b - a) * int64_t(fraction)) >> 16);
+		}
+
+		template <int I, int F>
+		fixed<I, F> FromQ30(int64_t value)
+		{
+			using raw_type = typename fixed<I, F>::raw_type;
+			if constexpr (F < 30)
+				return fixed<I, F>::FromRaw(raw_type((value + (int64_t(1) << (29 - F))) >> (30 - F)));
+			else
+				return fixed<I, F>::FromRaw(raw_type(value * (int64_t(1) << (F - 30))));
+		}
+
+		// Angle in radians to a fraction of a full turn in 2^32 steps
+		template <int I, int F>
+		uint32_t TurnPhase(fixed<I, F> angle)
+		{
+			using wide_type = typename fixed<I, F>::wide_type;
+			constexpr int Shift = I + F == 32 ? 0 : 32;
+			constexpr double Scale = Shift == 0 ? 4294967296.0 : 4294967296.0 * 4294967296.0;
+			constexpr wide_type TurnsPerRadian = wide_type(Scale / 6.28318530717958647692 + 0.5);
+			return uint32_t((wide_type(angle.Raw) * TurnsPerRadian) >> (F + Shift));
+		}
+
+		template <int I, int F>
+		fixed<I, F> SineOfPhase(uint32_t phase)
+		{
+			return FromQ30<I, F>(LerpTable(SineTable().data(), phase >> 20, (phase >> 4) & 0xFFFFu));
+		}
+
+		// atan(t) for t in [0, 1]
+		template <int I, int F>
+		fixed<I, F> ArcTangentUnit(fixed<I, F> t)
+		{
+			int64_t position = F >= 26 ? int64_t(t.Raw) >> (F - 26) : int64_t(t.Raw) << (26 - F);
+			uint32_t index = uint32_t(position >> 16);
+			if (index >= 1024)
+				return FromQ30<I, F>(ArcTangentTable()[1024]);
+			return FromQ30<I, F>(LerpTable(ArcTangentTable().data(), index, uint32_t(position & 0xFFFF)));
+		}
+
+		template <typename U>
+		U IntegerSqrt(U value)
+		{
+			U result = 0;
+			U bit = U(1) << (sizeof(U) * 8 - 2);
+			while (bit > value)
+				bit >>= 2;
+
+			while (bit != 0)
+			{
+				if (value >= result + bit)
+				{
+					value -= result + bit;
+					result = (result >> 1) + bit;
+				}
+				else
+				{
+					result >>= 1;
+				}
+				bit >>= 2;
+			}
+			return result;
+		}
+
+	}
+
+	// Scalar functions found by argument-dependent lookup, so Utils::Sqrt, Utils::Sin etc.
+	// and everything built on them work with fixed point. sqrt is exact (rounded down);
+	// sin, cos and acos interpolate tables. sin and cos are within 3e-7, or within
+	// 8e-6 for fixed16, about half its step; acos is within 1e-7, or 1e-4 for fixed16.
+	template <int I, int F>
+	fixed<I, F> abs(fixed<I, F> value)
+	{
+		return value.Raw < 0 ? -value : value;
+	}
+
+	template <int I, int F>
+	fixed<I, F> floor(fixed<I, F> value)
+	{
+		using raw_type = typename fixed<I, F>::raw_type;
+		return fixed<I, F>::FromRaw(raw_type(value.Raw & ~(fixed<I, F>::One - 1)));
+	}
+
+	template <int I, int F>
+	fixed<I, F> sqrt(fixed<I, F> value)
+	{
+		using raw_type = typename fixed<I, F>::raw_type;
+		using unsigned_wide_type = typename Detail::fixed_storage<I + F>::unsigned_wide_type;
+		if (value.Raw <= 0)
+			return fixed<I, F>();
+		return fixed<I, F>::FromRaw(raw_type(Detail::IntegerSqrt(unsigned_wide_type(value.Raw) << F)));
+	}
+
+	template <int I, int F>
+	fixed<I, F> sin(fixed<I, F> angle)
+	{
+		return Detail::SineOfPhase<I, F>(Detail::TurnPhase(angle));
+	}
+
+	template <int I, int F>
+	fixed<I, F> cos(fixed<I, F> angle)
+	{
+		return Detail::SineOfPhase<I, F>(Detail::TurnPhase(angle) + 0x40000000u);
+	}
+
+	template <int I, int F>
+	fixed<I, F> tan(fixed<I, F> angle)
+	{
+		uint32_t phase = Detail::TurnPhase(angle);
+		return Detail::SineOfPhase<I, F>(phase) / Detail::SineOfPhase<I, F>(phase + 0x40000000u);
+	}
+
+	template <int I, int F>
+	fixed<I, F> acos(fixed<I, F> value)
+	{
+		constexpr fixed<I, F> Unit(1);
+		constexpr fixed<I, F> HalfPi(1.57079632679489661923);
+		constexpr fixed<I, F> Pi(3.14159265358979323846);
+
+		fixed<I, F> x = value > Unit ? Unit : (value < -Unit ? -Unit : value);
+		fixed<I, F> a = abs(x);
+		fixed<I, F> s = sqrt(Unit - a * a);
+
+		// atan2(s, a) in the first quadrant, keeping the table argument in [0, 1]
+		fixed<I, F> angle = s <= a ? Detail::ArcTangentUnit(s / a) : HalfPi - Detail::ArcTangentUnit(a / s);
+		return x.Raw < 0 ? Pi - angle : angle;
+	}
+
+	namespace Detail {
+
+#ifdef MATHS_SSE41
+		// Component c of two points whose x, y and z are in the even 32 bit lanes: the
+		// same double width sum as the scalar loop, with the result in the low half of
+		// each 64 bit lane. Bits F to F + 31 are the same for a logical shift.
+		template <int F>
+		__m128i TransformComponent(const __m128i* m, __m128i bias, __m128i x, __m128i y, __m128i z)
+		{
+			__m128i sum = _mm_add_epi64(_mm_mul_epi32(m[0], x), _mm_mul_epi32(m[1], y));
+			sum = _mm_add_epi64(sum, _mm_mul_epi32(m[2], z));
+			return _mm_srli_epi64(_mm_add_epi64(sum, bias), F);
+		}
+
+		// Four points of 32 bit fixed point: three loads regrouped so points 0 and 2, then
+		// points 1 and 3, have x, y and z in even lanes, and the results packed back
+		template <int F>
+		void TransformRaw4(const __m128i* m, const __m128i* bias, const int32_t* in, int32_t* out)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));		// x0 y0 z0 x1
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4));	// y1 z1 x2 y2
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));	// z2 x3 y3 z3
+
+			__m128i xy02 = _mm_blend_epi16(a, b, 0xF0);											// x0 y0 x2 y2
+			__m128i zx = _mm_shuffle_epi32(_mm_blend_epi16(c, a, 0xF0), _MM_SHUFFLE(1, 0, 3, 2));	// z0 x1 z2 x3
+			__m128i yz13 = _mm_blend_epi16(b, c, 0xF0);											// y1 z1 y3 z3
+
+			__m128i x02 = xy02, y02 = _mm_srli_epi64(xy02, 32), z02 = zx;
+			__m128i x13 = _mm_srli_epi64(zx, 32), y13 = yz13, z13 = _mm_srli_epi64(yz13, 32);
+
+			__m128i rx02 = TransformComponent<F>(m, bias[0], x02, y02, z02);
+			__m128i ry02 = TransformComponent<F>(m + 3, bias[1], x02, y02, z02);
+			__m128i rz02 = TransformComponent<F>(m + 6, bias[2], x02, y02, z02);
+			__m128i rx13 = TransformComponent<F>(m, bias[0], x13, y13, z13);
+			__m128i ry13 = TransformComponent<F>(m + 3, bias[1], x13, y13, z13);
+			__m128i rz13 = TransformComponent<F>(m + 6, bias[2], x13, y13, z13);
+
+			xy02 = _mm_blend_epi16(rx02, _mm_slli_epi64(ry02, 32), 0xCC);
+			zx = _mm_blend_epi16(rz02, _mm_slli_epi64(rx13, 32), 0xCC);
+			yz13 = _mm_blend_epi16(ry13, _mm_slli_epi64(rz13, 32), 0xCC);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi64(xy02, zx));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_blend_epi16(yz13, xy02, 0xF0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi64(zx, yz13));
+		}
+#endif
+
+		// The loop shared by points and directions: m holds the 3x3 part column by column
+		// at double width, then the three values added before rounding (the translation
+		// and the half for points, the half alone for directions). 32 bit fixed point
+		// goes four points at a time with SSE4.1, which gives the same bits.
+		template <int I, int F>
+		void TransformRaw(const typename fixed<I, F>::wide_type* m, const vec3<fixed<I, F>>* in, size_t count, vec3<fixed<I, F>>* out)
+		{
+			using raw_type = typename fixed<I, F>::raw_type;
+			using wide_type = typename fixed<I, F>::wide_type;
+
+			Utils::ParallelFor(count, 1 << 14, [=](size_t begin, size_t end)
+			{
+				size_t i = begin;
+#ifdef MATHS_SSE41
+				if constexpr (I + F == 32)
+				{
+					static_assert(sizeof(vec3<fixed<I, F>>) == 3 * sizeof(int32_t), "vec3 of fixed must be three packed integers");
+
+					// Linear entries grouped by output component; the multiplies only read
+					// the low 32 bits of each lane
+					__m128i lanes[9], bias[3];
+					for (int c = 0; c < 3; c++)
+					{
+						for (int k = 0; k < 3; k++)
+							lanes[c * 3 + k] = _mm_set1_epi32(int32_t(m[k * 3 + c]));
+						bias[c] = _mm_set1_epi64x(int64_t(m[9 + c]));
+					}
+
+					for (; i < end - (end - begin) % 4; i += 4)
+						TransformRaw4<F>(lanes, bias, &in[i].X.Raw, &out[i].X.Raw);
+				}
+#endif
+				for (; i < end; i++)
+				{
+					wide_type x = in[i].X.Raw;
+					wide_type y = in[i].Y.Raw;
+					wide_type z = in[i].Z.Raw;
+
+					out[i].X.Raw = raw_type((m[0] * x + m[3] * y + m[6] * z + m[9]) >> F);
+					out[i].Y.Raw = raw_type((m[1] * x + m[4] * y + m[7] * z + m[10]) >> F);
+					out[i].Z.Raw = raw_type((m[2] * x + m[5] * y + m[8] * z + m[11]) >> F);
+				}
+			});
+		}
+
+	}
+
+	// Batch transforms of fixed point points and directions by a 4x4 matrix (the last row
+	// is ignored). Each output component is accumulated at double width and rounded once,
+	// so it is both more accurate and cheaper than chaining fixed multiplies.
+	template <int I, int F>
+	void TransformPoints(const mat4<fixed<I, F>>& matrix, const vec3<fixed<I, F>>* points, size_t count, vec3<fixed<I, F>>* out)
+	{
+		MATHS_PROFILE_KERNEL("TransformPoints", count, count * 2 * sizeof(vec3<fixed<I, F>>));
+
+		using wide_type = typename fixed<I, F>::wide_type;
+
+		wide_type m[12];
+		for (int i = 0; i < 3; i++)
+		{
+			m[i] = matrix.Elements[i].Raw;
+			m[3 + i] = matrix.Elements[4 + i].Raw;
+			m[6 + i] = matrix.Elements[8 + i].Raw;
+			m[9 + i] = wide_type(matrix.Elements[12 + i].Raw) * (wide_type(1) << F) + (wide_type(1) << (F - 1));
+		}
+
+		Detail::TransformRaw<I, F>(m, points, count, out);
+	}
+
+	template <int I, int F>
+	void TransformDirections(const mat4<fixed<I, F>>& matrix, const vec3<fixed<I, F>>* directions, size_t count, vec3<fixed<I, F>>* out)
+	{
+		MATHS_PROFILE_KERNEL("TransformDirections", count, count * 2 * sizeof(vec3<fixed<I, F>>));
+
+		using wide_type = typename fixed<I, F>::wide_type;
+
+		wide_type m[12];
+		for (int i = 0; i < 3; i++)
+		{
+			m[i] = matrix.Elements[i].Raw;
+			m[3 + i] = matrix.Elements[4 + i].Raw;
+			m[6 + i] = matrix.Elements[8 + i].Raw;
+			m[9 + i] = wide_type(1) << (F - 1);
+		}
+
+		Detail::TransformRaw<I, F>(m, directions, count, out);
+	}
+
+}
+
+namespace std {
+
+	template <int I, int F>
+	class numeric_limits<Maths::Containers::fixed<I, F>>
+	{
+		using fixed = Maths::Containers::fixed<I, F>;
+		using raw_limits = numeric_limits<typename fixed::raw_type>;
+
+	public:
+		static constexpr bool is_specialized = true;
+		static constexpr bool is_signed = true;
+		static constexpr bool is_integer = false;
+		static constexpr bool is_exact = true;
+		static constexpr int digits = I + F - 1;
+
+		static constexpr fixed min() { return fixed::FromRaw(1); }
+		static constexpr fixed max() { return fixed::FromRaw(raw_limits::max()); }
+		static constexpr fixed lowest() { return fixed::FromRaw(raw_limits::min()); }
+		static constexpr fixed epsilon() { return fixed::FromRaw(1); }
+	};
+
+}
\ No newline at end of file
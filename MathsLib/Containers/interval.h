@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace Maths::Containers {
+
+	namespace Detail {
+
+		// Directed rounding without touching the FPU rounding mode: the round-to-nearest
+		// result is stepped by one ulp only when the exact error term shows it landed on
+		// the wrong side. Needs IEEE arithmetic without -ffast-math.
+		template <typename T>
+		T StepDown(T x)
+		{
+			return std::nextafter(x, -std::numeric_limits<T>::infinity());
+		}
+
+		template <typename T>
+		T StepUp(T x)
+		{
+			return std::nextafter(x, std::numeric_limits<T>::infinity());
+		}
+
+		// Error of a + b (Knuth's two-sum)
+		template <typename T>
+		T SumError(T a, T b, T sum)
+		{
+			T bVirtual = sum - a;
+			T aVirtual = sum - bVirtual;
+			return (a - aVirtual) + (b - bVirtual);
+		}
+
+		template <typename T>
+		T AddDown(T a, T b)
+		{
+			T sum = a + b;
+			return SumError(a, b, sum) < T(0) ? StepDown(sum) : sum;
+		}
+
+		template <typename T>
+		T AddUp(T a, T b)
+		{
+			T sum = a + b;
+			return SumError(a, b, sum) > T(0) ? StepUp(sum) : sum;
+		}
+
+		template <typename T>
+		T MulDown(T a, T b)
+		{
+			T product = a * b;
+			return std::fma(a, b, -product) < T(0) ? StepDown(product) : product;
+		}
+
+		template <typename T>
+		T MulUp(T a, T b)
+		{
+			T product = a * b;
+			return std::fma(a, b, -product) > T(0) ? StepUp(product) : product;
+		}
+
+		// a - q * b is exact, and has the sign of the error times the sign of b
+		template <typename T>
+		T DivDown(T a, T b)
+		{
+			T quotient = a / b;
+			T remainder = std::fma(-quotient, b, a);
+			return (remainder < T(0)) != (b < T(0)) && remainder != T(0) ? StepDown(quotient) : quotient;
+		}
+
+		template <typename T>
+		T DivUp(T a, T b)
+		{
+			T quotient = a / b;
+			T remainder = std::fma(-quotient, b, a);
+			return (remainder > T(0)) != (b < T(0)) && remainder != T(0) ? StepUp(quotient) : quotient;
+		}
+
+	}
+
+	// Closed interval [Lo, Hi] that is guaranteed to contain the exact result of the
+	// operations that produced it. Works as the scalar of vec and mat, so e.g. the
+	// interval Cross or Dot of two vectors bounds the rounding error of the float one:
+	// if the result's Sign() is not zero, the float sign is certain.
+	//
+	// Arithmetic bounds are tight to one ulp. sin, cos and acos rely on the standard
+	// library being accurate to an ulp and are widened by two. There are no relational
+	// operators, since two intervals can overlap; use Sign() or the bounds directly.
+	template <typename T>
+	struct interval
+	{
+		static_assert(std::is_floating_point_v<T>, "interval bounds must be floating point");
+
+		T Lo, Hi;
+
+		constexpr interval() : Lo(T(0)), Hi(T(0))
+		{
+
+		}
+
+		// Values that are not exactly representable in T get the two neighbours as bounds
+		template <typename U, typename = std::enable_if_t<std::is_arithmetic_v<U>>>
+		interval(U value) : Lo(T(value)), Hi(T(value))
+		{
+			if (U(Lo) > value)
+				Lo = Detail::StepDown(Lo);
+			if (U(Hi) < value)
+				Hi = Detail::StepUp(Hi);
+		}
+
+		constexpr interval(T lo, T hi) : Lo(lo), Hi(hi)
+		{
+
+		}
+
+		T Mid() const;
+		T Width() const;
+		bool Contains(T value) const;
+
+		// 1 or -1 if every value in the interval has that sign, 0 if it contains zero
+		int Sign() const;
+
+		interval<T>& operator += (const interval<T>& other)
+		{
+			Lo = Detail::AddDown(Lo, other.Lo);
+			Hi = Detail::AddUp(Hi, other.Hi);
+			return *this;
+		}
+
+		interval<T>& operator -= (const interval<T>& other)
+		{
+			T lo = Detail::AddDown(Lo, -other.Hi);
+			Hi = Detail::AddUp(Hi, -other.Lo);
+			Lo = lo;
+			return *this;
+		}
+
+		interval<T>& operator *= (const interval<T>& other)
+		{
+			T lo = std::min({ Detail::MulDown(Lo, other.Lo), Detail::MulDown(Lo, other.Hi), Detail::MulDown(Hi, other.Lo), Detail::MulDown(Hi, other.Hi) });
+			T hi = std::max({ Detail::MulUp(Lo, other.Lo), Detail::MulUp(Lo, other.Hi), Detail::MulUp(Hi, other.Lo), Detail::MulUp(Hi, other.Hi) });
+			Lo = lo;
+			Hi = hi;
+			return *this;
+		}
+
+		// Dividing by an interval that contains zero gives the whole real line
+		interval<T>& operator /= (const interval<T>& other)
+		{
+			if (other.Lo <= T(0) && other.Hi >= T(0))
+			{
+				Lo = -std::numeric_limits<T>::infinity();
+				Hi = std::numeric_limits<T>::infinity();
+				return *this;
+			}
+
+			T lo = std::min({ Detail::DivDown(Lo, other.Lo), Detail::DivDown(Lo, other.Hi), Detail::DivDown(Hi, other.Lo), Detail::DivDown(Hi, other.Hi) });
+			T hi = std::max({ Detail::DivUp(Lo, other.Lo), Detail::DivUp(Lo, other.Hi), Detail::DivUp(Hi, other.Lo), Detail::DivUp(Hi, other.Hi) });
+			Lo = lo;
+			Hi = hi;
+			return *this;
+		}
+
+		friend interval<T> operator + (interval<T> lhs, const interval<T>& rhs)
+		{
+			return lhs += rhs;
+		}
+
+		friend interval<T> operator - (interval<T> lhs, const interval<T>& rhs)
+		{
+			return lhs -= rhs;
+		}
+
+		friend interval<T> operator * (interval<T> lhs, const interval<T>& rhs)
+		{
+			return lhs *= rhs;
+		}
+
+		friend interval<T> operator / (interval<T> lhs, const interval<T>& rhs)
+		{
+			return lhs /= rhs;
+		}
+
+		friend interval<T> operator - (const interval<T>& value)
+		{
+			return interval<T>(-value.Hi, -value.Lo);
+		}
+
+		// Identical bounds, not "equal values"
+		friend bool operator == (const interval<T>& lhs, const interval<T>& rhs)
+		{
+			return lhs.Lo == rhs.Lo && lhs.Hi == rhs.Hi;
+		}
+
+		friend bool operator != (const interval<T>& lhs, const interval<T>& rhs)
+		{
+			return !(lhs == rhs);
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const interval<T>& value)
+		{
+			os << "[" << value.Lo << ", " << value.Hi << "]";
+			return os;
+		}
+	};
+
+	template <typename T>
+	T interval<T>::Mid() const
+	{
+		return Lo + (Hi - Lo) * T(0.5f);
+	}
+
+	template <typename T>
+	T interval<T>::Width() const
+	{
+		return Hi - Lo;
+	}
+
+	template <typename T>
+	bool interval<T>::Contains(T value) const
+	{
+		return Lo <= value && value <= Hi;
+	}
+
+	template <typename T>
+	int interval<T>::Sign() const
+	{
+		if (Lo > T(0))
+			return 1;
+		if (Hi < T(0))
+			return -1;
+		return 0;
+	}
+
+	// Scalar functions found by argument-dependent lookup, so Utils::Sqrt and the
+	// functions built on it (Magnitude, Normalise) work with intervals
+	template <typename T>
+	interval<T> abs(const interval<T>& value)
+	{
+		if (value.Lo >= T(0))
+			return value;
+		if (value.Hi <= T(0))
+			return -value;
+		return interval<T>(T(0), std::max(-value.Lo, value.Hi));
+	}
+
+	template <typename T>
+	interval<T> sqrt(const interval<T>& value)
+	{
+		// sqrt is correctly rounded, so the remainder x - s * s gives the rounding direction
+		T lo = std::sqrt(std::max(value.Lo, T(0)));
+		T hi = std::sqrt(std::max(value.Hi, T(0)));
+		if (std::fma(-lo, lo, std::max(value.Lo, T(0))) < T(0))
+			lo = Detail::StepDown(lo);
+		if (std::fma(-hi, hi, std::max(value.Hi, T(0))) > T(0))
+			hi = Detail::StepUp(hi);
+		return interval<T>(lo, hi);
+	}
+
+	template <typename T>
+	interval<T> sin(const interval<T>& value)
+	{
+		constexpr T Pi = T(3.14159265358979323846);
+		constexpr T HalfPi = T(1.57079632679489661923);
+
+		if (!(value.Hi - value.Lo < T(2) * Pi))
+			return interval<T>(T(-1), T(1));
+
+		// From 1 / epsilon on, neighbouring values are whole numbers apart and the rounded
+		// pi below no longer places the extrema
+		T magnitude = std::max(std::fabs(value.Lo), std::fabs(value.Hi));
+		if (!(magnitude < T(1) / std::numeric_limits<T>::epsilon()))
+			return interval<T>(T(-1), T(1));
+
+		T a = std::sin(value.Lo);
+		T b = std::sin(value.Hi);
+		T lo = Detail::StepDown(Detail::StepDown(std::min(a, b)));
+		T hi = Detail::StepUp(Detail::StepUp(std::max(a, b)));
+
+		// Extrema at pi/2 + k pi inside the interval. The slack only ever widens the result.
+		// k is counted in an integer so the loop always advances; the width check above
+		// leaves at most three extrema to visit.
+		T slack = T(8) * std::numeric_limits<T>::epsilon() * (T(1) + magnitude);
+		int64_t first = int64_t(std::ceil((value.Lo - slack - HalfPi) / Pi));
+		for (int64_t k = first; HalfPi + T(k) * Pi <= value.Hi + slack; k++)
+		{
+			if ((k & 1) == 0)
+				hi = T(1);
+			else
+				lo = T(-1);
+		}
+
+		return interval<T>(std::max(lo, T(-1)), std::min(hi, T(1)));
+	}
+
+	template <typename T>
+	interval<T> cos(const interval<T>& value)
+	{
+		// Bracket pi/2 rather than using its rounded value
+		constexpr T HalfPi = T(1.57079632679489661923);
+		return sin(value + interval<T>(Detail::StepDown(HalfPi), Detail::StepUp(HalfPi)));
+	}
+
+	// Clamps the argument to [-1, 1]
+	template <typename T>
+	interval<T> acos(const interval<T>& value)
+	{
+		T lo = std::acos(std::min(std::max(value.Hi, T(-1)), T(1)));
+		T hi = std::acos(std::min(std::max(value.Lo, T(-1)), T(1)));
+		return interval<T>(std::max(Detail::StepDown(Detail::StepDown(lo)), T(0)), Detail::StepUp(Detail::StepUp(hi)));
+	}
+
+}
\ No newline at end of file
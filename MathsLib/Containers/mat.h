@@ -0,0 +1,587 @@
+#pragma once
+
+#include "vec.h"
+#include "vec2.h"
+#include "vec3.h"
+#include "vec4.h"
+#include "unroll.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/scalar.h"
+#include "../Utils/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace Maths::Containers {
+
+	namespace Detail {
+
+		// out = lhs * rhs where lhs is C columns of R rows and rhs is K columns of C rows.
+		// Every element is accumulated in the same order as the scalar loop it replaces.
+		template <size_t C, size_t R, size_t K, typename T>
+		inline void MultiplyMatrix(const T* lhs, const T* rhs, T* out)
+		{
+			Unroll<K>([&](auto col)
+			{
+				Unroll<R>([&](auto row)
+				{
+					T sum = lhs[row] * rhs[col * C];
+					Unroll<C - 1>([&](auto i) { sum += lhs[(i + 1) * R + row] * rhs[col * C + i + 1]; });
+					out[col * R + row] = sum;
+				});
+			});
+		}
+
+		template <size_t C, size_t R, typename T>
+		inline void MultiplyVector(const T* lhs, const T* rhs, T* out)
+		{
+			MultiplyMatrix<C, R, 1, T>(lhs, rhs, out);
+		}
+
+#ifdef MATHS_SSE
+		// Each output column is a linear combination of the lhs columns
+		template <>
+		inline void MultiplyMatrix<4, 4, 4, float>(const float* lhs, const float* rhs, float* out)
+		{
+			__m128 c0 = _mm_loadu_ps(lhs);
+			__m128 c1 = _mm_loadu_ps(lhs + 4);
+			__m128 c2 = _mm_loadu_ps(lhs + 8);
+			__m128 c3 = _mm_loadu_ps(lhs + 12);
+
+			for (int col = 0; col < 4; col++)
+			{
+				const float* b = rhs + col * 4;
+				__m128 sum = _mm_mul_ps(c0, _mm_set1_ps(b[0]));
+				sum = _mm_add_ps(sum, _mm_mul_ps(c1, _mm_set1_ps(b[1])));
+				sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(b[2])));
+				sum = _mm_add_ps(sum, _mm_mul_ps(c3, _mm_set1_ps(b[3])));
+				_mm_storeu_ps(out + col * 4, sum);
+			}
+		}
+
+		template <>
+		inline void MultiplyVector<4, 4, float>(const float* lhs, const float* rhs, float* out)
+		{
+			__m128 sum = _mm_mul_ps(_mm_loadu_ps(lhs), _mm_set1_ps(rhs[0]));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(lhs + 4), _mm_set1_ps(rhs[1])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(lhs + 8), _mm_set1_ps(rhs[2])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(lhs + 12), _mm_set1_ps(rhs[3])));
+			_mm_storeu_ps(out, sum);
+		}
+#endif
+
+	}
+
+	// Column-major matrix with C columns of R rows. Shapes are named as in GLSL, so
+	// mat4x3 is four columns of vec3 (compact affine storage) and mat3x4 is three
+	// columns of vec4.
+	template <size_t C, size_t R, typename T>
+	struct mat
+	{
+		union
+		{
+			T Elements[C * R];
+			vec<R, T> Cols[C];
+		};
+
+		mat();
+		mat(T diagonal);
+
+		template <typename... Columns, typename = std::enable_if_t<(C > 1) && sizeof...(Columns) == C && (std::is_same_v<Columns, vec<R, T>> && ...)>>
+		mat(const Columns&... columns) : Cols{ columns... }
+		{
+
+		}
+
+		// Copies the overlapping top-left block and fills the rest from the identity
+		template <size_t C2, size_t R2>
+		mat(const mat<C2, R2, T>& matrix);
+
+		mat<C, R, T>& Multiply(const mat<C, R, T>& other);
+
+		mat<C, R, T>& operator *= (const mat<C, R, T>& other);
+
+		static mat<C, R, T> Identity();
+		static mat<R, C, T> Transpose(const mat<C, R, T>& matrix);
+		static mat<C, R, T> Inverse(const mat<C, R, T>& matrix);
+		static T Determinant(const mat<C, R, T>& matrix);
+
+		// Modified Gram-Schmidt over the columns: the first keeps its direction and each
+		// later one loses its components along the earlier ones. Columns that are zero or
+		// linearly dependent on earlier ones come out as zero.
+		static mat<C, R, T> Orthonormalise(const mat<C, R, T>& matrix);
+
+		// 4x4 only
+		static mat<C, R, T> Translation(const vec3<T>& translation);
+		static mat<C, R, T> Scale(const vec3<T>& scale);
+		static mat<C, R, T> Rotation(T angle, const vec3<T>& axis);
+		static mat<C, R, T> LookAt(const vec3<T>& position, const vec3<T>& centre, const vec3<T>& up = vec3<T>(T(0), T(1), T(0)));
+		static mat<C, R, T> Perspective(float fov, float aspectRatio, float n, float f);
+		static mat<C, R, T> PerspectiveReverseZ(float fov, float aspectRatio, float n, float f);
+		static mat<C, R, T> PerspectiveInfinite(float fov, float aspectRatio, float n);
+		static mat<C, R, T> Frustum(float left, float right, float bottom, float top, float n, float f);
+		static mat<C, R, T> Orthographic(float left, float right, float bottom, float top, float n, float f);
+		static mat<C, R, T> InversePerspective(const mat<C, R, T>& projection);
+		static mat<C, R, T> InverseOrthographic(const mat<C, R, T>& projection);
+
+		template <size_t K>
+		friend mat<K, R, T> operator * (const mat<C, R, T>& lhs, const mat<K, C, T>& rhs)
+		{
+			MATHS_PROFILE_CALL("mat::Multiply");
+
+			mat<K, R, T> result;
+			Detail::MultiplyMatrix<C, R, K, T>(lhs.Elements, rhs.Elements, result.Elements);
+			return result;
+		}
+
+		friend vec<R, T> operator * (const mat<C, R, T>& lhs, const vec<C, T>& rhs)
+		{
+			vec<R, T> result;
+			Detail::MultiplyVector<C, R, T>(lhs.Elements, rhs.Data(), result.Data());
+			return result;
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const mat<C, R, T>& matrix)
+		{
+			for (size_t i = 0; i < C * R; i++)
+			{
+				os << matrix.Elements[i] << "\t";
+				if ((i + 1) % R == 0)
+					os << "\n";
+			}
+			return os;
+		}
+	};
+
+	template <typename T>
+	using mat2 = mat<2, 2, T>;
+
+	template <typename T>
+	using mat3 = mat<3, 3, T>;
+
+	template <typename T>
+	using mat4 = mat<4, 4, T>;
+
+	template <typename T>
+	using mat3x4 = mat<3, 4, T>;
+
+	template <typename T>
+	using mat4x3 = mat<4, 3, T>;
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T>::mat()
+	{
+		std::fill_n(Elements, C * R, T(0));
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T>::mat(T diagonal)
+	{
+		std::fill_n(Elements, C * R, T(0));
+		Detail::Unroll<(C < R ? C : R)>([&](auto i) { Elements[i * R + i] = diagonal; });
+	}
+
+	template <size_t C, size_t R, typename T>
+	template <size_t C2, size_t R2>
+	mat<C, R, T>::mat(const mat<C2, R2, T>& matrix) : mat(T(1))
+	{
+		for (size_t col = 0; col < C && col < C2; col++)
+			for (size_t row = 0; row < R && row < R2; row++)
+				Elements[col * R + row] = matrix.Elements[col * R2 + row];
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T>& mat<C, R, T>::Multiply(const mat<C, R, T>& other)
+	{
+		static_assert(C == R, "In-place multiply needs a square matrix");
+		MATHS_PROFILE_CALL("mat::Multiply");
+
+		T data[C * R];
+		Detail::MultiplyMatrix<C, R, C, T>(Elements, other.Elements, data);
+		memcpy(Elements, data, C * R * sizeof(T));
+		return *this;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T>& mat<C, R, T>::operator *= (const mat<C, R, T>& other)
+	{
+		return Multiply(other);
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Identity()
+	{
+		return mat<C, R, T>(T(1));
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<R, C, T> mat<C, R, T>::Transpose(const mat<C, R, T>& matrix)
+	{
+		mat<R, C, T> result;
+
+		Detail::Unroll<C>([&](auto col)
+		{
+			Detail::Unroll<R>([&](auto row) { result.Elements[row * C + col] = matrix.Elements[col * R + row]; });
+		});
+
+		return result;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Inverse(const mat<C, R, T>& matrix)
+	{
+		static_assert(C == R && C >= 2 && C <= 4, "Inverse is implemented for 2x2, 3x3 and 4x4 matrices");
+		MATHS_PROFILE_CALL("mat::Inverse");
+
+		mat<C, R, T> result;
+
+		if constexpr (C == 2)
+		{
+			T invDet = T(1) / Determinant(matrix);
+
+			result.Elements[0] = matrix.Elements[3] * invDet;
+			result.Elements[1] = -matrix.Elements[1] * invDet;
+			result.Elements[2] = -matrix.Elements[2] * invDet;
+			result.Elements[3] = matrix.Elements[0] * invDet;
+		}
+		else if constexpr (C == 3)
+		{
+			// Calculate matrix of cofactors
+			result.Elements[0] = matrix.Elements[4] * matrix.Elements[8] - matrix.Elements[5] * matrix.Elements[7];
+			result.Elements[1] = T(-1) * (matrix.Elements[3] * matrix.Elements[8] - matrix.Elements[5] * matrix.Elements[6]);
+			result.Elements[2] = matrix.Elements[3] * matrix.Elements[7] - matrix.Elements[4] * matrix.Elements[6];
+			result.Elements[3] = T(-1) * (matrix.Elements[1] * matrix.Elements[8] - matrix.Elements[2] * matrix.Elements[7]);
+			result.Elements[4] = matrix.Elements[0] * matrix.Elements[8] - matrix.Elements[2] * matrix.Elements[6];
+			result.Elements[5] = T(-1) * (matrix.Elements[0] * matrix.Elements[7] - matrix.Elements[1] * matrix.Elements[6]);
+			result.Elements[6] = matrix.Elements[1] * matrix.Elements[5] - matrix.Elements[2] * matrix.Elements[4];
+			result.Elements[7] = T(-1) * (matrix.Elements[0] * matrix.Elements[5] - matrix.Elements[2] * matrix.Elements[3]);
+			result.Elements[8] = matrix.Elements[0] * matrix.Elements[4] - matrix.Elements[1] * matrix.Elements[3];
+
+			// Calculate Adjugate (Adjoint)
+			result = mat<C, R, T>::Transpose(result);
+
+			// Multiply by 1/Determinant
+			T invDet = T(1) / Determinant(matrix);
+			for (size_t i = 0; i < 9; i++)
+				result.Elements[i] *= invDet;
+		}
+		else
+		{
+			// Cofactor expansion sharing the 2x2 sub-determinants of the lower two rows,
+			// which also give the determinant
+			const T* m = matrix.Elements;
+
+			T s0 = m[0] * m[5] - m[4] * m[1];
+			T s1 = m[0] * m[9] - m[8] * m[1];
+			T s2 = m[0] * m[13] - m[12] * m[1];
+			T s3 = m[4] * m[9] - m[8] * m[5];
+			T s4 = m[4] * m[13] - m[12] * m[5];
+			T s5 = m[8] * m[13] - m[12] * m[9];
+
+			T c5 = m[10] * m[15] - m[14] * m[11];
+			T c4 = m[6] * m[15] - m[14] * m[7];
+			T c3 = m[6] * m[11] - m[10] * m[7];
+			T c2 = m[2] * m[15] - m[14] * m[3];
+			T c1 = m[2] * m[11] - m[10] * m[3];
+			T c0 = m[2] * m[7] - m[6] * m[3];
+
+			T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			T invDet = T(1) / det;
+
+			result.Elements[0] = (m[5] * c5 - m[9] * c4 + m[13] * c3) * invDet;
+			result.Elements[1] = (-m[1] * c5 + m[9] * c2 - m[13] * c1) * invDet;
+			result.Elements[2] = (m[1] * c4 - m[5] * c2 + m[13] * c0) * invDet;
+			result.Elements[3] = (-m[1] * c3 + m[5] * c1 - m[9] * c0) * invDet;
+
+			result.Elements[4] = (-m[4] * c5 + m[8] * c4 - m[12] * c3) * invDet;
+			result.Elements[5] = (m[0] * c5 - m[8] * c2 + m[12] * c1) * invDet;
+			result.Elements[6] = (-m[0] * c4 + m[4] * c2 - m[12] * c0) * invDet;
+			result.Elements[7] = (m[0] * c3 - m[4] * c1 + m[8] * c0) * invDet;
+
+			result.Elements[8] = (m[7] * s5 - m[11] * s4 + m[15] * s3) * invDet;
+			result.Elements[9] = (-m[3] * s5 + m[11] * s2 - m[15] * s1) * invDet;
+			result.Elements[10] = (m[3] * s4 - m[7] * s2 + m[15] * s0) * invDet;
+			result.Elements[11] = (-m[3] * s3 + m[7] * s1 - m[11] * s0) * invDet;
+
+			result.Elements[12] = (-m[6] * s5 + m[10] * s4 - m[14] * s3) * invDet;
+			result.Elements[13] = (m[2] * s5 - m[10] * s2 + m[14] * s1) * invDet;
+			result.Elements[14] = (-m[2] * s4 + m[6] * s2 - m[14] * s0) * invDet;
+			result.Elements[15] = (m[2] * s3 - m[6] * s1 + m[10] * s0) * invDet;
+		}
+
+		return result;
+	}
+
+	template <size_t C, size_t R, typename T>
+	T mat<C, R, T>::Determinant(const mat<C, R, T>& matrix)
+	{
+		static_assert(C == R && C >= 2 && C <= 4, "Determinant is implemented for 2x2, 3x3 and 4x4 matrices");
+
+		const T* m = matrix.Elements;
+
+		if constexpr (C == 2)
+		{
+			return m[0] * m[3] - m[2] * m[1];
+		}
+		else if constexpr (C == 3)
+		{
+			T a = m[0] * (m[4] * m[8] - m[5] * m[7]);
+			T b = m[1] * (m[3] * m[8] - m[5] * m[6]);
+			T c = m[2] * (m[3] * m[7] - m[4] * m[6]);
+			return a - b + c;
+		}
+		else
+		{
+			T s0 = m[0] * m[5] - m[4] * m[1];
+			T s1 = m[0] * m[9] - m[8] * m[1];
+			T s2 = m[0] * m[13] - m[12] * m[1];
+			T s3 = m[4] * m[9] - m[8] * m[5];
+			T s4 = m[4] * m[13] - m[12] * m[5];
+			T s5 = m[8] * m[13] - m[12] * m[9];
+
+			T c5 = m[10] * m[15] - m[14] * m[11];
+			T c4 = m[6] * m[15] - m[14] * m[7];
+			T c3 = m[6] * m[11] - m[10] * m[7];
+			T c2 = m[2] * m[15] - m[14] * m[3];
+			T c1 = m[2] * m[11] - m[10] * m[3];
+			T c0 = m[2] * m[7] - m[6] * m[3];
+
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		}
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Orthonormalise(const mat<C, R, T>& matrix)
+	{
+		static_assert(C <= R, "Orthonormalise needs at least as many rows as columns");
+
+		mat<C, R, T> result = matrix;
+
+		for (size_t col = 0; col < C; col++)
+		{
+			vec<R, T>& column = result.Cols[col];
+			T original = column.Magnitude();
+
+			for (size_t previous = 0; previous < col; previous++)
+				column -= result.Cols[previous] * vec<R, T>::Dot(result.Cols[previous], column);
+
+			// What is left of a dependent column is rounding error
+			T length = column.Magnitude();
+			if (length > original * std::numeric_limits<T>::epsilon() * T(16))
+				column /= length;
+			else
+				column = vec<R, T>(T(0));
+		}
+
+		return result;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Translation(const vec3<T>& translation)
+	{
+		static_assert(C == 4 && R == 4, "Translation builds a 4x4 matrix");
+
+		mat<C, R, T> result(T(1));
+
+		result.Elements[12] = translation.X;
+		result.Elements[13] = translation.Y;
+		result.Elements[14] = translation.Z;
+
+		return result;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Scale(const vec3<T>& scale)
+	{
+		static_assert(C == 4 && R == 4, "Scale builds a 4x4 matrix");
+
+		mat<C, R, T> result(T(1));
+
+		result.Elements[0] = scale.X;
+		result.Elements[5] = scale.Y;
+		result.Elements[10] = scale.Z;
+
+		return result;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Rotation(T angle, const vec3<T>& axis)
+	{
+		static_assert(C == 4 && R == 4, "Rotation builds a 4x4 matrix");
+
+		T radians = Utils::Radians(angle);
+		T c = Utils::Cos(radians);
+		T s = Utils::Sin(radians);
+		T omc = T(1) - c;
+		vec3<T> n = axis.Normalise();
+		T x = n.X;
+		T y = n.Y;
+		T z = n.Z;
+
+		mat<C, R, T> result{
+			vec4<T>(c + x * x*omc, y*x*omc + z * s, z*x*omc - y * s, T(0)),
+			vec4<T>(x*y*omc - z * s, c + y * y*omc, z*y*omc + x * s, T(0)),
+			vec4<T>(x*z*omc + y * s, y*z*omc - x * s, c + z * z*omc, T(0)),
+			vec4<T>(T(0), T(0), T(0), T(1))
+		};
+
+		return result;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::LookAt(const vec3<T>& position, const vec3<T>& centre, const vec3<T>& up)
+	{
+		static_assert(C == 4 && R == 4, "LookAt builds a 4x4 matrix");
+
+		vec3<T> f = (centre - position).Normalise();
+		vec3<T> r = vec3<T>::Cross(f, up).Normalise();
+		vec3<T> u = vec3<T>::Cross(r, f).Normalise();
+
+		mat<C, R, T> ViewMatrix{
+			vec4<T>(r.X, u.X, -f.X, T(0)),
+			vec4<T>(r.Y, u.Y, -f.Y, T(0)),
+			vec4<T>(r.Z, u.Z, -f.Z, T(0)),
+			vec4<T>(-vec3<T>::Dot(r, position), -vec3<T>::Dot(u, position), vec3<T>::Dot(f, position), T(1))
+		};
+
+		return ViewMatrix;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Perspective(float fov, float aspectRatio, float n, float f)
+	{
+		static_assert(C == 4 && R == 4, "Perspective builds a 4x4 matrix");
+
+		float t = n * (float)Utils::Tan(0.5 * fov * 0.0174533f);
+		float r = t * aspectRatio;
+
+		mat<C, R, T> perspectiveMatrix = {
+			vec4<T>(T(n / r), T(0), T(0), T(0)),
+			vec4<T>(T(0), T(n / t), T(0), T(0)),
+			vec4<T>(T(0), T(0), T(-(f + n) / (f - n)), T(-1)),
+			vec4<T>(T(0), T(0), T((-2.0f*f*n) / (f - n)), T(0))
+		};
+
+		return perspectiveMatrix;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::PerspectiveReverseZ(float fov, float aspectRatio, float n, float f)
+	{
+		static_assert(C == 4 && R == 4, "PerspectiveReverseZ builds a 4x4 matrix");
+
+		// Maps the near plane to depth 1 and the far plane to depth 0 ([0, 1] clip range).
+		// Spreads float precision evenly over distance; pass an infinite f for no far plane.
+		float y = 1.0f / (float)Utils::Tan(0.5 * fov * 0.0174533f);
+		float x = y / aspectRatio;
+		float c = std::isinf(f) ? 0.0f : n / (f - n);
+		float d = std::isinf(f) ? n : (f * n) / (f - n);
+
+		mat<C, R, T> perspectiveMatrix = {
+			vec4<T>(T(x), T(0), T(0), T(0)),
+			vec4<T>(T(0), T(y), T(0), T(0)),
+			vec4<T>(T(0), T(0), T(c), T(-1)),
+			vec4<T>(T(0), T(0), T(d), T(0))
+		};
+
+		return perspectiveMatrix;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::PerspectiveInfinite(float fov, float aspectRatio, float n)
+	{
+		static_assert(C == 4 && R == 4, "PerspectiveInfinite builds a 4x4 matrix");
+
+		// Limit of Perspective as f goes to infinity, with the same [-1, 1] depth range
+		float y = 1.0f / (float)Utils::Tan(0.5 * fov * 0.0174533f);
+		float x = y / aspectRatio;
+
+		mat<C, R, T> perspectiveMatrix = {
+			vec4<T>(T(x), T(0), T(0), T(0)),
+			vec4<T>(T(0), T(y), T(0), T(0)),
+			vec4<T>(T(0), T(0), T(-1), T(-1)),
+			vec4<T>(T(0), T(0), T(-2.0f * n), T(0))
+		};
+
+		return perspectiveMatrix;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Frustum(float left, float right, float bottom, float top, float n, float f)
+	{
+		static_assert(C == 4 && R == 4, "Frustum builds a 4x4 matrix");
+
+		// Off-centre perspective from the near plane rectangle; no trigonometry needed
+		mat<C, R, T> frustumMatrix = {
+			vec4<T>(T(2.0f * n / (right - left)), T(0), T(0), T(0)),
+			vec4<T>(T(0), T(2.0f * n / (top - bottom)), T(0), T(0)),
+			vec4<T>(T((right + left) / (right - left)), T((top + bottom) / (top - bottom)), T(-(f + n) / (f - n)), T(-1)),
+			vec4<T>(T(0), T(0), T((-2.0f*f*n) / (f - n)), T(0))
+		};
+
+		return frustumMatrix;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::Orthographic(float left, float right, float bottom, float top, float n, float f)
+	{
+		static_assert(C == 4 && R == 4, "Orthographic builds a 4x4 matrix");
+
+		mat<C, R, T> orthographicMatrix = {
+			vec4<T>(T(2.0f / (right - left)), T(0), T(0), T(0)),
+			vec4<T>(T(0), T(2.0f / (top - bottom)), T(0), T(0)),
+			vec4<T>(T(0), T(0), T(-2.0f / (f - n)), T(0)),
+			vec4<T>(T(-(right + left) / (right - left)), T(-(top + bottom) / (top - bottom)), T(-(f + n) / (f - n)), T(1))
+		};
+
+		return orthographicMatrix;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::InversePerspective(const mat<C, R, T>& projection)
+	{
+		static_assert(C == 4 && R == 4, "InversePerspective inverts a 4x4 matrix");
+
+		// Closed form inverse for any matrix built by Perspective, PerspectiveReverseZ,
+		// PerspectiveInfinite or Frustum: only the x, y, z scales, the off-centre terms and
+		// the depth coefficients are non-zero, so no general inverse is needed.
+		const T* m = projection.Elements;
+		T a = m[0];
+		T b = m[5];
+		T e = m[8];
+		T f = m[9];
+		T c = m[10];
+		T d = m[14];
+
+		mat<C, R, T> inverse = {
+			vec4<T>(T(1) / a, T(0), T(0), T(0)),
+			vec4<T>(T(0), T(1) / b, T(0), T(0)),
+			vec4<T>(T(0), T(0), T(0), T(1) / d),
+			vec4<T>(e / a, f / b, T(-1), c / d)
+		};
+
+		return inverse;
+	}
+
+	template <size_t C, size_t R, typename T>
+	mat<C, R, T> mat<C, R, T>::InverseOrthographic(const mat<C, R, T>& projection)
+	{
+		static_assert(C == 4 && R == 4, "InverseOrthographic inverts a 4x4 matrix");
+
+		const T* m = projection.Elements;
+
+		mat<C, R, T> inverse = {
+			vec4<T>(T(1) / m[0], T(0), T(0), T(0)),
+			vec4<T>(T(0), T(1) / m[5], T(0), T(0)),
+			vec4<T>(T(0), T(0), T(1) / m[10], T(0)),
+			vec4<T>(-m[12] / m[0], -m[13] / m[5], -m[14] / m[10], T(1))
+		};
+
+		return inverse;
+	}
+
+}
\ No newline at end of file
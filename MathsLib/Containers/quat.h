@@ -0,0 +1,230 @@
+#pragma once
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+#include "../Utils/scalar.h"
+
+#include <cmath>
+#include <ostream>
+
+namespace Maths::Containers {
+
+	template <typename T>
+	struct quat
+	{
+		T X, Y, Z, W;
+
+		quat() = default;
+		quat(T x, T y, T z, T w);
+		quat(const vec3<T>& vector, T w);
+
+		quat<T>& Multiply(const quat<T>& other);
+
+		quat<T>& operator *= (const quat<T>& other);
+
+		T Magnitude() const;
+		quat<T> Normalise() const;
+		quat<T> Conjugate() const;
+		vec3<T> Rotate(const vec3<T>& vector) const;
+
+		static quat<T> Identity();
+		static quat<T> Rotation(T angle, const vec3<T>& axis);
+		static quat<T> FromMatrix(const mat4<T>& matrix);
+		static mat4<T> ToMatrix(const quat<T>& rotation);
+		static T Dot(const quat<T>& lhs, const quat<T>& rhs);
+		static quat<T> Nlerp(const quat<T>& lhs, const quat<T>& rhs, T t);
+		static quat<T> Slerp(const quat<T>& lhs, const quat<T>& rhs, T t);
+
+		friend quat<T> operator * (quat<T> lhs, const quat<T>& rhs)
+		{
+			return lhs.Multiply(rhs);
+		}
+
+		friend bool operator == (const quat<T>& lhs, const quat<T>& rhs)
+		{
+			return (lhs.X == rhs.X && lhs.Y == rhs.Y && lhs.Z == rhs.Z && lhs.W == rhs.W);
+		}
+
+		friend bool operator != (const quat<T>& lhs, const quat<T>& rhs)
+		{
+			return !(lhs == rhs);
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const quat<T>& rotation)
+		{
+			os << rotation.X << "\t" << rotation.Y << "\t" << rotation.Z << "\t" << rotation.W << "\n";
+			return os;
+		}
+	};
+
+	template <typename T>
+	quat<T>::quat(T x, T y, T z, T w) : X(x), Y(y), Z(z), W(w)
+	{
+
+	}
+
+	template <typename T>
+	quat<T>::quat(const vec3<T>& vector, T w) : X(vector.X), Y(vector.Y), Z(vector.Z), W(w)
+	{
+
+	}
+
+	template <typename T>
+	quat<T>& quat<T>::Multiply(const quat<T>& other)
+	{
+		T x = W * other.X + X * other.W + Y * other.Z - Z * other.Y;
+		T y = W * other.Y - X * other.Z + Y * other.W + Z * other.X;
+		T z = W * other.Z + X * other.Y - Y * other.X + Z * other.W;
+		T w = W * other.W - X * other.X - Y * other.Y - Z * other.Z;
+
+		X = x;
+		Y = y;
+		Z = z;
+		W = w;
+
+		return *this;
+	}
+
+	template <typename T>
+	quat<T>& quat<T>::operator *= (const quat<T>& other)
+	{
+		return Multiply(other);
+	}
+
+	template <typename T>
+	T quat<T>::Magnitude() const
+	{
+		return Utils::Sqrt(X * X + Y * Y + Z * Z + W * W);
+	}
+
+	template <typename T>
+	quat<T> quat<T>::Normalise() const
+	{
+		T length = Magnitude();
+		return quat<T>(X / length, Y / length, Z / length, W / length);
+	}
+
+	template <typename T>
+	quat<T> quat<T>::Conjugate() const
+	{
+		return quat<T>(-X, -Y, -Z, W);
+	}
+
+	template <typename T>
+	vec3<T> quat<T>::Rotate(const vec3<T>& vector) const
+	{
+		// v' = v + 2w(q x v) + 2(q x (q x v)), cheaper than two quaternion products
+		vec3<T> q(X, Y, Z);
+		vec3<T> t = vec3<T>::Cross(q, vector) * T(2);
+		return vector + t * W + vec3<T>::Cross(q, t);
+	}
+
+	template <typename T>
+	quat<T> quat<T>::Identity()
+	{
+		return quat<T>(T(0), T(0), T(0), T(1));
+	}
+
+	template <typename T>
+	quat<T> quat<T>::Rotation(T angle, const vec3<T>& axis)
+	{
+		// Angle is in degrees to match mat4::Rotation
+		T halfAngle = Utils::Radians(angle) * T(0.5f);
+		T s = Utils::Sin(halfAngle);
+		vec3<T> n = axis.Normalise();
+
+		return quat<T>(n.X * s, n.Y * s, n.Z * s, Utils::Cos(halfAngle));
+	}
+
+	template <typename T>
+	quat<T> quat<T>::FromMatrix(const mat4<T>& matrix)
+	{
+		// Expects the upper 3x3 to be a pure rotation
+		const T* m = matrix.Elements;
+		T trace = m[0] + m[5] + m[10];
+		quat<T> result;
+
+		if (trace > T(0))
+		{
+			T s = Utils::Sqrt(trace + T(1)) * T(2);
+			result = quat<T>((m[6] - m[9]) / s, (m[8] - m[2]) / s, (m[1] - m[4]) / s, s / T(4));
+		}
+		else if (m[0] > m[5] && m[0] > m[10])
+		{
+			T s = Utils::Sqrt(T(1) + m[0] - m[5] - m[10]) * T(2);
+			result = quat<T>(s / T(4), (m[4] + m[1]) / s, (m[8] + m[2]) / s, (m[6] - m[9]) / s);
+		}
+		else if (m[5] > m[10])
+		{
+			T s = Utils::Sqrt(T(1) + m[5] - m[0] - m[10]) * T(2);
+			result = quat<T>((m[4] + m[1]) / s, s / T(4), (m[9] + m[6]) / s, (m[8] - m[2]) / s);
+		}
+		else
+		{
+			T s = Utils::Sqrt(T(1) + m[10] - m[0] - m[5]) * T(2);
+			result = quat<T>((m[8] + m[2]) / s, (m[9] + m[6]) / s, s / T(4), (m[1] - m[4]) / s);
+		}
+
+		return result.Normalise();
+	}
+
+	template <typename T>
+	mat4<T> quat<T>::ToMatrix(const quat<T>& rotation)
+	{
+		T x = rotation.X, y = rotation.Y, z = rotation.Z, w = rotation.W;
+		T xx = x * x, yy = y * y, zz = z * z;
+		T xy = x * y, xz = x * z, yz = y * z;
+		T wx = w * x, wy = w * y, wz = w * z;
+
+		mat4<T> result{
+			vec4<T>(T(1) - T(2) * (yy + zz), T(2) * (xy + wz), T(2) * (xz - wy), T(0)),
+			vec4<T>(T(2) * (xy - wz), T(1) - T(2) * (xx + zz), T(2) * (yz + wx), T(0)),
+			vec4<T>(T(2) * (xz + wy), T(2) * (yz - wx), T(1) - T(2) * (xx + yy), T(0)),
+			vec4<T>(T(0), T(0), T(0), T(1))
+		};
+
+		return result;
+	}
+
+	template <typename T>
+	T quat<T>::Dot(const quat<T>& lhs, const quat<T>& rhs)
+	{
+		return lhs.X * rhs.X + lhs.Y * rhs.Y + lhs.Z * rhs.Z + lhs.W * rhs.W;
+	}
+
+	template <typename T>
+	quat<T> quat<T>::Nlerp(const quat<T>& lhs, const quat<T>& rhs, T t)
+	{
+		// Take the shortest arc
+		T sign = Dot(lhs, rhs) < T(0) ? T(-1) : T(1);
+		T a = T(1) - t;
+		T b = t * sign;
+
+		return quat<T>(lhs.X * a + rhs.X * b, lhs.Y * a + rhs.Y * b, lhs.Z * a + rhs.Z * b, lhs.W * a + rhs.W * b).Normalise();
+	}
+
+	template <typename T>
+	quat<T> quat<T>::Slerp(const quat<T>& lhs, const quat<T>& rhs, T t)
+	{
+		T cosTheta = Dot(lhs, rhs);
+		T sign = T(1);
+		if (cosTheta < T(0))
+		{
+			cosTheta = -cosTheta;
+			sign = T(-1);
+		}
+
+		// Nearly parallel rotations lose precision in sin(theta), fall back to nlerp
+		if (cosTheta > T(0.9995f))
+			return Nlerp(lhs, rhs, t);
+
+		T theta = T(Utils::Acos(cosTheta));
+		T invSin = T(1) / T(Utils::Sin(theta));
+		T a = T(Utils::Sin((T(1) - t) * theta)) * invSin;
+		T b = T(Utils::Sin(t * theta)) * invSin * sign;
+
+		return quat<T>(lhs.X * a + rhs.X * b, lhs.Y * a + rhs.Y * b, lhs.Z * a + rhs.Z * b, lhs.W * a + rhs.W * b);
+	}
+
+}
\ No newline at end of file
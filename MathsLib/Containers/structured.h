@@ -0,0 +1,480 @@
+#pragma once
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat.h"
+#include "affine.h"
+
+#include <type_traits>
+
+namespace Maths::Containers {
+
+	// 4x4 matrices whose zero pattern is known from their type, storing only the terms that
+	// can be non-zero. Products with them skip the zero terms: a translation adds 12 terms
+	// to a mat4 and a perspective projection costs 24 multiplies, against 64 for the dense
+	// product. They convert implicitly to mat4, and a product of two different structured
+	// types decays to mat4. Orthographic projections are scale plus translation, so affine
+	// already covers them.
+
+	// Diagonal matrix, e.g. a scale or mat4(T diagonal)
+	template <typename T>
+	struct diagonal_mat4
+	{
+		vec4<T> Diagonal;
+
+		diagonal_mat4();
+		diagonal_mat4(T diagonal);
+		diagonal_mat4(const vec4<T>& diagonal);
+
+		static diagonal_mat4<T> Identity();
+		static diagonal_mat4<T> Scale(const vec3<T>& scale);
+
+		// Zero diagonal terms give infinities, as for the scalar division
+		static diagonal_mat4<T> Inverse(const diagonal_mat4<T>& matrix);
+		static mat4<T> ToMat4(const diagonal_mat4<T>& matrix);
+
+		operator mat4<T>() const { return ToMat4(*this); }
+	};
+
+	// Identity with a translation column
+	template <typename T>
+	struct translation_mat4
+	{
+		vec3<T> Translation;
+
+		translation_mat4();
+		translation_mat4(const vec3<T>& translation);
+
+		vec3<T> TransformPoint(const vec3<T>& point) const;
+
+		static translation_mat4<T> Identity();
+		static translation_mat4<T> Inverse(const translation_mat4<T>& matrix);
+		static mat4<T> ToMat4(const translation_mat4<T>& matrix);
+
+		operator mat4<T>() const { return ToMat4(*this); }
+	};
+
+	// Perspective projection as built by mat4's Perspective, PerspectiveReverseZ,
+	// PerspectiveInfinite and Frustum:
+	//   [X 0 OffsetX      0         ]
+	//   [0 Y OffsetY      0         ]
+	//   [0 0 DepthScale   DepthOffset]
+	//   [0 0 -1           0         ]
+	template <typename T>
+	struct projection_mat4
+	{
+		T X = T(0);
+		T Y = T(0);
+		T OffsetX = T(0);
+		T OffsetY = T(0);
+		T DepthScale = T(0);
+		T DepthOffset = T(0);
+
+		projection_mat4() = default;
+
+		// Keeps the six terms above; the others must match the pattern for the result to be exact
+		explicit projection_mat4(const mat4<T>& matrix);
+
+		static projection_mat4<T> Perspective(float fov, float aspectRatio, float n, float f);
+		static projection_mat4<T> PerspectiveReverseZ(float fov, float aspectRatio, float n, float f);
+		static projection_mat4<T> PerspectiveInfinite(float fov, float aspectRatio, float n);
+		static projection_mat4<T> Frustum(float left, float right, float bottom, float top, float n, float f);
+		static mat4<T> Inverse(const projection_mat4<T>& matrix);
+		static mat4<T> ToMat4(const projection_mat4<T>& matrix);
+
+		operator mat4<T>() const { return ToMat4(*this); }
+	};
+
+	namespace Detail {
+
+		template <typename M>
+		struct is_structured_mat4 : std::false_type {};
+
+		template <typename T>
+		struct is_structured_mat4<diagonal_mat4<T>> : std::true_type {};
+
+		template <typename T>
+		struct is_structured_mat4<translation_mat4<T>> : std::true_type {};
+
+		template <typename T>
+		struct is_structured_mat4<projection_mat4<T>> : std::true_type {};
+
+		// out = translation * m: every column gains the translation times its W
+		template <typename T>
+		inline void TranslateColumns(const vec3<T>& translation, const T* m, T* out)
+		{
+			for (int col = 0; col < 4; col++)
+			{
+				const T* c = m + col * 4;
+				out[col * 4] = c[0] + translation.X * c[3];
+				out[col * 4 + 1] = c[1] + translation.Y * c[3];
+				out[col * 4 + 2] = c[2] + translation.Z * c[3];
+				out[col * 4 + 3] = c[3];
+			}
+		}
+
+		// out = projection * m, one column at a time
+		template <typename T>
+		inline void ProjectColumns(const projection_mat4<T>& projection, const T* m, T* out)
+		{
+			for (int col = 0; col < 4; col++)
+			{
+				const T* c = m + col * 4;
+				out[col * 4] = projection.X * c[0] + projection.OffsetX * c[2];
+				out[col * 4 + 1] = projection.Y * c[1] + projection.OffsetY * c[2];
+				out[col * 4 + 2] = projection.DepthScale * c[2] + projection.DepthOffset * c[3];
+				out[col * 4 + 3] = -c[2];
+			}
+		}
+
+#ifdef MATHS_SSE
+		// The scalar loops above are strided across the rows, so they do not vectorise on
+		// their own; here each column is one register and the results are bit-identical
+		template <>
+		inline void TranslateColumns<float>(const vec3<float>& translation, const float* m, float* out)
+		{
+			__m128 t = _mm_setr_ps(translation.X, translation.Y, translation.Z, 0.0f);
+			for (int col = 0; col < 4; col++)
+			{
+				__m128 c = _mm_loadu_ps(m + col * 4);
+				__m128 w = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+				_mm_storeu_ps(out + col * 4, _mm_add_ps(c, _mm_mul_ps(t, w)));
+			}
+		}
+
+		template <>
+		inline void ProjectColumns<float>(const projection_mat4<float>& projection, const float* m, float* out)
+		{
+			__m128 scale = _mm_setr_ps(projection.X, projection.Y, projection.DepthScale, 0.0f);
+			__m128 offset = _mm_setr_ps(projection.OffsetX, projection.OffsetY, projection.DepthOffset, 0.0f);
+			__m128 lastLane = _mm_cmplt_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, -1.0f), _mm_setzero_ps());
+			__m128 sign = _mm_and_ps(lastLane, _mm_set1_ps(-0.0f));
+			for (int col = 0; col < 4; col++)
+			{
+				// (x, y, z, w) * scale + (z, z, w, z) * offset, with -z put in the last lane
+				__m128 c = _mm_loadu_ps(m + col * 4);
+				__m128 mixed = _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 3, 2, 2));
+				__m128 sum = _mm_add_ps(_mm_mul_ps(c, scale), _mm_mul_ps(mixed, offset));
+				__m128 negatedZ = _mm_and_ps(lastLane, _mm_xor_ps(mixed, sign));
+				_mm_storeu_ps(out + col * 4, _mm_or_ps(_mm_andnot_ps(lastLane, sum), negatedZ));
+			}
+		}
+#endif
+
+	}
+
+	template <typename T>
+	diagonal_mat4<T> operator * (const diagonal_mat4<T>& lhs, const diagonal_mat4<T>& rhs);
+
+	// Scales the rows of rhs
+	template <typename T>
+	mat4<T> operator * (const diagonal_mat4<T>& lhs, const mat4<T>& rhs);
+
+	// Scales the columns of lhs
+	template <typename T>
+	mat4<T> operator * (const mat4<T>& lhs, const diagonal_mat4<T>& rhs);
+
+	template <typename T>
+	vec4<T> operator * (const diagonal_mat4<T>& lhs, const vec4<T>& rhs);
+
+	template <typename T>
+	translation_mat4<T> operator * (const translation_mat4<T>& lhs, const translation_mat4<T>& rhs);
+
+	template <typename T>
+	mat4<T> operator * (const translation_mat4<T>& lhs, const mat4<T>& rhs);
+
+	template <typename T>
+	mat4<T> operator * (const mat4<T>& lhs, const translation_mat4<T>& rhs);
+
+	template <typename T>
+	affine<T> operator * (const translation_mat4<T>& lhs, const affine<T>& rhs);
+
+	template <typename T>
+	affine<T> operator * (const affine<T>& lhs, const translation_mat4<T>& rhs);
+
+	template <typename T>
+	vec4<T> operator * (const translation_mat4<T>& lhs, const vec4<T>& rhs);
+
+	template <typename T>
+	mat4<T> operator * (const projection_mat4<T>& lhs, const mat4<T>& rhs);
+
+	template <typename T>
+	mat4<T> operator * (const mat4<T>& lhs, const projection_mat4<T>& rhs);
+
+	// Projection times view, the usual way to build a view-projection matrix
+	template <typename T>
+	mat4<T> operator * (const projection_mat4<T>& lhs, const affine<T>& rhs);
+
+	template <typename T>
+	vec4<T> operator * (const projection_mat4<T>& lhs, const vec4<T>& rhs);
+
+	// Two different structured matrices: the left one decays to mat4
+	template <typename L, typename R, typename = std::enable_if_t<Detail::is_structured_mat4<L>::value && Detail::is_structured_mat4<R>::value && !std::is_same_v<L, R>>>
+	auto operator * (const L& lhs, const R& rhs)
+	{
+		return L::ToMat4(lhs) * rhs;
+	}
+
+	template <typename T>
+	diagonal_mat4<T>::diagonal_mat4() : Diagonal(T(0))
+	{
+
+	}
+
+	template <typename T>
+	diagonal_mat4<T>::diagonal_mat4(T diagonal) : Diagonal(diagonal)
+	{
+
+	}
+
+	template <typename T>
+	diagonal_mat4<T>::diagonal_mat4(const vec4<T>& diagonal) : Diagonal(diagonal)
+	{
+
+	}
+
+	template <typename T>
+	diagonal_mat4<T> diagonal_mat4<T>::Identity()
+	{
+		return diagonal_mat4<T>(T(1));
+	}
+
+	template <typename T>
+	diagonal_mat4<T> diagonal_mat4<T>::Scale(const vec3<T>& scale)
+	{
+		return diagonal_mat4<T>(vec4<T>(scale, T(1)));
+	}
+
+	template <typename T>
+	diagonal_mat4<T> diagonal_mat4<T>::Inverse(const diagonal_mat4<T>& matrix)
+	{
+		const vec4<T>& d = matrix.Diagonal;
+		return diagonal_mat4<T>(vec4<T>(T(1) / d.X, T(1) / d.Y, T(1) / d.Z, T(1) / d.W));
+	}
+
+	template <typename T>
+	mat4<T> diagonal_mat4<T>::ToMat4(const diagonal_mat4<T>& matrix)
+	{
+		mat4<T> result;
+		for (int i = 0; i < 4; i++)
+			result.Elements[i * 5] = matrix.Diagonal[i];
+		return result;
+	}
+
+	template <typename T>
+	translation_mat4<T>::translation_mat4() : Translation(T(0))
+	{
+
+	}
+
+	template <typename T>
+	translation_mat4<T>::translation_mat4(const vec3<T>& translation) : Translation(translation)
+	{
+
+	}
+
+	template <typename T>
+	vec3<T> translation_mat4<T>::TransformPoint(const vec3<T>& point) const
+	{
+		return vec3<T>(point.X + Translation.X, point.Y + Translation.Y, point.Z + Translation.Z);
+	}
+
+	template <typename T>
+	translation_mat4<T> translation_mat4<T>::Identity()
+	{
+		return translation_mat4<T>();
+	}
+
+	template <typename T>
+	translation_mat4<T> translation_mat4<T>::Inverse(const translation_mat4<T>& matrix)
+	{
+		const vec3<T>& t = matrix.Translation;
+		return translation_mat4<T>(vec3<T>(-t.X, -t.Y, -t.Z));
+	}
+
+	template <typename T>
+	mat4<T> translation_mat4<T>::ToMat4(const translation_mat4<T>& matrix)
+	{
+		return mat4<T>::Translation(matrix.Translation);
+	}
+
+	template <typename T>
+	projection_mat4<T>::projection_mat4(const mat4<T>& matrix)
+	{
+		const T* m = matrix.Elements;
+		X = m[0];
+		Y = m[5];
+		OffsetX = m[8];
+		OffsetY = m[9];
+		DepthScale = m[10];
+		DepthOffset = m[14];
+	}
+
+	template <typename T>
+	projection_mat4<T> projection_mat4<T>::Perspective(float fov, float aspectRatio, float n, float f)
+	{
+		return projection_mat4<T>(mat4<T>::Perspective(fov, aspectRatio, n, f));
+	}
+
+	template <typename T>
+	projection_mat4<T> projection_mat4<T>::PerspectiveReverseZ(float fov, float aspectRatio, float n, float f)
+	{
+		return projection_mat4<T>(mat4<T>::PerspectiveReverseZ(fov, aspectRatio, n, f));
+	}
+
+	template <typename T>
+	projection_mat4<T> projection_mat4<T>::PerspectiveInfinite(float fov, float aspectRatio, float n)
+	{
+		return projection_mat4<T>(mat4<T>::PerspectiveInfinite(fov, aspectRatio, n));
+	}
+
+	template <typename T>
+	projection_mat4<T> projection_mat4<T>::Frustum(float left, float right, float bottom, float top, float n, float f)
+	{
+		return projection_mat4<T>(mat4<T>::Frustum(left, right, bottom, top, n, f));
+	}
+
+	template <typename T>
+	mat4<T> projection_mat4<T>::Inverse(const projection_mat4<T>& matrix)
+	{
+		return mat4<T>::InversePerspective(ToMat4(matrix));
+	}
+
+	template <typename T>
+	mat4<T> projection_mat4<T>::ToMat4(const projection_mat4<T>& matrix)
+	{
+		return mat4<T>(
+			vec4<T>(matrix.X, T(0), T(0), T(0)),
+			vec4<T>(T(0), matrix.Y, T(0), T(0)),
+			vec4<T>(matrix.OffsetX, matrix.OffsetY, matrix.DepthScale, T(-1)),
+			vec4<T>(T(0), T(0), matrix.DepthOffset, T(0)));
+	}
+
+	template <typename T>
+	diagonal_mat4<T> operator * (const diagonal_mat4<T>& lhs, const diagonal_mat4<T>& rhs)
+	{
+		const vec4<T>& a = lhs.Diagonal;
+		const vec4<T>& b = rhs.Diagonal;
+		return diagonal_mat4<T>(vec4<T>(a.X * b.X, a.Y * b.Y, a.Z * b.Z, a.W * b.W));
+	}
+
+	template <typename T>
+	mat4<T> operator * (const diagonal_mat4<T>& lhs, const mat4<T>& rhs)
+	{
+		mat4<T> result;
+		for (int col = 0; col < 4; col++)
+			for (int row = 0; row < 4; row++)
+				result.Elements[col * 4 + row] = lhs.Diagonal[row] * rhs.Elements[col * 4 + row];
+		return result;
+	}
+
+	template <typename T>
+	mat4<T> operator * (const mat4<T>& lhs, const diagonal_mat4<T>& rhs)
+	{
+		mat4<T> result;
+		for (int col = 0; col < 4; col++)
+			for (int row = 0; row < 4; row++)
+				result.Elements[col * 4 + row] = lhs.Elements[col * 4 + row] * rhs.Diagonal[col];
+		return result;
+	}
+
+	template <typename T>
+	vec4<T> operator * (const diagonal_mat4<T>& lhs, const vec4<T>& rhs)
+	{
+		const vec4<T>& d = lhs.Diagonal;
+		return vec4<T>(d.X * rhs.X, d.Y * rhs.Y, d.Z * rhs.Z, d.W * rhs.W);
+	}
+
+	template <typename T>
+	translation_mat4<T> operator * (const translation_mat4<T>& lhs, const translation_mat4<T>& rhs)
+	{
+		return translation_mat4<T>(lhs.TransformPoint(rhs.Translation));
+	}
+
+	template <typename T>
+	mat4<T> operator * (const translation_mat4<T>& lhs, const mat4<T>& rhs)
+	{
+		mat4<T> result;
+		Detail::TranslateColumns(lhs.Translation, rhs.Elements, result.Elements);
+		return result;
+	}
+
+	template <typename T>
+	mat4<T> operator * (const mat4<T>& lhs, const translation_mat4<T>& rhs)
+	{
+		// Only the last column changes: it becomes lhs * (t, 1)
+		const vec3<T>& t = rhs.Translation;
+		const T* m = lhs.Elements;
+		mat4<T> result = lhs;
+		for (int row = 0; row < 4; row++)
+			result.Elements[12 + row] = m[row] * t.X + m[4 + row] * t.Y + m[8 + row] * t.Z + m[12 + row];
+		return result;
+	}
+
+	template <typename T>
+	affine<T> operator * (const translation_mat4<T>& lhs, const affine<T>& rhs)
+	{
+		affine<T> result = rhs;
+		result.Cols[3] = lhs.TransformPoint(rhs.Cols[3]);
+		return result;
+	}
+
+	template <typename T>
+	affine<T> operator * (const affine<T>& lhs, const translation_mat4<T>& rhs)
+	{
+		affine<T> result = lhs;
+		result.Cols[3] = lhs.TransformPoint(rhs.Translation);
+		return result;
+	}
+
+	template <typename T>
+	vec4<T> operator * (const translation_mat4<T>& lhs, const vec4<T>& rhs)
+	{
+		const vec3<T>& t = lhs.Translation;
+		return vec4<T>(rhs.X + t.X * rhs.W, rhs.Y + t.Y * rhs.W, rhs.Z + t.Z * rhs.W, rhs.W);
+	}
+
+	template <typename T>
+	mat4<T> operator * (const projection_mat4<T>& lhs, const mat4<T>& rhs)
+	{
+		mat4<T> result;
+		Detail::ProjectColumns(lhs, rhs.Elements, result.Elements);
+		return result;
+	}
+
+	template <typename T>
+	mat4<T> operator * (const mat4<T>& lhs, const projection_mat4<T>& rhs)
+	{
+		// Columns 0, 1 and 3 are scaled columns of lhs; column 2 mixes all four
+		const T* m = lhs.Elements;
+		mat4<T> result;
+		for (int row = 0; row < 4; row++)
+		{
+			result.Elements[row] = m[row] * rhs.X;
+			result.Elements[4 + row] = m[4 + row] * rhs.Y;
+			result.Elements[8 + row] = m[row] * rhs.OffsetX + m[4 + row] * rhs.OffsetY + m[8 + row] * rhs.DepthScale - m[12 + row];
+			result.Elements[12 + row] = m[8 + row] * rhs.DepthOffset;
+		}
+		return result;
+	}
+
+	template <typename T>
+	mat4<T> operator * (const projection_mat4<T>& lhs, const affine<T>& rhs)
+	{
+		mat4<T> result;
+		for (int col = 0; col < 4; col++)
+			result.Cols[col] = lhs * vec4<T>(rhs.Cols[col], T(col == 3 ? 1 : 0));
+		return result;
+	}
+
+	template <typename T>
+	vec4<T> operator * (const projection_mat4<T>& lhs, const vec4<T>& rhs)
+	{
+		return vec4<T>(
+			lhs.X * rhs.X + lhs.OffsetX * rhs.Z,
+			lhs.Y * rhs.Y + lhs.OffsetY * rhs.Z,
+			lhs.DepthScale * rhs.Z + lhs.DepthOffset * rhs.W,
+			-rhs.Z);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace Maths::Containers::Detail {
+
+	template <typename F, size_t... I>
+	inline void UnrollImpl(F&& func, std::index_sequence<I...>)
+	{
+		(func(std::integral_constant<size_t, I>{}), ...);
+	}
+
+	// Calls func(0) ... func(N - 1) as a fold expression, so fixed-size loops are fully
+	// expanded at compile time instead of relying on the optimiser to unroll them.
+	template <size_t N, typename F>
+	inline void Unroll(F&& func)
+	{
+		UnrollImpl(func, std::make_index_sequence<N>{});
+	}
+
+}
\ No newline at end of file
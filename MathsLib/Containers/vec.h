@@ -0,0 +1,329 @@
+#pragma once
+
+#include "unroll.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/scalar.h"
+
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+namespace Maths::Containers {
+
+	template <size_t N, typename T>
+	struct vec;
+
+	// Operations shared by every vector shape. V is the concrete vector type, which
+	// stores its N components contiguously from its first member. All loops are
+	// unrolled at compile time so each shape gets straight-line code.
+	template <typename V, size_t N, typename T>
+	struct vec_ops
+	{
+		T* Data();
+		const T* Data() const;
+
+		T& operator [] (size_t index);
+		const T& operator [] (size_t index) const;
+
+		V& Add(const V& other);
+		V& Subtract(const V& other);
+		V& Multiply(const V& other);
+		V& Divide(const V& other);
+		V& Add(T scalar);
+		V& Subtract(T scalar);
+		V& Multiply(T scalar);
+		V& Divide(T scalar);
+
+		V& operator += (const V& rhs);
+		V& operator -= (const V& rhs);
+		V& operator *= (const V& rhs);
+		V& operator /= (const V& rhs);
+		V& operator += (T scalar);
+		V& operator -= (T scalar);
+		V& operator *= (T scalar);
+		V& operator /= (T scalar);
+
+		static T Dot(const V& lhs, const V& rhs);
+
+		T Magnitude() const;
+		V Normalise() const;
+
+		friend V operator + (V lhs, const V& rhs)
+		{
+			return lhs.Add(rhs);
+		}
+
+		friend V operator - (V lhs, const V& rhs)
+		{
+			return lhs.Subtract(rhs);
+		}
+
+		friend V operator * (V lhs, const V& rhs)
+		{
+			return lhs.Multiply(rhs);
+		}
+
+		friend V operator / (V lhs, const V& rhs)
+		{
+			return lhs.Divide(rhs);
+		}
+
+		friend V operator + (V lhs, T scalar)
+		{
+			return lhs.Add(scalar);
+		}
+
+		friend V operator - (V lhs, T scalar)
+		{
+			return lhs.Subtract(scalar);
+		}
+
+		friend V operator * (V lhs, T scalar)
+		{
+			return lhs.Multiply(scalar);
+		}
+
+		friend V operator / (V lhs, T scalar)
+		{
+			return lhs.Divide(scalar);
+		}
+
+		friend bool operator == (const V& lhs, const V& rhs)
+		{
+			bool equal = true;
+			Detail::Unroll<N>([&](auto i) { equal = equal && lhs.Data()[i] == rhs.Data()[i]; });
+			return equal;
+		}
+
+		friend bool operator != (const V& lhs, const V& rhs)
+		{
+			return !(lhs == rhs);
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const V& vector)
+		{
+			for (size_t i = 0; i < N; i++)
+				os << vector.Data()[i] << "\t";
+			return os;
+		}
+	};
+
+	// Generic N component vector. The 2, 3 and 4 component shapes are specialised in
+	// vec2.h, vec3.h and vec4.h to give them named X, Y, Z, W members.
+	template <size_t N, typename T>
+	struct vec : vec_ops<vec<N, T>, N, T>
+	{
+		T Elements[N];
+
+		vec() = default;
+		vec(T scalar);
+
+		template <typename... Args, typename = std::enable_if_t<(N > 1) && sizeof...(Args) == N>>
+		vec(Args... args) : Elements{ T(args)... }
+		{
+
+		}
+	};
+
+	// Deduction guides, so vec(x, y, z) and the aliases' vec3(x, y, z), vec3(s) and
+	// vec4(xyz, w) deduce the element type as they did when vec2, vec3 and vec4 were
+	// class templates. Deducing through an alias needs C++20.
+	template <typename T>
+	vec(T, T) -> vec<2, T>;
+
+	template <typename T>
+	vec(T, T, T) -> vec<3, T>;
+
+	template <typename T>
+	vec(T, T, T, T) -> vec<4, T>;
+
+	template <size_t N, typename T>
+	vec(T) -> vec<N, T>;
+
+	template <size_t N, typename T>
+	vec(const vec<N, T>&, T) -> vec<N + 1, T>;
+
+	template <size_t N, typename T>
+	vec<N, T>::vec(T scalar)
+	{
+		Detail::Unroll<N>([&](auto i) { Elements[i] = scalar; });
+	}
+
+	template <typename V, size_t N, typename T>
+	T* vec_ops<V, N, T>::Data()
+	{
+		return reinterpret_cast<T*>(static_cast<V*>(this));
+	}
+
+	template <typename V, size_t N, typename T>
+	const T* vec_ops<V, N, T>::Data() const
+	{
+		return reinterpret_cast<const T*>(static_cast<const V*>(this));
+	}
+
+	template <typename V, size_t N, typename T>
+	T& vec_ops<V, N, T>::operator [] (size_t index)
+	{
+		return Data()[index];
+	}
+
+	template <typename V, size_t N, typename T>
+	const T& vec_ops<V, N, T>::operator [] (size_t index) const
+	{
+		return Data()[index];
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Add(const V& other)
+	{
+		T* lhs = Data();
+		const T* rhs = other.Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] += rhs[i]; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Subtract(const V& other)
+	{
+		T* lhs = Data();
+		const T* rhs = other.Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] -= rhs[i]; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Multiply(const V& other)
+	{
+		T* lhs = Data();
+		const T* rhs = other.Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] *= rhs[i]; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Divide(const V& other)
+	{
+		T* lhs = Data();
+		const T* rhs = other.Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] /= rhs[i]; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Add(T scalar)
+	{
+		T* lhs = Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] += scalar; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Subtract(T scalar)
+	{
+		T* lhs = Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] -= scalar; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Multiply(T scalar)
+	{
+		T* lhs = Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] *= scalar; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::Divide(T scalar)
+	{
+		T* lhs = Data();
+		Detail::Unroll<N>([&](auto i) { lhs[i] /= scalar; });
+
+		return static_cast<V&>(*this);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator += (const V& rhs)
+	{
+		return Add(rhs);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator -= (const V& rhs)
+	{
+		return Subtract(rhs);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator *= (const V& rhs)
+	{
+		return Multiply(rhs);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator /= (const V& rhs)
+	{
+		return Divide(rhs);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator += (T scalar)
+	{
+		return Add(scalar);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator -= (T scalar)
+	{
+		return Subtract(scalar);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator *= (T scalar)
+	{
+		return Multiply(scalar);
+	}
+
+	template <typename V, size_t N, typename T>
+	V& vec_ops<V, N, T>::operator /= (T scalar)
+	{
+		return Divide(scalar);
+	}
+
+	template <typename V, size_t N, typename T>
+	T vec_ops<V, N, T>::Dot(const V& lhs, const V& rhs)
+	{
+		const T* a = lhs.Data();
+		const T* b = rhs.Data();
+		T sum = a[0] * b[0];
+		Detail::Unroll<N - 1>([&](auto i) { sum += a[i + 1] * b[i + 1]; });
+
+		return sum;
+	}
+
+	template <typename V, size_t N, typename T>
+	T vec_ops<V, N, T>::Magnitude() const
+	{
+		const V& self = static_cast<const V&>(*this);
+		return Utils::Sqrt(Dot(self, self));
+	}
+
+	template <typename V, size_t N, typename T>
+	V vec_ops<V, N, T>::Normalise() const
+	{
+		MATHS_PROFILE_CALL("vec::Normalise");
+
+		T length = Magnitude();
+		V result = static_cast<const V&>(*this);
+		return result.Divide(length);
+	}
+
+}
\ No newline at end of file
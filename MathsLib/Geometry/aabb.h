@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Maths::Geometry {
+
+	using namespace Maths::Containers;
+
+	template <typename T>
+	struct aabb
+	{
+		vec3<T> Min;
+		vec3<T> Max;
+
+		// An empty box: expanding it by any point gives a box containing just that point
+		static aabb<T> Empty();
+
+		void Expand(const vec3<T>& point);
+		void Expand(const aabb<T>& box);
+
+		vec3<T> Centre() const;
+		vec3<T> Extents() const;
+
+		// Squared distance from a point to the box, zero inside
+		T DistanceSquared(const vec3<T>& point) const;
+		bool IntersectsSphere(const vec3<T>& centre, T radius) const;
+	};
+
+	template <typename T>
+	aabb<T> aabb<T>::Empty()
+	{
+		T highest = std::numeric_limits<T>::max();
+		return aabb<T>{ vec3<T>(highest), vec3<T>(-highest) };
+	}
+
+	template <typename T>
+	void aabb<T>::Expand(const vec3<T>& point)
+	{
+		Min = vec3<T>(std::min(Min.X, point.X), std::min(Min.Y, point.Y), std::min(Min.Z, point.Z));
+		Max = vec3<T>(std::max(Max.X, point.X), std::max(Max.Y, point.Y), std::max(Max.Z, point.Z));
+	}
+
+	template <typename T>
+	void aabb<T>::Expand(const aabb<T>& box)
+	{
+		Expand(box.Min);
+		Expand(box.Max);
+	}
+
+	template <typename T>
+	vec3<T> aabb<T>::Centre() const
+	{
+		return (Min + Max) * T(0.5f);
+	}
+
+	template <typename T>
+	vec3<T> aabb<T>::Extents() const
+	{
+		return (Max - Min) * T(0.5f);
+	}
+
+	template <typename T>
+	T aabb<T>::DistanceSquared(const vec3<T>& point) const
+	{
+		T dx = std::max(std::max(Min.X - point.X, point.X - Max.X), T(0));
+		T dy = std::max(std::max(Min.Y - point.Y, point.Y - Max.Y), T(0));
+		T dz = std::max(std::max(Min.Z - point.Z, point.Z - Max.Z), T(0));
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	template <typename T>
+	bool aabb<T>::IntersectsSphere(const vec3<T>& centre, T radius) const
+	{
+		return DistanceSquared(centre) <= radius * radius;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#pragma once
+
+#include "aabb.h"
+#include "../Containers/vec3.h"
+#include "../Containers/vec4.h"
+#include "../Containers/mat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/lanes.h"
+#include "../Utils/parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Maths::Geometry {
+
+	// View space cluster volumes for a perspective projection. The screen is split into
+	// DimX x DimY tiles and the depth range into DimZ slices that grow exponentially
+	// with distance, so clusters stay roughly cube shaped.
+	template <typename T>
+	struct cluster_grid
+	{
+		uint32_t DimX = 0;
+		uint32_t DimY = 0;
+		uint32_t DimZ = 0;
+		T Near = T(0);
+		T Far = T(0);
+		std::vector<aabb<T>> Bounds;	// Index (z * DimY + y) * DimX + x
+
+		static cluster_grid<T> Build(const mat4<T>& projection, uint32_t dimX, uint32_t dimY, uint32_t dimZ, T n, T f);
+
+		uint32_t ClusterCount() const;
+		uint32_t Index(uint32_t x, uint32_t y, uint32_t z) const;
+		T SliceDepth(uint32_t slice) const;		// Positive view distance where a slice starts
+	};
+
+	// Compact per-cluster light lists: the lights of cluster i are
+	// Indices[Offsets[i]] ... Indices[Offsets[i + 1] - 1]
+	struct light_list
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Indices;
+	};
+
+	namespace Detail {
+
+		// std::max(a, b) written over a lane type L
+		template <typename L>
+		L Max(L a, L b)
+		{
+			return Utils::Select(Utils::Less(a, b), b, a);
+		}
+
+		// Bit k set when sphere k (view space centre and squared radius) overlaps the box.
+		// L is T for one light or lanes4 for four, with the same operations either way.
+		template <typename L, typename T>
+		int SphereOverlaps(const aabb<T>& box, L x, L y, L z, L radiusSquared)
+		{
+			L zero = L(T(0));
+			L dx = Max(Max(L(box.Min.X) - x, x - L(box.Max.X)), zero);
+			L dy = Max(Max(L(box.Min.Y) - y, y - L(box.Max.Y)), zero);
+			L dz = Max(Max(L(box.Min.Z) - z, z - L(box.Max.Z)), zero);
+			return Utils::Bits(Utils::LessEqual(dx * dx + dy * dy + dz * dz, radiusSquared));
+		}
+
+		// Bit k set when the depth range of sphere k overlaps [sliceFar, sliceNear]
+		template <typename L, typename T>
+		int SphereInSlice(T sliceNear, T sliceFar, L z, L radius)
+		{
+			return Utils::Bits(Utils::And(Utils::LessEqual(z - radius, L(sliceNear)), Utils::LessEqual(L(sliceFar), z + radius)));
+		}
+
+	}
+
+	template <typename T>
+	cluster_grid<T> cluster_grid<T>::Build(const mat4<T>& projection, uint32_t dimX, uint32_t dimY, uint32_t dimZ, T n, T f)
+	{
+		assert(n > T(0) && f > n && dimX > 0 && dimY > 0 && dimZ > 0);
+
+		cluster_grid<T> grid;
+		grid.DimX = dimX;
+		grid.DimY = dimY;
+		grid.DimZ = dimZ;
+		grid.Near = n;
+		grid.Far = f;
+		grid.Bounds.resize(size_t(dimX) * dimY * dimZ);
+
+		// The grid is only defined for perspective projections, whose inverse is closed form
+		mat4<T> inverse = mat4<T>::InversePerspective(projection);
+
+		// View space direction through each tile corner, scaled to unit depth (z = -1).
+		// NDC depth 0.5 is inside the clip range of every projection builder.
+		std::vector<vec3<T>> corners(size_t(dimX + 1) * (dimY + 1));
+		for (uint32_t y = 0; y <= dimY; y++)
+		{
+			for (uint32_t x = 0; x <= dimX; x++)
+			{
+				T ndcX = T(-1) + T(2) * T(x) / T(dimX);
+				T ndcY = T(-1) + T(2) * T(y) / T(dimY);
+				vec4<T> p = inverse * vec4<T>(ndcX, ndcY, T(0.5f), T(1));
+				T scale = T(1) / -p.Z;
+				corners[y * (dimX + 1) + x] = vec3<T>(p.X * scale, p.Y * scale, T(-1));
+			}
+		}
+
+		for (uint32_t z = 0; z < dimZ; z++)
+		{
+			T zNear = grid.SliceDepth(z);
+			T zFar = grid.SliceDepth(z + 1);
+
+			for (uint32_t y = 0; y < dimY; y++)
+			{
+				for (uint32_t x = 0; x < dimX; x++)
+				{
+					aabb<T> box = aabb<T>::Empty();
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						const vec3<T>& corner = corners[(y + c / 2) * (dimX + 1) + x + c % 2];
+						box.Expand(corner * zNear);
+						box.Expand(corner * zFar);
+					}
+					grid.Bounds[grid.Index(x, y, z)] = box;
+				}
+			}
+		}
+
+		return grid;
+	}
+
+	template <typename T>
+	uint32_t cluster_grid<T>::ClusterCount() const
+	{
+		return DimX * DimY * DimZ;
+	}
+
+	template <typename T>
+	uint32_t cluster_grid<T>::Index(uint32_t x, uint32_t y, uint32_t z) const
+	{
+		return (z * DimY + y) * DimX + x;
+	}
+
+	template <typename T>
+	T cluster_grid<T>::SliceDepth(uint32_t slice) const
+	{
+		// The slices are spaced geometrically from Near, which must be in front of the eye
+		assert(Near > T(0));
+
+		using std::pow;
+		return Near * T(pow(Far / Near, T(slice) / T(DimZ)));
+	}
+
+	// Bins light spheres (world space positions and radii, e.g. bounding spheres of spot
+	// cones) into the clusters. Light centres are moved to view space in one batch and
+	// kept as separate X/Y/Z/radius arrays, then every depth slice is processed on its
+	// own thread against only the lights overlapping its depth range. For float both
+	// sweeps, the depth cull and the sphere-box test of every tile, run four lights per
+	// lanes4; the lights that pass are appended in order, so the lists are the same as
+	// testing one light at a time.
+	template <typename T>
+	void AssignLights(const cluster_grid<T>& grid, const mat4<T>& view, const vec3<T>* positions, const T* radii, size_t count, light_list& out)
+	{
+		MATHS_PROFILE_KERNEL("AssignLights", count, count * (sizeof(vec3<T>) + sizeof(T)));
+
+		std::vector<T> lx(count), ly(count), lz(count);
+		const T* m = view.Elements;
+		for (size_t i = 0; i < count; i++)
+		{
+			const vec3<T>& p = positions[i];
+			lx[i] = m[0] * p.X + m[4] * p.Y + m[8] * p.Z + m[12];
+			ly[i] = m[1] * p.X + m[5] * p.Y + m[9] * p.Z + m[13];
+			lz[i] = m[2] * p.X + m[6] * p.Y + m[10] * p.Z + m[14];
+		}
+
+		uint32_t tiles = grid.DimX * grid.DimY;
+		std::vector<std::vector<uint32_t>> sliceIndices(grid.DimZ);
+		std::vector<uint32_t> counts(grid.ClusterCount(), 0);
+
+		Utils::ParallelFor(grid.DimZ, 1, [&](size_t firstSlice, size_t lastSlice)
+		{
+			// The candidates of a slice are copied together so the tile sweep reads them
+			// contiguously
+			std::vector<uint32_t> candidates;
+			std::vector<T> cx, cy, cz, cr;
+			auto appendHits = [&](int hits, const uint32_t* lights, std::vector<uint32_t>& indices)
+			{
+				uint32_t found = 0;
+				for (int l = 0; hits >> l; l++)
+				{
+					if (hits & (1 << l))
+					{
+						indices.push_back(lights[l]);
+						found++;
+					}
+				}
+				return found;
+			};
+
+			for (size_t z = firstSlice; z < lastSlice; z++)
+			{
+				T sliceNear = -grid.SliceDepth(uint32_t(z));
+				T sliceFar = -grid.SliceDepth(uint32_t(z) + 1);
+
+				candidates.clear();
+				size_t i = 0;
+#ifdef MATHS_SSE
+				if constexpr (std::is_same_v<T, float>)
+				{
+					for (; i < count - count % 4; i += 4)
+					{
+						int hits = Detail::SphereInSlice(sliceNear, sliceFar,
+							Utils::Gather(&lz[i], &lz[i + 1], &lz[i + 2], &lz[i + 3]),
+							Utils::Gather(&radii[i], &radii[i + 1], &radii[i + 2], &radii[i + 3]));
+						for (int l = 0; hits >> l; l++)
+							if (hits & (1 << l))
+								candidates.push_back(uint32_t(i + l));
+					}
+				}
+#endif
+				for (; i < count; i++)
+					if (Detail::SphereInSlice(sliceNear, sliceFar, lz[i], radii[i]))
+						candidates.push_back(uint32_t(i));
+
+				size_t n = candidates.size();
+				cx.resize(n);
+				cy.resize(n);
+				cz.resize(n);
+				cr.resize(n);
+				for (size_t c = 0; c < n; c++)
+				{
+					uint32_t light = candidates[c];
+					cx[c] = lx[light];
+					cy[c] = ly[light];
+					cz[c] = lz[light];
+					cr[c] = radii[light] * radii[light];
+				}
+
+				std::vector<uint32_t>& indices = sliceIndices[z];
+				indices.clear();
+				for (uint32_t tile = 0; tile < tiles; tile++)
+				{
+					uint32_t cluster = uint32_t(z) * tiles + tile;
+					const aabb<T>& box = grid.Bounds[cluster];
+					uint32_t found = 0;
+
+					size_t c = 0;
+#ifdef MATHS_SSE
+					if constexpr (std::is_same_v<T, float>)
+					{
+						for (; c < n - n % 4; c += 4)
+						{
+							int hits = Detail::SphereOverlaps(box,
+								Utils::Gather(&cx[c], &cx[c + 1], &cx[c + 2], &cx[c + 3]),
+								Utils::Gather(&cy[c], &cy[c + 1], &cy[c + 2], &cy[c + 3]),
+								Utils::Gather(&cz[c], &cz[c + 1], &cz[c + 2], &cz[c + 3]),
+								Utils::Gather(&cr[c], &cr[c + 1], &cr[c + 2], &cr[c + 3]));
+							found += appendHits(hits, &candidates[c], indices);
+						}
+					}
+#endif
+					for (; c < n; c++)
+						found += appendHits(Detail::SphereOverlaps(box, cx[c], cy[c], cz[c], cr[c]), &candidates[c], indices);
+
+					counts[cluster] = found;
+				}
+			}
+		});
+
+		// Slices are already in cluster order, so compaction is a prefix sum and a copy
+		out.Offsets.resize(size_t(grid.ClusterCount()) + 1);
+		out.Offsets[0] = 0;
+		for (uint32_t cluster = 0; cluster < grid.ClusterCount(); cluster++)
+			out.Offsets[cluster + 1] = out.Offsets[cluster] + counts[cluster];
+
+		out.Indices.clear();
+		out.Indices.reserve(out.Offsets.back());
+		for (const std::vector<uint32_t>& indices : sliceIndices)
+			out.Indices.insert(out.Indices.end(), indices.begin(), indices.end());
+	}
+
+}
\ No newline at end of file
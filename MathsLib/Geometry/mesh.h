@@ -0,0 +1,401 @@
+#pragma once
+
+#include "../Containers/vec2.h"
+#include "../Containers/vec3.h"
+#include "../Containers/vec4.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/lanes.h"
+#include "../Utils/parallel.h"
+#include "../Utils/scalar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Maths::Geometry {
+
+	using namespace Maths::Containers;
+
+	enum class normal_weighting
+	{
+		Area,	// Unnormalised face normals, so larger triangles count more
+		Angle	// Unit face normals weighted by the corner angle; independent of tessellation
+	};
+
+	// Triangle corners around each vertex: the corners of vertex v are
+	// Corners[Offsets[v]] ... Corners[Offsets[v + 1] - 1], each encoded as
+	// triangle * 3 + corner and sorted ascending. Depends only on the index buffer, so
+	// deforming meshes build it once and reuse it every frame.
+	struct mesh_adjacency
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Corners;
+
+		static mesh_adjacency Build(const uint32_t* indices, size_t triangleCount, size_t vertexCount);
+
+		size_t VertexCount() const;
+	};
+
+	inline mesh_adjacency mesh_adjacency::Build(const uint32_t* indices, size_t triangleCount, size_t vertexCount)
+	{
+		MATHS_PROFILE_KERNEL("mesh_adjacency::Build", triangleCount, triangleCount * 3 * 2 * sizeof(uint32_t));
+
+		mesh_adjacency adjacency;
+		adjacency.Offsets.assign(vertexCount + 1, 0);
+		adjacency.Corners.resize(triangleCount * 3);
+
+		for (size_t corner = 0; corner < triangleCount * 3; corner++)
+			adjacency.Offsets[indices[corner] + 1]++;
+		for (size_t v = 0; v < vertexCount; v++)
+			adjacency.Offsets[v + 1] += adjacency.Offsets[v];
+
+		// Scattering in corner order keeps each vertex's list sorted
+		std::vector<uint32_t> next(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+		for (size_t corner = 0; corner < triangleCount * 3; corner++)
+			adjacency.Corners[next[indices[corner]]++] = uint32_t(corner);
+
+		return adjacency;
+	}
+
+	inline size_t mesh_adjacency::VertexCount() const
+	{
+		return Offsets.empty() ? 0 : Offsets.size() - 1;
+	}
+
+	namespace Detail {
+
+		// Angle at a corner from the cosine between its edges and the product of their
+		// lengths; a corner with a zero length edge has none
+		template <typename T>
+		T CornerAngle(T cosine, T lengths)
+		{
+			return lengths <= T(0) ? T(0) : Utils::Acos(cosine);
+		}
+
+		// Cosine of the corner between edge u leaving it and edge v arriving at it, clamped
+		// to [-1, 1], and the product of the edge lengths
+		template <typename L>
+		void CornerCosine(const L* u, const L* v, L uLength, L vLength, L& cosine, L& lengths)
+		{
+			lengths = uLength * vLength;
+			cosine = -(u[0] * v[0] + u[1] * v[1] + u[2] * v[2]) / lengths;
+			cosine = Utils::Select(Utils::Less(cosine, L(-1.0f)), L(-1.0f), cosine);
+			cosine = Utils::Select(Utils::Less(L(1.0f), cosine), L(1.0f), cosine);
+		}
+
+		// Unnormalised normal of the triangle p[vertex][axis], and at each corner the cosine
+		// between its two edges (clamped to [-1, 1]) and the product of their lengths.
+		// Written once over the lane type L.
+		template <typename L>
+		void FaceCorners(const L (&p)[3][3], L (&normal)[3], L (&cosines)[3], L (&lengths)[3])
+		{
+			// Edge k runs from vertex k to the next, so corner k lies between edge k and edge
+			// k - 1 and each edge length is taken once
+			L e0[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+			L e1[3] = { p[2][0] - p[1][0], p[2][1] - p[1][1], p[2][2] - p[1][2] };
+			L e2[3] = { p[0][0] - p[2][0], p[0][1] - p[2][1], p[0][2] - p[2][2] };
+			L l0 = Utils::Sqrt(e0[0] * e0[0] + e0[1] * e0[1] + e0[2] * e0[2]);
+			L l1 = Utils::Sqrt(e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2]);
+			L l2 = Utils::Sqrt(e2[0] * e2[0] + e2[1] * e2[1] + e2[2] * e2[2]);
+
+			L w[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+			normal[0] = e0[1] * w[2] - e0[2] * w[1];
+			normal[1] = e0[2] * w[0] - e0[0] * w[2];
+			normal[2] = e0[0] * w[1] - e0[1] * w[0];
+
+			CornerCosine(e0, e2, l0, l2, cosines[0], lengths[0]);
+			CornerCosine(e1, e0, l1, l0, cosines[1], lengths[1]);
+			CornerCosine(e2, e1, l2, l1, cosines[2], lengths[2]);
+		}
+
+		// Directions of increasing U (tangent) and V (bitangent) across a triangle, from its
+		// edges e1, e2 and their UV deltas d1, d2. Scaling by the sign of the UV area rather
+		// than dividing by it keeps nearly degenerate UVs from blowing up; only the
+		// direction is used.
+		template <typename L>
+		void FaceTangent(const L (&e1)[3], const L (&e2)[3], const L (&d1)[2], const L (&d2)[2], L (&tangent)[3], L (&bitangent)[3])
+		{
+			L area = d1[0] * d2[1] - d2[0] * d1[1];
+			L sign = Utils::Select(Utils::Less(L(0.0f), area), L(1.0f), Utils::Select(Utils::Less(area, L(0.0f)), L(-1.0f), L(0.0f)));
+			for (int a = 0; a < 3; a++)
+			{
+				tangent[a] = (e1[a] * d2[1] - e2[a] * d1[1]) * sign;
+				bitangent[a] = (e2[a] * d1[0] - e1[a] * d2[0]) * sign;
+			}
+		}
+
+		// The (unnormalised) face normal of every triangle and, unless cornerAngles is null,
+		// the angle at every corner. Float triangles go four per lanes4, gathered through the
+		// index buffer; only acos is evaluated per lane.
+		template <typename T>
+		void FaceData(const vec3<T>* positions, const uint32_t* indices, size_t triangleCount, std::vector<vec3<T>>& faceNormals, std::vector<T>* cornerAngles)
+		{
+			faceNormals.resize(triangleCount);
+			if (cornerAngles)
+				cornerAngles->resize(triangleCount * 3);
+
+			Utils::ParallelFor(triangleCount, 1 << 13, [&](size_t begin, size_t end)
+			{
+				size_t t = begin;
+#ifdef MATHS_SSE
+				if constexpr (std::is_same_v<T, float>)
+				{
+					for (; t < end - (end - begin) % 4; t += 4)
+					{
+						const uint32_t* index = indices + t * 3;
+
+						Utils::lanes4 p[3][3], normal[3], cosines[3], lengths[3];
+						for (int k = 0; k < 3; k++)
+						{
+							const vec3<T>& q0 = positions[index[k]];
+							const vec3<T>& q1 = positions[index[3 + k]];
+							const vec3<T>& q2 = positions[index[6 + k]];
+							const vec3<T>& q3 = positions[index[9 + k]];
+							p[k][0] = Utils::Gather(&q0.X, &q1.X, &q2.X, &q3.X);
+							p[k][1] = Utils::Gather(&q0.Y, &q1.Y, &q2.Y, &q3.Y);
+							p[k][2] = Utils::Gather(&q0.Z, &q1.Z, &q2.Z, &q3.Z);
+						}
+
+						FaceCorners(p, normal, cosines, lengths);
+
+						vec3<T>* n = faceNormals.data() + t;
+						Utils::Scatter(normal[0], &n[0].X, &n[1].X, &n[2].X, &n[3].X);
+						Utils::Scatter(normal[1], &n[0].Y, &n[1].Y, &n[2].Y, &n[3].Y);
+						Utils::Scatter(normal[2], &n[0].Z, &n[1].Z, &n[2].Z, &n[3].Z);
+
+						if (cornerAngles)
+						{
+							alignas(16) T cosine[3][4], length[3][4];
+							for (int k = 0; k < 3; k++)
+							{
+								_mm_store_ps(cosine[k], cosines[k].Value);
+								_mm_store_ps(length[k], lengths[k].Value);
+							}
+
+							T* angles = cornerAngles->data() + t * 3;
+							for (int l = 0; l < 4; l++)
+								for (int k = 0; k < 3; k++)
+									angles[l * 3 + k] = CornerAngle(cosine[k][l], length[k][l]);
+						}
+					}
+				}
+#endif
+				for (; t < end; t++)
+				{
+					T p[3][3], normal[3], cosines[3], lengths[3];
+					for (int k = 0; k < 3; k++)
+					{
+						const vec3<T>& q = positions[indices[t * 3 + k]];
+						p[k][0] = q.X;
+						p[k][1] = q.Y;
+						p[k][2] = q.Z;
+					}
+
+					FaceCorners(p, normal, cosines, lengths);
+
+					faceNormals[t] = vec3<T>(normal[0], normal[1], normal[2]);
+					if (cornerAngles)
+						for (int k = 0; k < 3; k++)
+							(*cornerAngles)[t * 3 + k] = CornerAngle(cosines[k], lengths[k]);
+				}
+			});
+		}
+
+		// e projected onto the plane perpendicular to the unit vector n, normalised unless
+		// nothing is left of it
+		template <typename T>
+		vec3<T> ProjectNormalised(const vec3<T>& e, const vec3<T>& n)
+		{
+			vec3<T> projected = e - n * vec3<T>::Dot(n, e);
+			T length = projected.Magnitude();
+			return length > T(0) ? projected / length : projected;
+		}
+
+		// Any unit vector perpendicular to n
+		template <typename T>
+		vec3<T> Perpendicular(const vec3<T>& n)
+		{
+			using std::abs;
+			vec3<T> axis = abs(n.X) < abs(n.Y) ? vec3<T>(T(1), T(0), T(0)) : vec3<T>(T(0), T(1), T(0));
+			return vec3<T>::Cross(n, axis).Normalise();
+		}
+
+	}
+
+	// Vertex normals of an indexed triangle list (three indices per counter-clockwise
+	// triangle). Face data is computed in one parallel pass over the triangles, four per
+	// lanes4 for float, then every vertex gathers from its own adjacency list in a second,
+	// so no two threads write the same vertex and the result does not depend on the
+	// thread count. Vertices without triangles, or whose triangles are all degenerate,
+	// get a zero normal.
+	template <typename T>
+	void ComputeNormals(const vec3<T>* positions, const uint32_t* indices, size_t triangleCount, const mesh_adjacency& adjacency, vec3<T>* normals, normal_weighting weighting = normal_weighting::Angle)
+	{
+		size_t vertexCount = adjacency.VertexCount();
+		MATHS_PROFILE_KERNEL("ComputeNormals", vertexCount, vertexCount * 2 * sizeof(vec3<T>) + triangleCount * 3 * sizeof(uint32_t));
+
+		std::vector<vec3<T>> faceNormals;
+		std::vector<T> cornerAngles;
+		Detail::FaceData(positions, indices, triangleCount, faceNormals, weighting == normal_weighting::Angle ? &cornerAngles : nullptr);
+
+		if (weighting == normal_weighting::Angle)
+		{
+			Utils::ParallelFor(triangleCount, 1 << 13, [&](size_t begin, size_t end)
+			{
+				for (size_t t = begin; t < end; t++)
+				{
+					T length = faceNormals[t].Magnitude();
+					faceNormals[t] = length > T(0) ? faceNormals[t] / length : vec3<T>(T(0));
+				}
+			});
+		}
+
+		Utils::ParallelFor(vertexCount, 1 << 13, [&](size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				vec3<T> sum(T(0));
+				for (uint32_t i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; i++)
+				{
+					uint32_t corner = adjacency.Corners[i];
+					if (weighting == normal_weighting::Angle)
+						sum += faceNormals[corner / 3] * cornerAngles[corner];
+					else
+						sum += faceNormals[corner / 3];
+				}
+
+				T length = sum.Magnitude();
+				normals[v] = length > T(0) ? sum / length : vec3<T>(T(0));
+			}
+		});
+	}
+
+	// Per-vertex tangent frames matching MikkTSpace for meshes that are already split
+	// where the tangent space is discontinuous (UV seams and mirrored UVs), which is how
+	// index buffers for rendering are normally built. As in MikkTSpace, each corner's UV
+	// derivatives are projected onto the vertex's tangent plane, normalised and weighted
+	// by the corner angle measured between the corner's edges projected onto that same
+	// plane; the sum is orthonormalised against the normal. W holds the handedness, so
+	// the bitangent is Cross(normal, tangent.XYZ) * W.
+	template <typename T>
+	void ComputeTangents(const vec3<T>* positions, const vec2<T>* uvs, const vec3<T>* normals, const uint32_t* indices, size_t triangleCount, const mesh_adjacency& adjacency, vec4<T>* tangents)
+	{
+		size_t vertexCount = adjacency.VertexCount();
+		MATHS_PROFILE_KERNEL("ComputeTangents", vertexCount, vertexCount * (2 * sizeof(vec3<T>) + sizeof(vec2<T>) + sizeof(vec4<T>)));
+
+		// Object space directions of increasing U and V across each triangle
+		std::vector<vec3<T>> faceTangents(triangleCount);
+		std::vector<vec3<T>> faceBitangents(triangleCount);
+
+		Utils::ParallelFor(triangleCount, 1 << 13, [&](size_t begin, size_t end)
+		{
+			size_t t = begin;
+#ifdef MATHS_SSE
+			if constexpr (std::is_same_v<T, float>)
+			{
+				for (; t < end - (end - begin) % 4; t += 4)
+				{
+					const uint32_t* index = indices + t * 3;
+
+					Utils::lanes4 e1[3], e2[3], d1[2], d2[2], tangent[3], bitangent[3];
+					for (int a = 0; a < 3; a++)
+					{
+						const T* p0[4];
+						const T* p1[4];
+						const T* p2[4];
+						for (int l = 0; l < 4; l++)
+						{
+							p0[l] = &positions[index[l * 3]][a];
+							p1[l] = &positions[index[l * 3 + 1]][a];
+							p2[l] = &positions[index[l * 3 + 2]][a];
+						}
+						Utils::lanes4 origin = Utils::Gather(p0[0], p0[1], p0[2], p0[3]);
+						e1[a] = Utils::Gather(p1[0], p1[1], p1[2], p1[3]) - origin;
+						e2[a] = Utils::Gather(p2[0], p2[1], p2[2], p2[3]) - origin;
+					}
+					for (int a = 0; a < 2; a++)
+					{
+						const T* uv0[4];
+						const T* uv1[4];
+						const T* uv2[4];
+						for (int l = 0; l < 4; l++)
+						{
+							uv0[l] = &uvs[index[l * 3]][a];
+							uv1[l] = &uvs[index[l * 3 + 1]][a];
+							uv2[l] = &uvs[index[l * 3 + 2]][a];
+						}
+						Utils::lanes4 origin = Utils::Gather(uv0[0], uv0[1], uv0[2], uv0[3]);
+						d1[a] = Utils::Gather(uv1[0], uv1[1], uv1[2], uv1[3]) - origin;
+						d2[a] = Utils::Gather(uv2[0], uv2[1], uv2[2], uv2[3]) - origin;
+					}
+
+					Detail::FaceTangent(e1, e2, d1, d2, tangent, bitangent);
+
+					vec3<T>* ft = faceTangents.data() + t;
+					vec3<T>* fb = faceBitangents.data() + t;
+					for (int a = 0; a < 3; a++)
+					{
+						Utils::Scatter(tangent[a], &ft[0][a], &ft[1][a], &ft[2][a], &ft[3][a]);
+						Utils::Scatter(bitangent[a], &fb[0][a], &fb[1][a], &fb[2][a], &fb[3][a]);
+					}
+				}
+			}
+#endif
+			for (; t < end; t++)
+			{
+				uint32_t i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+				vec3<T> p1 = positions[i1] - positions[i0];
+				vec3<T> p2 = positions[i2] - positions[i0];
+				vec2<T> uv1 = uvs[i1] - uvs[i0];
+				vec2<T> uv2 = uvs[i2] - uvs[i0];
+
+				T e1[3] = { p1.X, p1.Y, p1.Z }, e2[3] = { p2.X, p2.Y, p2.Z };
+				T d1[2] = { uv1.X, uv1.Y }, d2[2] = { uv2.X, uv2.Y };
+				T tangent[3], bitangent[3];
+				Detail::FaceTangent(e1, e2, d1, d2, tangent, bitangent);
+
+				faceTangents[t] = vec3<T>(tangent[0], tangent[1], tangent[2]);
+				faceBitangents[t] = vec3<T>(bitangent[0], bitangent[1], bitangent[2]);
+			}
+		});
+
+		Utils::ParallelFor(vertexCount, 1 << 13, [&](size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				const vec3<T>& n = normals[v];
+				vec3<T> tangent(T(0));
+				vec3<T> bitangent(T(0));
+
+				for (uint32_t i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; i++)
+				{
+					uint32_t corner = adjacency.Corners[i];
+					uint32_t t = corner / 3;
+					uint32_t k = corner % 3;
+
+					// The corner angle between the edges to the next and previous vertex,
+					// both flattened onto the tangent plane
+					const vec3<T>& p = positions[indices[corner]];
+					vec3<T> u = Detail::ProjectNormalised(positions[indices[t * 3 + (k + 1) % 3]] - p, n);
+					vec3<T> w = Detail::ProjectNormalised(positions[indices[t * 3 + (k + 2) % 3]] - p, n);
+					T angle = Utils::Acos(std::min(std::max(vec3<T>::Dot(u, w), T(-1)), T(1)));
+
+					tangent += Detail::ProjectNormalised(faceTangents[t], n) * angle;
+					bitangent += Detail::ProjectNormalised(faceBitangents[t], n) * angle;
+				}
+
+				// Gram-Schmidt against the normal; fall back to any perpendicular direction
+				// when the UVs give none
+				tangent -= n * vec3<T>::Dot(n, tangent);
+				T length = tangent.Magnitude();
+				tangent = length > T(0) ? tangent / length : Detail::Perpendicular(n);
+
+				T handedness = vec3<T>::Dot(vec3<T>::Cross(n, tangent), bitangent) < T(0) ? T(-1) : T(1);
+				tangents[v] = vec4<T>(tangent, handedness);
+			}
+		});
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+
+#include <cmath>
+#include <vector>
+
+namespace Maths::Geometry {
+
+	using namespace Maths::Containers;
+
+	// Robust orientation tests (Shewchuk's predicates). The determinant is evaluated in
+	// double with a forward error bound; only when its sign is within the bound, i.e. the
+	// points are (nearly) degenerate, is it recomputed exactly with expansion arithmetic.
+	// Coordinates are converted to double, so float inputs are handled exactly too.
+
+	// Positive if d lies below the plane through a, b and c, taking "above" as the side
+	// from which a, b and c appear counterclockwise; zero if the four points are coplanar
+	template <typename T>
+	int Orient3D(const vec3<T>& a, const vec3<T>& b, const vec3<T>& c, const vec3<T>& d);
+
+	// Positive if e lies inside the sphere through a, b, c and d, negative if outside and
+	// zero if on it, for a, b, c, d with positive Orient3D (the sign flips otherwise)
+	template <typename T>
+	int InSphere(const vec3<T>& a, const vec3<T>& b, const vec3<T>& c, const vec3<T>& d, const vec3<T>& e);
+
+	namespace Detail {
+
+		// Relative error bounds of the double evaluations, from Shewchuk's analysis
+		constexpr double Epsilon = 1.1102230246251565e-16;	// 2^-53
+		constexpr double Orient3DBound = (7.0 + 56.0 * Epsilon) * Epsilon;
+		constexpr double InSphereBound = (16.0 + 224.0 * Epsilon) * Epsilon;
+
+		// Exact sum of doubles as a list of non-overlapping components, ordered by
+		// increasing magnitude, so the sign of the sum is the sign of the last one
+		using expansion = std::vector<double>;
+
+		inline void TwoSum(double a, double b, double& sum, double& error)
+		{
+			sum = a + b;
+			double bVirtual = sum - a;
+			double aVirtual = sum - bVirtual;
+			error = (a - aVirtual) + (b - bVirtual);
+		}
+
+		inline void TwoProduct(double a, double b, double& product, double& error)
+		{
+			product = a * b;
+			error = std::fma(a, b, -product);
+		}
+
+		inline expansion Difference(double a, double b)
+		{
+			double sum, error;
+			TwoSum(a, -b, sum, error);
+
+			expansion result;
+			if (error != 0.0)
+				result.push_back(error);
+			if (sum != 0.0)
+				result.push_back(sum);
+			return result;
+		}
+
+		// e + b, dropping zero components
+		inline expansion Grow(const expansion& e, double b)
+		{
+			expansion result;
+			result.reserve(e.size() + 1);
+
+			double q = b;
+			for (double component : e)
+			{
+				double sum, error;
+				TwoSum(q, component, sum, error);
+				if (error != 0.0)
+					result.push_back(error);
+				q = sum;
+			}
+			if (q != 0.0)
+				result.push_back(q);
+			return result;
+		}
+
+		inline expansion Sum(const expansion& e, const expansion& f)
+		{
+			expansion result = e;
+			for (double component : f)
+				result = Grow(result, component);
+			return result;
+		}
+
+		inline expansion Negate(expansion e)
+		{
+			for (double& component : e)
+				component = -component;
+			return e;
+		}
+
+		inline expansion Scale(const expansion& e, double b)
+		{
+			expansion result;
+			result.reserve(e.size() * 2);
+
+			double q = 0.0;
+			for (double component : e)
+			{
+				double product, productError, sum, sumError;
+				TwoProduct(component, b, product, productError);
+				TwoSum(q, productError, sum, sumError);
+				if (sumError != 0.0)
+					result.push_back(sumError);
+				TwoSum(product, sum, q, sumError);
+				if (sumError != 0.0)
+					result.push_back(sumError);
+			}
+			if (q != 0.0)
+				result.push_back(q);
+			return result;
+		}
+
+		inline expansion Product(const expansion& e, const expansion& f)
+		{
+			expansion result;
+			for (double component : f)
+				result = Sum(result, Scale(e, component));
+			return result;
+		}
+
+		inline int Sign(const expansion& e)
+		{
+			if (e.empty())
+				return 0;
+			return e.back() > 0.0 ? 1 : (e.back() < 0.0 ? -1 : 0);
+		}
+
+		inline int Sign(double value)
+		{
+			return value > 0.0 ? 1 : (value < 0.0 ? -1 : 0);
+		}
+
+		inline int Orient3DExact(const double* a, const double* b, const double* c, const double* d)
+		{
+			expansion adx = Difference(a[0], d[0]), ady = Difference(a[1], d[1]), adz = Difference(a[2], d[2]);
+			expansion bdx = Difference(b[0], d[0]), bdy = Difference(b[1], d[1]), bdz = Difference(b[2], d[2]);
+			expansion cdx = Difference(c[0], d[0]), cdy = Difference(c[1], d[1]), cdz = Difference(c[2], d[2]);
+
+			expansion bc = Sum(Product(bdx, cdy), Negate(Product(cdx, bdy)));
+			expansion ca = Sum(Product(cdx, ady), Negate(Product(adx, cdy)));
+			expansion ab = Sum(Product(adx, bdy), Negate(Product(bdx, ady)));
+
+			return Sign(Sum(Sum(Product(adz, bc), Product(bdz, ca)), Product(cdz, ab)));
+		}
+
+		inline int InSphereExact(const double* a, const double* b, const double* c, const double* d, const double* e)
+		{
+			const double* points[4] = { a, b, c, d };
+			expansion x[4], y[4], z[4], lift[4];
+			for (int i = 0; i < 4; i++)
+			{
+				x[i] = Difference(points[i][0], e[0]);
+				y[i] = Difference(points[i][1], e[1]);
+				z[i] = Difference(points[i][2], e[2]);
+				lift[i] = Sum(Sum(Product(x[i], x[i]), Product(y[i], y[i])), Product(z[i], z[i]));
+			}
+
+			// 2x2 minors of the x and y columns
+			auto minor = [&](int i, int j) { return Sum(Product(x[i], y[j]), Negate(Product(x[j], y[i]))); };
+			expansion ab = minor(0, 1), bc = minor(1, 2), cd = minor(2, 3), da = minor(3, 0);
+			expansion ac = minor(0, 2), bd = minor(1, 3);
+
+			// 3x3 minors, as in the filtered evaluation
+			expansion abc = Sum(Sum(Product(z[0], bc), Negate(Product(z[1], ac))), Product(z[2], ab));
+			expansion bcd = Sum(Sum(Product(z[1], cd), Negate(Product(z[2], bd))), Product(z[3], bc));
+			expansion cda = Sum(Sum(Product(z[2], da), Product(z[3], ac)), Product(z[0], cd));
+			expansion dab = Sum(Sum(Product(z[3], ab), Product(z[0], bd)), Product(z[1], da));
+
+			expansion det = Sum(
+				Sum(Product(lift[3], abc), Negate(Product(lift[2], dab))),
+				Sum(Product(lift[1], cda), Negate(Product(lift[0], bcd))));
+			return Sign(det);
+		}
+
+	}
+
+	template <typename T>
+	int Orient3D(const vec3<T>& a, const vec3<T>& b, const vec3<T>& c, const vec3<T>& d)
+	{
+		double pa[3] = { double(a.X), double(a.Y), double(a.Z) };
+		double pb[3] = { double(b.X), double(b.Y), double(b.Z) };
+		double pc[3] = { double(c.X), double(c.Y), double(c.Z) };
+		double pd[3] = { double(d.X), double(d.Y), double(d.Z) };
+
+		double adx = pa[0] - pd[0], ady = pa[1] - pd[1], adz = pa[2] - pd[2];
+		double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1], bdz = pb[2] - pd[2];
+		double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1], cdz = pc[2] - pd[2];
+
+		double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+		double cdxady = cdx * ady, adxcdy = adx * cdy;
+		double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+		double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+		double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz)
+			+ (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz)
+			+ (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+
+		if (std::fabs(det) > Detail::Orient3DBound * permanent)
+			return Detail::Sign(det);
+
+		return Detail::Orient3DExact(pa, pb, pc, pd);
+	}
+
+	template <typename T>
+	int InSphere(const vec3<T>& a, const vec3<T>& b, const vec3<T>& c, const vec3<T>& d, const vec3<T>& e)
+	{
+		double pa[3] = { double(a.X), double(a.Y), double(a.Z) };
+		double pb[3] = { double(b.X), double(b.Y), double(b.Z) };
+		double pc[3] = { double(c.X), double(c.Y), double(c.Z) };
+		double pd[3] = { double(d.X), double(d.Y), double(d.Z) };
+		double pe[3] = { double(e.X), double(e.Y), double(e.Z) };
+
+		double aex = pa[0] - pe[0], aey = pa[1] - pe[1], aez = pa[2] - pe[2];
+		double bex = pb[0] - pe[0], bey = pb[1] - pe[1], bez = pb[2] - pe[2];
+		double cex = pc[0] - pe[0], cey = pc[1] - pe[1], cez = pc[2] - pe[2];
+		double dex = pd[0] - pe[0], dey = pd[1] - pe[1], dez = pd[2] - pe[2];
+
+		double aexbey = aex * bey, bexaey = bex * aey;
+		double bexcey = bex * cey, cexbey = cex * bey;
+		double cexdey = cex * dey, dexcey = dex * cey;
+		double dexaey = dex * aey, aexdey = aex * dey;
+		double aexcey = aex * cey, cexaey = cex * aey;
+		double bexdey = bex * dey, dexbey = dex * bey;
+
+		double ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+		double da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+
+		double abc = aez * bc - bez * ac + cez * ab;
+		double bcd = bez * cd - cez * bd + dez * bc;
+		double cda = cez * da + dez * ac + aez * cd;
+		double dab = dez * ab + aez * bd + bez * da;
+
+		double alift = aex * aex + aey * aey + aez * aez;
+		double blift = bex * bex + bey * bey + bez * bez;
+		double clift = cex * cex + cey * cey + cez * cez;
+		double dlift = dex * dex + dey * dey + dez * dez;
+
+		double det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+		double aezplus = std::fabs(aez), bezplus = std::fabs(bez), cezplus = std::fabs(cez), dezplus = std::fabs(dez);
+		double aexbeyplus = std::fabs(aexbey), bexaeyplus = std::fabs(bexaey);
+		double bexceyplus = std::fabs(bexcey), cexbeyplus = std::fabs(cexbey);
+		double cexdeyplus = std::fabs(cexdey), dexceyplus = std::fabs(dexcey);
+		double dexaeyplus = std::fabs(dexaey), aexdeyplus = std::fabs(aexdey);
+		double aexceyplus = std::fabs(aexcey), cexaeyplus = std::fabs(cexaey);
+		double bexdeyplus = std::fabs(bexdey), dexbeyplus = std::fabs(dexbey);
+
+		double permanent = ((cexdeyplus + dexceyplus) * bezplus + (dexbeyplus + bexdeyplus) * cezplus + (bexceyplus + cexbeyplus) * dezplus) * alift
+			+ ((dexaeyplus + aexdeyplus) * cezplus + (aexceyplus + cexaeyplus) * dezplus + (cexdeyplus + dexceyplus) * aezplus) * blift
+			+ ((aexbeyplus + bexaeyplus) * dezplus + (bexdeyplus + dexbeyplus) * aezplus + (dexaeyplus + aexdeyplus) * bezplus) * clift
+			+ ((bexceyplus + cexbeyplus) * aezplus + (cexaeyplus + aexceyplus) * bezplus + (aexbeyplus + bexaeyplus) * cezplus) * dlift;
+
+		if (std::fabs(det) > Detail::InSphereBound * permanent)
+			return Detail::Sign(det);
+
+		return Detail::InSphereExact(pa, pb, pc, pd, pe);
+	}
+
+}
\ No newline at end of file
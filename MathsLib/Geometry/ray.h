@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Containers/vec4.h"
+#include "../Containers/mat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Maths::Geometry {
+
+	using namespace Maths::Containers;
+
+	template <typename T>
+	struct ray
+	{
+		vec3<T> Origin;
+		vec3<T> Direction;
+	};
+
+	// Maps a point in normalised device coordinates back through an inverse
+	// (view-)projection matrix
+	template <typename T>
+	vec3<T> Unproject(const mat4<T>& inverseProjection, const vec3<T>& ndc)
+	{
+		vec4<T> p = inverseProjection * vec4<T>(ndc, T(1));
+		return vec3<T>(p.X / p.W, p.Y / p.W, p.Z / p.W);
+	}
+
+	// Ray through the given NDC x and y, from depth ndcNear towards depth ndcFar.
+	// The far point may be at infinity (w = 0), as with the infinite projections.
+	template <typename T>
+	ray<T> UnprojectRay(const mat4<T>& inverseProjection, T x, T y, T ndcNear, T ndcFar)
+	{
+		vec4<T> n = inverseProjection * vec4<T>(x, y, ndcNear, T(1));
+		vec4<T> f = inverseProjection * vec4<T>(x, y, ndcFar, T(1));
+
+		// far - near without dividing by far.W: (f.xyz * n.w - n.xyz * f.w) / (n.w * f.w)
+		vec3<T> direction(f.X * n.W - n.X * f.W, f.Y * n.W - n.Y * f.W, f.Z * n.W - n.Z * f.W);
+		if (n.W * f.W < T(0))
+			direction *= T(-1);
+
+		return ray<T>{ vec3<T>(n.X / n.W, n.Y / n.W, n.Z / n.W), direction.Normalise() };
+	}
+
+	// Generates one ray per pixel centre of a width x height grid, row by row from the
+	// top-left pixel. Unprojection is linear in homogeneous coordinates, so each pixel
+	// is its row's start plus the column times the step between pixels, instead of two
+	// matrix * vector products. Computing it per pixel rather than adding the step
+	// again and again keeps the error of wide rows from growing along the row. Rows are
+	// split across threads.
+	template <typename T>
+	void GenerateRays(const mat4<T>& inverseProjection, uint32_t width, uint32_t height, T ndcNear, T ndcFar, ray<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("GenerateRays", size_t(width) * height, size_t(width) * height * sizeof(ray<T>));
+
+		T dx = T(2) / T(width);
+		T dy = T(2) / T(height);
+
+		// Homogeneous near and far points at NDC (0, 0) and the step between pixels in a row
+		vec4<T> nearBase = inverseProjection * vec4<T>(T(0), T(0), ndcNear, T(1));
+		vec4<T> farBase = inverseProjection * vec4<T>(T(0), T(0), ndcFar, T(1));
+		vec4<T> stepX = inverseProjection.Cols[0] * dx;
+
+		Utils::ParallelFor(height, 16, [=](size_t firstRow, size_t lastRow)
+		{
+			for (size_t row = firstRow; row < lastRow; row++)
+			{
+				T x0 = T(-1) + T(0.5f) * dx;
+				T y = T(1) - (T(row) + T(0.5f)) * dy;
+				vec4<T> offset = inverseProjection.Cols[0] * x0 + inverseProjection.Cols[1] * y;
+				vec4<T> nearStart = nearBase + offset;
+				vec4<T> farStart = farBase + offset;
+
+				ray<T>* line = out + row * width;
+				for (uint32_t col = 0; col < width; col++)
+				{
+					vec4<T> step = stepX * T(col);
+					vec4<T> n = nearStart + step;
+					vec4<T> f = farStart + step;
+
+					T invW = T(1) / n.W;
+					vec3<T> direction(f.X * n.W - n.X * f.W, f.Y * n.W - n.Y * f.W, f.Z * n.W - n.Z * f.W);
+					if (n.W * f.W < T(0))
+						direction *= T(-1);
+
+					line[col].Origin = vec3<T>(n.X * invW, n.Y * invW, n.Z * invW);
+					line[col].Direction = direction.Normalise();
+				}
+			}
+		});
+	}
+
+}
\ No newline at end of file
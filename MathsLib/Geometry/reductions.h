@@ -0,0 +1,314 @@
+#pragma once
+
+#include "aabb.h"
+#include "../Containers/vec.h"
+#include "../Containers/mat3.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace Maths::Geometry {
+
+	using namespace Maths::Containers;
+
+	enum class summation
+	{
+		Naive,		// Interleaved running sums; fastest, error grows with the count
+		Pairwise,	// Short runs added as a balanced tree; error grows with log(count)
+		Kahan		// Compensated running sums; error does not grow with the count
+	};
+
+	// Reductions over arrays of vectors. Each thread reduces a contiguous range with four
+	// interleaved accumulators, which breaks the add latency chain and lets the compiler
+	// keep them in SIMD registers; the per-thread results are combined in range order
+	// (see Utils::ParallelReduce). Kahan summation is undone by -ffast-math.
+
+	template <typename T>
+	aabb<T> Bounds(const vec3<T>* points, size_t count);
+
+	// Component-wise minimum and maximum. Both are left untouched when count is zero.
+	template <size_t N, typename T>
+	void MinMax(const vec<N, T>* values, size_t count, vec<N, T>& min, vec<N, T>& max);
+
+	template <size_t N, typename T>
+	vec<N, T> Sum(const vec<N, T>* values, size_t count, summation method = summation::Pairwise);
+
+	// Zero when count is zero
+	template <size_t N, typename T>
+	vec<N, T> Centroid(const vec<N, T>* values, size_t count, summation method = summation::Pairwise);
+
+	// Sum of Dot(lhs[i], rhs[i])
+	template <size_t N, typename T>
+	T Dot(const vec<N, T>* lhs, const vec<N, T>* rhs, size_t count, summation method = summation::Pairwise);
+
+	// Covariance about the centroid, normalised by count (zero when count is zero). Two
+	// passes, centroid first, so large coordinate offsets do not cancel catastrophically;
+	// its eigenvectors (LinearAlgebra::SymmetricEigen) are the axes for OBB fitting.
+	template <typename T>
+	mat3<T> Covariance(const vec3<T>* points, size_t count, summation method = summation::Pairwise);
+
+	namespace Detail {
+
+		constexpr size_t ReductionThreshold = 1 << 16;
+		constexpr size_t PairwiseBlock = 256;
+
+		// M running sums, and for Kahan the low-order part each has not absorbed yet
+		template <size_t M, typename T>
+		struct partial_sum
+		{
+			T Sum[M] = {};
+			T Error[M] = {};
+		};
+
+		// Kahan step: the error left by each addition is carried into the next one, so it
+		// stays within an ulp of the sum. The error is computed with two-sum, which is exact
+		// whichever operand is larger.
+		template <typename T>
+		void CompensatedAdd(T& sum, T& error, T value)
+		{
+			T corrected = value + error;
+			T result = sum + corrected;
+			T correctedVirtual = result - sum;
+			T sumVirtual = result - correctedVirtual;
+			error = (sum - sumVirtual) + (corrected - correctedVirtual);
+			sum = result;
+		}
+
+		// term(i, values) writes the M values item i contributes
+		template <bool Compensated, size_t M, typename T, typename Term>
+		partial_sum<M, T> RunningSum(size_t begin, size_t end, const Term& term)
+		{
+			T sums[4][M] = {};
+			T errors[4][M] = {};
+			T values[4][M];
+
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				for (size_t lane = 0; lane < 4; lane++)
+					term(i + lane, values[lane]);
+
+				for (size_t lane = 0; lane < 4; lane++)
+				{
+					for (size_t m = 0; m < M; m++)
+					{
+						if constexpr (Compensated)
+							CompensatedAdd(sums[lane][m], errors[lane][m], values[lane][m]);
+						else
+							sums[lane][m] += values[lane][m];
+					}
+				}
+			}
+			for (; i < end; i++)
+			{
+				term(i, values[0]);
+				for (size_t m = 0; m < M; m++)
+				{
+					if constexpr (Compensated)
+						CompensatedAdd(sums[0][m], errors[0][m], values[0][m]);
+					else
+						sums[0][m] += values[0][m];
+				}
+			}
+
+			partial_sum<M, T> result;
+			for (size_t m = 0; m < M; m++)
+			{
+				result.Sum[m] = sums[0][m];
+				result.Error[m] = errors[0][m];
+				for (size_t lane = 1; lane < 4; lane++)
+				{
+					CompensatedAdd(result.Sum[m], result.Error[m], sums[lane][m]);
+					CompensatedAdd(result.Sum[m], result.Error[m], errors[lane][m]);
+				}
+			}
+			return result;
+		}
+
+		template <size_t M, typename T, typename Term>
+		partial_sum<M, T> PairwiseSum(size_t begin, size_t end, const Term& term)
+		{
+			if (end - begin <= PairwiseBlock)
+				return RunningSum<false, M, T>(begin, end, term);
+
+			size_t middle = begin + (end - begin) / 2;
+			partial_sum<M, T> result = PairwiseSum<M, T>(begin, middle, term);
+			partial_sum<M, T> right = PairwiseSum<M, T>(middle, end, term);
+			for (size_t m = 0; m < M; m++)
+				result.Sum[m] += right.Sum[m];
+			return result;
+		}
+
+		template <size_t M, typename T, typename Term>
+		void Reduce(size_t count, summation method, const Term& term, T* out)
+		{
+			partial_sum<M, T> total = Utils::ParallelReduce(count, ReductionThreshold, partial_sum<M, T>(),
+				[&](size_t begin, size_t end)
+				{
+					if (method == summation::Pairwise)
+						return PairwiseSum<M, T>(begin, end, term);
+					if (method == summation::Kahan)
+						return RunningSum<true, M, T>(begin, end, term);
+					return RunningSum<false, M, T>(begin, end, term);
+				},
+				[](partial_sum<M, T> lhs, const partial_sum<M, T>& rhs)
+				{
+					for (size_t m = 0; m < M; m++)
+					{
+						CompensatedAdd(lhs.Sum[m], lhs.Error[m], rhs.Sum[m]);
+						CompensatedAdd(lhs.Sum[m], lhs.Error[m], rhs.Error[m]);
+					}
+					return lhs;
+				});
+
+			for (size_t m = 0; m < M; m++)
+				out[m] = total.Sum[m] + total.Error[m];
+		}
+
+	}
+
+	template <typename T>
+	aabb<T> Bounds(const vec3<T>* points, size_t count)
+	{
+		aabb<T> result = aabb<T>::Empty();
+		MinMax(points, count, result.Min, result.Max);
+		return result;
+	}
+
+	template <size_t N, typename T>
+	void MinMax(const vec<N, T>* values, size_t count, vec<N, T>& min, vec<N, T>& max)
+	{
+		MATHS_PROFILE_KERNEL("MinMax", count, count * sizeof(vec<N, T>));
+
+		if (count == 0)
+			return;
+
+		// Minimum in the first N components, maximum in the last N
+		using bounds = vec<2 * N, T>;
+		bounds empty;
+		for (size_t n = 0; n < N; n++)
+		{
+			empty[n] = std::numeric_limits<T>::max();
+			empty[N + n] = std::numeric_limits<T>::lowest();
+		}
+
+		bounds result = Utils::ParallelReduce(count, Detail::ReductionThreshold, empty,
+			[=](size_t begin, size_t end)
+			{
+				bounds lanes[4] = { empty, empty, empty, empty };
+
+				size_t i = begin;
+				for (; i + 4 <= end; i += 4)
+				{
+					for (size_t lane = 0; lane < 4; lane++)
+					{
+						for (size_t n = 0; n < N; n++)
+						{
+							T value = values[i + lane][n];
+							lanes[lane][n] = std::min(lanes[lane][n], value);
+							lanes[lane][N + n] = std::max(lanes[lane][N + n], value);
+						}
+					}
+				}
+				for (; i < end; i++)
+				{
+					for (size_t n = 0; n < N; n++)
+					{
+						lanes[0][n] = std::min(lanes[0][n], values[i][n]);
+						lanes[0][N + n] = std::max(lanes[0][N + n], values[i][n]);
+					}
+				}
+
+				for (size_t n = 0; n < N; n++)
+				{
+					lanes[0][n] = std::min(std::min(lanes[0][n], lanes[1][n]), std::min(lanes[2][n], lanes[3][n]));
+					lanes[0][N + n] = std::max(std::max(lanes[0][N + n], lanes[1][N + n]), std::max(lanes[2][N + n], lanes[3][N + n]));
+				}
+				return lanes[0];
+			},
+			[](bounds lhs, const bounds& rhs)
+			{
+				for (size_t n = 0; n < N; n++)
+				{
+					lhs[n] = std::min(lhs[n], rhs[n]);
+					lhs[N + n] = std::max(lhs[N + n], rhs[N + n]);
+				}
+				return lhs;
+			});
+
+		for (size_t n = 0; n < N; n++)
+		{
+			min[n] = result[n];
+			max[n] = result[N + n];
+		}
+	}
+
+	template <size_t N, typename T>
+	vec<N, T> Sum(const vec<N, T>* values, size_t count, summation method)
+	{
+		MATHS_PROFILE_KERNEL("Sum", count, count * sizeof(vec<N, T>));
+
+		vec<N, T> result(T(0));
+		Detail::Reduce<N, T>(count, method, [=](size_t i, T* out)
+		{
+			for (size_t n = 0; n < N; n++)
+				out[n] = values[i][n];
+		}, &result[0]);
+		return result;
+	}
+
+	template <size_t N, typename T>
+	vec<N, T> Centroid(const vec<N, T>* values, size_t count, summation method)
+	{
+		if (count == 0)
+			return vec<N, T>(T(0));
+		return Sum(values, count, method) / T(count);
+	}
+
+	template <size_t N, typename T>
+	T Dot(const vec<N, T>* lhs, const vec<N, T>* rhs, size_t count, summation method)
+	{
+		MATHS_PROFILE_KERNEL("Dot", count, count * 2 * sizeof(vec<N, T>));
+
+		T result = T(0);
+		Detail::Reduce<1, T>(count, method, [=](size_t i, T* out) { out[0] = vec<N, T>::Dot(lhs[i], rhs[i]); }, &result);
+		return result;
+	}
+
+	template <typename T>
+	mat3<T> Covariance(const vec3<T>* points, size_t count, summation method)
+	{
+		MATHS_PROFILE_KERNEL("Covariance", count, count * 2 * sizeof(vec3<T>));
+
+		if (count == 0)
+			return mat3<T>(T(0));
+
+		vec3<T> centre = Centroid(points, count, method);
+
+		// xx, xy, xz, yy, yz, zz
+		T moments[6];
+		Detail::Reduce<6, T>(count, method, [=](size_t i, T* out)
+		{
+			T x = points[i].X - centre.X, y = points[i].Y - centre.Y, z = points[i].Z - centre.Z;
+			out[0] = x * x;
+			out[1] = x * y;
+			out[2] = x * z;
+			out[3] = y * y;
+			out[4] = y * z;
+			out[5] = z * z;
+		}, moments);
+
+		T scale = T(1) / T(count);
+		for (T& moment : moments)
+			moment *= scale;
+
+		return mat3<T>(
+			vec3<T>(moments[0], moments[1], moments[2]),
+			vec3<T>(moments[1], moments[3], moments[4]),
+			vec3<T>(moments[2], moments[4], moments[5]));
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "../Containers/mat3.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/lanes.h"
+#include "../Utils/parallel.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Maths::LinearAlgebra {
+
+	using namespace Maths::Containers;
+
+	// Eigenvalues in decreasing order, with the unit eigenvectors as the matching columns
+	// of a rotation (determinant +1)
+	template <typename T>
+	struct symmetric_eigen3
+	{
+		vec3<T> Values;
+		mat3<T> Vectors;
+	};
+
+	// A = U * diag(Sigma) * V^T with U and V rotations. Sigma is sorted by decreasing
+	// magnitude and only the last value can be negative, which happens when det(A) < 0:
+	// a reflection is carried by the sign of Sigma rather than by U or V.
+	template <typename T>
+	struct svd3
+	{
+		mat3<T> U;
+		vec3<T> Sigma;
+		mat3<T> V;
+	};
+
+	// A = Rotation * Stretch with Stretch symmetric. Rotation is always proper, so for
+	// reflections (det(A) < 0) Stretch has a negative eigenvalue, as shape matching and
+	// FEM with inverted elements expect.
+	template <typename T>
+	struct polar3
+	{
+		mat3<T> Rotation;
+		mat3<T> Stretch;
+	};
+
+	// Branch-free 3x3 decompositions after McAdams et al., "Computing the Singular Value
+	// Decomposition of 3x3 matrices with minimal branching and elementary floating point
+	// operations": a fixed number of approximate Jacobi sweeps on A^T A, a sort of the
+	// columns of A V, then a Givens QR of them. There are no data-dependent branches, so
+	// the batch versions run four float matrices at once in SSE lanes.
+	// Only the lower triangle of the input to SymmetricEigen is read.
+	template <typename T>
+	symmetric_eigen3<T> SymmetricEigen(const mat3<T>& matrix);
+
+	template <typename T>
+	svd3<T> SVD(const mat3<T>& matrix);
+
+	template <typename T>
+	polar3<T> PolarDecomposition(const mat3<T>& matrix);
+
+	template <typename T>
+	void SymmetricEigen(const mat3<T>* matrices, size_t count, symmetric_eigen3<T>* out);
+
+	template <typename T>
+	void SVD(const mat3<T>* matrices, size_t count, svd3<T>* out);
+
+	template <typename T>
+	void PolarDecomposition(const mat3<T>* matrices, size_t count, polar3<T>* out);
+
+	namespace Detail {
+
+		// The kernels below are written over a lane type (see Utils/lanes.h); matrices are
+		// nine L in column-major order
+
+		// Enough sweeps for the off-diagonal to fall below the rounding error of T. The
+		// approximate angles converge slowest on clustered eigenvalues: there float needs 6
+		// sweeps and double 7, and double and long double get margin on top.
+		template <typename L>
+		constexpr int JacobiSweeps = std::is_floating_point_v<L> && !std::is_same_v<L, float> ? 12 : 6;
+
+		template <typename L>
+		void SetIdentity(L* matrix)
+		{
+			for (int i = 0; i < 9; i++)
+				matrix[i] = L(i % 4 == 0 ? 1.0f : 0.0f);
+		}
+
+		// Rotates columns P and Q of matrix by the angle with cosine c and sine s
+		template <int P, int Q, typename L>
+		void RotateColumns(L* matrix, L c, L s)
+		{
+			// Both outputs are sums (c * mq + (-s) * mp is exactly c * mq - s * mp): GCC's
+			// vectoriser turns a mul feeding an add/sub pair into fmsubadd even when
+			// contraction is off, which would break MATHS_DETERMINISTIC
+			L negS = -s;
+			for (int row = 0; row < 3; row++)
+			{
+				L mp = matrix[P * 3 + row], mq = matrix[Q * 3 + row];
+				matrix[P * 3 + row] = c * mp + s * mq;
+				matrix[Q * 3 + row] = c * mq + negS * mp;
+			}
+		}
+
+		// Cosine and sine of the Jacobi rotation that diagonalises [spp spq; spq sqq], from
+		// the cheap half-angle approximation of McAdams et al. It is exact to third order in
+		// the angle and is clamped to pi/4 where it is inaccurate.
+		template <typename L>
+		void JacobiAngle(L spp, L sqq, L spq, L& c, L& s)
+		{
+			const L Gamma = L(5.82842712474619);	// 3 + 2 sqrt(2) = cot^2(pi/8)
+			const L CosPi8 = L(0.923879532511287);
+			const L SinPi8 = L(0.382683432365090);
+
+			L ch = L(2.0f) * (spp - sqq);
+			L sh = spq;
+			auto accurate = Utils::Less(Gamma * sh * sh, ch * ch);
+			L length = Utils::Sqrt(ch * ch + sh * sh);
+			ch = Utils::Select(accurate, ch / length, CosPi8);
+			sh = Utils::Select(accurate, sh / length, SinPi8);
+
+			c = ch * ch - sh * sh;
+			s = L(2.0f) * ch * sh;
+		}
+
+		// One Jacobi rotation in the (P, Q) plane of the symmetric s (both halves are kept),
+		// accumulated into the columns of v
+		template <int P, int Q, typename L>
+		void JacobiRotate(L* s, L* v)
+		{
+			constexpr int K = 3 - P - Q;
+
+			L spp = s[P * 4], sqq = s[Q * 4], spq = s[P * 3 + Q];
+			L spk = s[P * 3 + K], sqk = s[Q * 3 + K];
+
+			L c, sn;
+			JacobiAngle(spp, sqq, spq, c, sn);
+			L cc = c * c, ss = sn * sn, cs = c * sn;
+
+			s[P * 4] = cc * spp + L(2.0f) * cs * spq + ss * sqq;
+			s[Q * 4] = ss * spp - L(2.0f) * cs * spq + cc * sqq;
+			s[P * 3 + Q] = s[Q * 3 + P] = (cc - ss) * spq - cs * (spp - sqq);
+			s[P * 3 + K] = s[K * 3 + P] = c * spk + sn * sqk;
+			s[Q * 3 + K] = s[K * 3 + Q] = c * sqk - sn * spk;
+
+			RotateColumns<P, Q>(v, c, sn);
+		}
+
+		// One-sided Jacobi rotation making columns P and Q of b orthogonal, accumulated into
+		// the columns of v. The Gram entries come straight from b, so they are accurate
+		// relative to each column rather than to the largest singular value.
+		template <int P, int Q, typename L>
+		void OrthogonaliseColumns(L* b, L* v)
+		{
+			const L* bp = b + P * 3;
+			const L* bq = b + Q * 3;
+
+			L c, s;
+			JacobiAngle(bp[0] * bp[0] + bp[1] * bp[1] + bp[2] * bp[2], bq[0] * bq[0] + bq[1] * bq[1] + bq[2] * bq[2], bp[0] * bq[0] + bp[1] * bq[1] + bp[2] * bq[2], c, s);
+
+			RotateColumns<P, Q>(b, c, s);
+			RotateColumns<P, Q>(v, c, s);
+		}
+
+		template <typename L>
+		void JacobiEigen(L* s, L* v)
+		{
+			SetIdentity(v);
+			for (int sweep = 0; sweep < JacobiSweeps<L>; sweep++)
+			{
+				JacobiRotate<0, 1>(s, v);
+				JacobiRotate<1, 2>(s, v);
+				JacobiRotate<0, 2>(s, v);
+			}
+		}
+
+		// Orders columns I < J of every matrix by decreasing key. The swap negates one
+		// column so rotations stay rotations.
+		template <int I, int J, typename L, typename... Matrices>
+		void SortColumns(L* keys, Matrices*... matrices)
+		{
+			auto swap = Utils::Less(keys[I], keys[J]);
+			L ki = keys[I], kj = keys[J];
+			keys[I] = Utils::Select(swap, kj, ki);
+			keys[J] = Utils::Select(swap, ki, kj);
+
+			auto sort = [&](L* matrix)
+			{
+				for (int row = 0; row < 3; row++)
+				{
+					L a = matrix[I * 3 + row], b = matrix[J * 3 + row];
+					matrix[I * 3 + row] = Utils::Select(swap, b, a);
+					matrix[J * 3 + row] = Utils::Select(swap, -a, b);
+				}
+			};
+			(sort(matrices), ...);
+		}
+
+		// Givens rotation of rows P and Q of b that zeroes b(Q, P), accumulated into the
+		// columns of u so that u * b stays unchanged
+		template <int P, int Q, typename L>
+		void QRRotate(L* b, L* u)
+		{
+			L a1 = b[P * 3 + P], a2 = b[P * 3 + Q];
+			L rho = Utils::Sqrt(a1 * a1 + a2 * a2);
+			auto nonZero = Utils::Less(L(0.0f), rho);
+			L c = Utils::Select(nonZero, a1 / rho, L(1.0f));
+			L s = Utils::Select(nonZero, a2 / rho, L(0.0f));
+
+			// Written as sums for the reason given in RotateColumns
+			L negS = -s;
+			for (int col = 0; col < 3; col++)
+			{
+				L bp = b[col * 3 + P], bq = b[col * 3 + Q];
+				b[col * 3 + P] = c * bp + s * bq;
+				b[col * 3 + Q] = c * bq + negS * bp;
+			}
+			RotateColumns<P, Q>(u, c, s);
+		}
+
+		template <typename L>
+		void SymmetricEigen(const L* a, L* values, L* vectors)
+		{
+			L s[9];
+			for (int col = 0; col < 3; col++)
+				for (int row = 0; row < 3; row++)
+					s[col * 3 + row] = row >= col ? a[col * 3 + row] : a[row * 3 + col];
+
+			JacobiEigen(s, vectors);
+
+			for (int i = 0; i < 3; i++)
+				values[i] = s[i * 4];
+			SortColumns<0, 1>(values, vectors);
+			SortColumns<0, 2>(values, vectors);
+			SortColumns<1, 2>(values, vectors);
+		}
+
+		template <typename L>
+		void SVD(const L* a, L* u, L* sigma, L* v)
+		{
+			// The eigenvectors of A^T A are the right singular vectors
+			L s[9];
+			for (int col = 0; col < 3; col++)
+				for (int row = 0; row < 3; row++)
+					s[col * 3 + row] = a[row * 3] * a[col * 3] + a[row * 3 + 1] * a[col * 3 + 1] + a[row * 3 + 2] * a[col * 3 + 2];
+
+			JacobiEigen(s, v);
+
+			// B = A V has orthogonal columns, up to the error of squaring A. One one-sided
+			// sweep on B itself removes that error for small singular values.
+			L b[9];
+			for (int col = 0; col < 3; col++)
+				for (int row = 0; row < 3; row++)
+					b[col * 3 + row] = a[row] * v[col * 3] + a[3 + row] * v[col * 3 + 1] + a[6 + row] * v[col * 3 + 2];
+
+			OrthogonaliseColumns<0, 1>(b, v);
+			OrthogonaliseColumns<1, 2>(b, v);
+			OrthogonaliseColumns<0, 2>(b, v);
+
+			L lengths[3];
+			for (int col = 0; col < 3; col++)
+				lengths[col] = b[col * 3] * b[col * 3] + b[col * 3 + 1] * b[col * 3 + 1] + b[col * 3 + 2] * b[col * 3 + 2];
+			SortColumns<0, 1>(lengths, b, v);
+			SortColumns<0, 2>(lengths, b, v);
+			SortColumns<1, 2>(lengths, b, v);
+
+			// B = U R; R is diagonal up to rounding and holds the singular values, which
+			// keeps small ones accurate instead of taking roots of the eigenvalues of A^T A
+			SetIdentity(u);
+			QRRotate<0, 1>(b, u);
+			QRRotate<0, 2>(b, u);
+			QRRotate<1, 2>(b, u);
+
+			for (int i = 0; i < 3; i++)
+				sigma[i] = b[i * 4];
+		}
+
+		template <typename L>
+		void Polar(const L* a, L* rotation, L* stretch)
+		{
+			L u[9], sigma[3], v[9];
+			SVD(a, u, sigma, v);
+
+			for (int col = 0; col < 3; col++)
+			{
+				for (int row = 0; row < 3; row++)
+				{
+					rotation[col * 3 + row] = u[row] * v[col] + u[3 + row] * v[3 + col] + u[6 + row] * v[6 + col];
+					stretch[col * 3 + row] = sigma[0] * v[row] * v[col] + sigma[1] * v[3 + row] * v[3 + col] + sigma[2] * v[6 + row] * v[6 + col];
+				}
+			}
+		}
+
+		template <typename T>
+		void SymmetricEigenRange(const mat3<T>* matrices, size_t begin, size_t end, symmetric_eigen3<T>* out)
+		{
+			size_t i = begin;
+#ifdef MATHS_SSE
+			if constexpr (std::is_same_v<T, float>)
+			{
+				for (; i + 4 <= end; i += 4)
+				{
+					const mat3<T>* m = matrices + i;
+					symmetric_eigen3<T>* o = out + i;
+
+					Utils::lanes4 a[9], values[3], vectors[9];
+					for (int e = 0; e < 9; e++)
+						a[e] = Utils::Gather(&m[0].Elements[e], &m[1].Elements[e], &m[2].Elements[e], &m[3].Elements[e]);
+
+					SymmetricEigen(a, values, vectors);
+
+					Utils::Scatter(values[0], &o[0].Values.X, &o[1].Values.X, &o[2].Values.X, &o[3].Values.X);
+					Utils::Scatter(values[1], &o[0].Values.Y, &o[1].Values.Y, &o[2].Values.Y, &o[3].Values.Y);
+					Utils::Scatter(values[2], &o[0].Values.Z, &o[1].Values.Z, &o[2].Values.Z, &o[3].Values.Z);
+					for (int e = 0; e < 9; e++)
+						Utils::Scatter(vectors[e], &o[0].Vectors.Elements[e], &o[1].Vectors.Elements[e], &o[2].Vectors.Elements[e], &o[3].Vectors.Elements[e]);
+				}
+			}
+#endif
+			for (; i < end; i++)
+			{
+				T values[3];
+				SymmetricEigen(matrices[i].Elements, values, out[i].Vectors.Elements);
+				out[i].Values = vec3<T>(values[0], values[1], values[2]);
+			}
+		}
+
+		template <typename T>
+		void SVDRange(const mat3<T>* matrices, size_t begin, size_t end, svd3<T>* out)
+		{
+			size_t i = begin;
+#ifdef MATHS_SSE
+			if constexpr (std::is_same_v<T, float>)
+			{
+				for (; i + 4 <= end; i += 4)
+				{
+					const mat3<T>* m = matrices + i;
+					svd3<T>* o = out + i;
+
+					Utils::lanes4 a[9], u[9], sigma[3], v[9];
+					for (int e = 0; e < 9; e++)
+						a[e] = Utils::Gather(&m[0].Elements[e], &m[1].Elements[e], &m[2].Elements[e], &m[3].Elements[e]);
+
+					SVD(a, u, sigma, v);
+
+					Utils::Scatter(sigma[0], &o[0].Sigma.X, &o[1].Sigma.X, &o[2].Sigma.X, &o[3].Sigma.X);
+					Utils::Scatter(sigma[1], &o[0].Sigma.Y, &o[1].Sigma.Y, &o[2].Sigma.Y, &o[3].Sigma.Y);
+					Utils::Scatter(sigma[2], &o[0].Sigma.Z, &o[1].Sigma.Z, &o[2].Sigma.Z, &o[3].Sigma.Z);
+					for (int e = 0; e < 9; e++)
+					{
+						Utils::Scatter(u[e], &o[0].U.Elements[e], &o[1].U.Elements[e], &o[2].U.Elements[e], &o[3].U.Elements[e]);
+						Utils::Scatter(v[e], &o[0].V.Elements[e], &o[1].V.Elements[e], &o[2].V.Elements[e], &o[3].V.Elements[e]);
+					}
+				}
+			}
+#endif
+			for (; i < end; i++)
+			{
+				T sigma[3];
+				SVD(matrices[i].Elements, out[i].U.Elements, sigma, out[i].V.Elements);
+				out[i].Sigma = vec3<T>(sigma[0], sigma[1], sigma[2]);
+			}
+		}
+
+		template <typename T>
+		void PolarRange(const mat3<T>* matrices, size_t begin, size_t end, polar3<T>* out)
+		{
+			size_t i = begin;
+#ifdef MATHS_SSE
+			if constexpr (std::is_same_v<T, float>)
+			{
+				for (; i + 4 <= end; i += 4)
+				{
+					const mat3<T>* m = matrices + i;
+					polar3<T>* o = out + i;
+
+					Utils::lanes4 a[9], rotation[9], stretch[9];
+					for (int e = 0; e < 9; e++)
+						a[e] = Utils::Gather(&m[0].Elements[e], &m[1].Elements[e], &m[2].Elements[e], &m[3].Elements[e]);
+
+					Polar(a, rotation, stretch);
+
+					for (int e = 0; e < 9; e++)
+					{
+						Utils::Scatter(rotation[e], &o[0].Rotation.Elements[e], &o[1].Rotation.Elements[e], &o[2].Rotation.Elements[e], &o[3].Rotation.Elements[e]);
+						Utils::Scatter(stretch[e], &o[0].Stretch.Elements[e], &o[1].Stretch.Elements[e], &o[2].Stretch.Elements[e], &o[3].Stretch.Elements[e]);
+					}
+				}
+			}
+#endif
+			for (; i < end; i++)
+				Polar(matrices[i].Elements, out[i].Rotation.Elements, out[i].Stretch.Elements);
+		}
+
+	}
+
+	template <typename T>
+	symmetric_eigen3<T> SymmetricEigen(const mat3<T>& matrix)
+	{
+		symmetric_eigen3<T> result;
+		Detail::SymmetricEigenRange(&matrix, 0, 1, &result);
+		return result;
+	}
+
+	template <typename T>
+	svd3<T> SVD(const mat3<T>& matrix)
+	{
+		svd3<T> result;
+		Detail::SVDRange(&matrix, 0, 1, &result);
+		return result;
+	}
+
+	template <typename T>
+	polar3<T> PolarDecomposition(const mat3<T>& matrix)
+	{
+		polar3<T> result;
+		Detail::PolarRange(&matrix, 0, 1, &result);
+		return result;
+	}
+
+	template <typename T>
+	void SymmetricEigen(const mat3<T>* matrices, size_t count, symmetric_eigen3<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("SymmetricEigen", count, count * (sizeof(mat3<T>) + sizeof(symmetric_eigen3<T>)));
+		Utils::ParallelFor(count, 1024, [=](size_t begin, size_t end) { Detail::SymmetricEigenRange(matrices, begin, end, out); });
+	}
+
+	template <typename T>
+	void SVD(const mat3<T>* matrices, size_t count, svd3<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("SVD", count, count * (sizeof(mat3<T>) + sizeof(svd3<T>)));
+		Utils::ParallelFor(count, 1024, [=](size_t begin, size_t end) { Detail::SVDRange(matrices, begin, end, out); });
+	}
+
+	template <typename T>
+	void PolarDecomposition(const mat3<T>* matrices, size_t count, polar3<T>* out)
+	{
+		MATHS_PROFILE_KERNEL("PolarDecomposition", count, count * (sizeof(mat3<T>) + sizeof(polar3<T>)));
+		Utils::ParallelFor(count, 1024, [=](size_t begin, size_t end) { Detail::PolarRange(matrices, begin, end, out); });
+	}
+
+}
\ No newline at end of file
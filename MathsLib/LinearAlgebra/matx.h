@@ -0,0 +1,196 @@
+#pragma once
+
+#include "vecx.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace Maths::LinearAlgebra {
+
+	// Dynamically sized dense matrix, column-major like the fixed-size mat types
+	template <typename T>
+	struct matx
+	{
+		size_t Rows = 0;
+		size_t Cols = 0;
+		std::vector<T> Elements;
+
+		matx() = default;
+		matx(size_t rows, size_t cols, T diagonal = T(0));
+
+		T& operator () (size_t row, size_t col);
+		const T& operator () (size_t row, size_t col) const;
+
+		static matx<T> Identity(size_t size);
+		static matx<T> Transpose(const matx<T>& matrix);
+		static matx<T> Multiply(const matx<T>& lhs, const matx<T>& rhs);
+
+		// out may be the same vector as vector
+		static void Multiply(const matx<T>& matrix, const vecx<T>& vector, vecx<T>& out);
+
+		friend matx<T> operator * (const matx<T>& lhs, const matx<T>& rhs)
+		{
+			return Multiply(lhs, rhs);
+		}
+
+		friend vecx<T> operator * (const matx<T>& lhs, const vecx<T>& rhs)
+		{
+			vecx<T> result;
+			Multiply(lhs, rhs, result);
+			return result;
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const matx<T>& matrix)
+		{
+			for (size_t row = 0; row < matrix.Rows; row++)
+			{
+				for (size_t col = 0; col < matrix.Cols; col++)
+					os << matrix(row, col) << "\t";
+				os << "\n";
+			}
+			return os;
+		}
+	};
+
+	template <typename T>
+	matx<T>::matx(size_t rows, size_t cols, T diagonal) : Rows(rows), Cols(cols), Elements(rows * cols, T(0))
+	{
+		for (size_t i = 0; i < rows && i < cols; i++)
+			Elements[i * rows + i] = diagonal;
+	}
+
+	template <typename T>
+	T& matx<T>::operator () (size_t row, size_t col)
+	{
+		return Elements[col * Rows + row];
+	}
+
+	template <typename T>
+	const T& matx<T>::operator () (size_t row, size_t col) const
+	{
+		return Elements[col * Rows + row];
+	}
+
+	template <typename T>
+	matx<T> matx<T>::Identity(size_t size)
+	{
+		return matx<T>(size, size, T(1));
+	}
+
+	template <typename T>
+	matx<T> matx<T>::Transpose(const matx<T>& matrix)
+	{
+		matx<T> result(matrix.Cols, matrix.Rows);
+
+		// Tiled so both the reads and the writes stay within a few cache lines
+		constexpr size_t Tile = 32;
+		for (size_t colBlock = 0; colBlock < matrix.Cols; colBlock += Tile)
+			for (size_t rowBlock = 0; rowBlock < matrix.Rows; rowBlock += Tile)
+				for (size_t col = colBlock; col < std::min(colBlock + Tile, matrix.Cols); col++)
+					for (size_t row = rowBlock; row < std::min(rowBlock + Tile, matrix.Rows); row++)
+						result(col, row) = matrix(row, col);
+
+		return result;
+	}
+
+	template <typename T>
+	matx<T> matx<T>::Multiply(const matx<T>& lhs, const matx<T>& rhs)
+	{
+		// Cache-blocked GEMM. Threads own disjoint column blocks of the result, and the
+		// innermost loop runs down a contiguous column so it vectorises.
+		constexpr size_t RowBlock = 256;
+		constexpr size_t DepthBlock = 128;
+		constexpr size_t ColBlock = 16;
+
+		assert(lhs.Cols == rhs.Rows);
+
+		size_t rows = lhs.Rows;
+		size_t depth = lhs.Cols;
+		size_t cols = rhs.Cols;
+		matx<T> result(rows, cols);
+
+		MATHS_PROFILE_KERNEL("matx::Multiply", rows * cols, (rows * depth + depth * cols + rows * cols) * sizeof(T));
+
+		const T* a = lhs.Elements.data();
+		const T* b = rhs.Elements.data();
+		T* c = result.Elements.data();
+
+		size_t colBlocks = (cols + ColBlock - 1) / ColBlock;
+		size_t work = rows * depth * ColBlock;
+		size_t minBlocks = std::max<size_t>(1, ParallelThreshold / std::max<size_t>(work, 1));
+
+		Utils::ParallelFor(colBlocks, minBlocks, [=](size_t firstBlock, size_t lastBlock)
+		{
+			for (size_t block = firstBlock; block < lastBlock; block++)
+			{
+				size_t colBegin = block * ColBlock;
+				size_t colEnd = std::min(colBegin + ColBlock, cols);
+
+				for (size_t k0 = 0; k0 < depth; k0 += DepthBlock)
+				{
+					size_t kEnd = std::min(k0 + DepthBlock, depth);
+					for (size_t i0 = 0; i0 < rows; i0 += RowBlock)
+					{
+						size_t iEnd = std::min(i0 + RowBlock, rows);
+						for (size_t j = colBegin; j < colEnd; j++)
+						{
+							T* out = c + j * rows;
+							for (size_t k = k0; k < kEnd; k++)
+							{
+								T scale = b[j * depth + k];
+								const T* column = a + k * rows;
+								for (size_t i = i0; i < iEnd; i++)
+									out[i] += column[i] * scale;
+							}
+						}
+					}
+				}
+			}
+		});
+
+		return result;
+	}
+
+	template <typename T>
+	void matx<T>::Multiply(const matx<T>& matrix, const vecx<T>& vector, vecx<T>& out)
+	{
+		assert(vector.Size() == matrix.Cols);
+
+		// out is zeroed before vector is read, so an aliased product goes through a temporary
+		if (&out == &vector)
+		{
+			vecx<T> result;
+			Multiply(matrix, vector, result);
+			out.Elements.swap(result.Elements);
+			return;
+		}
+
+		MATHS_PROFILE_KERNEL("matx::MultiplyVector", matrix.Rows, (matrix.Rows * matrix.Cols + matrix.Cols + matrix.Rows) * sizeof(T));
+
+		out.Elements.assign(matrix.Rows, T(0));
+
+		// Split by rows so threads write disjoint parts of the output
+		const T* a = matrix.Elements.data();
+		const T* x = vector.Elements.data();
+		T* y = out.Elements.data();
+		size_t rows = matrix.Rows;
+		size_t cols = matrix.Cols;
+
+		Utils::ParallelFor(rows, std::max<size_t>(64, ParallelThreshold / std::max<size_t>(cols, 1)), [=](size_t begin, size_t end)
+		{
+			for (size_t col = 0; col < cols; col++)
+			{
+				const T* column = a + col * rows;
+				T scale = x[col];
+				for (size_t row = begin; row < end; row++)
+					y[row] += column[row] * scale;
+			}
+		});
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "vecx.h"
+#include "matx.h"
+#include "sparse.h"
+#include "../Utils/instrumentation.h"
+
+#include <cmath>
+#include <cstddef>
+
+namespace Maths::LinearAlgebra {
+
+	template <typename T>
+	struct solver_result
+	{
+		size_t Iterations = 0;
+		T Residual = T(0);		// Final ||b - Ax|| / ||b||
+		bool Converged = false;
+	};
+
+	namespace Detail {
+
+		template <typename T>
+		void Apply(const csrmat<T>& matrix, const vecx<T>& vector, vecx<T>& out)
+		{
+			matrix.Multiply(vector, out);
+		}
+
+		template <typename T>
+		void Apply(const matx<T>& matrix, const vecx<T>& vector, vecx<T>& out)
+		{
+			matx<T>::Multiply(matrix, vector, out);
+		}
+
+		template <typename T>
+		vecx<T> Diagonal(const csrmat<T>& matrix)
+		{
+			return matrix.Diagonal();
+		}
+
+		template <typename T>
+		vecx<T> Diagonal(const matx<T>& matrix)
+		{
+			vecx<T> result(matrix.Rows);
+			for (size_t i = 0; i < matrix.Rows && i < matrix.Cols; i++)
+				result[i] = matrix(i, i);
+			return result;
+		}
+
+	}
+
+	// Jacobi-preconditioned conjugate gradient for symmetric positive definite systems.
+	// x holds the initial guess on entry (resized and zeroed if it has the wrong size)
+	// and the solution on exit. Works with csrmat and matx.
+	template <typename M, typename T>
+	solver_result<T> ConjugateGradient(const M& matrix, const vecx<T>& b, vecx<T>& x, size_t maxIterations, T tolerance)
+	{
+		MATHS_PROFILE_KERNEL("ConjugateGradient", b.Size(), 0);
+
+		size_t n = b.Size();
+		if (x.Size() != n)
+			x.Elements.assign(n, T(0));
+
+		// Inverse diagonal, leaving rows with a zero diagonal unpreconditioned
+		vecx<T> invDiagonal = Detail::Diagonal(matrix);
+		for (size_t i = 0; i < n; i++)
+			invDiagonal[i] = invDiagonal[i] != T(0) ? T(1) / invDiagonal[i] : T(1);
+
+		vecx<T> r;
+		Detail::Apply(matrix, x, r);
+		for (size_t i = 0; i < n; i++)
+			r[i] = b[i] - r[i];
+
+		vecx<T> z(n);
+		for (size_t i = 0; i < n; i++)
+			z[i] = r[i] * invDiagonal[i];
+
+		vecx<T> p = z;
+		vecx<T> ap(n);
+
+		solver_result<T> result;
+		T bNorm = b.Magnitude();
+		if (bNorm == T(0))
+			bNorm = T(1);
+
+		T rz = vecx<T>::Dot(r, z);
+		result.Residual = r.Magnitude() / bNorm;
+
+		while (result.Residual > tolerance && result.Iterations < maxIterations)
+		{
+			Detail::Apply(matrix, p, ap);
+			T pap = vecx<T>::Dot(p, ap);
+			if (pap <= T(0))
+				break;		// Not positive definite along p
+
+			T alpha = rz / pap;
+			x.AddScaled(p, alpha);
+			r.AddScaled(ap, -alpha);
+
+			for (size_t i = 0; i < n; i++)
+				z[i] = r[i] * invDiagonal[i];
+
+			T rzNext = vecx<T>::Dot(r, z);
+			T beta = rzNext / rz;
+			rz = rzNext;
+
+			// p = z + beta * p
+			p.Multiply(beta);
+			p.Add(z);
+
+			result.Iterations++;
+			result.Residual = r.Magnitude() / bNorm;
+		}
+
+		result.Converged = result.Residual <= tolerance;
+		return result;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "vecx.h"
+#include "../Containers/mat3.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Maths::LinearAlgebra {
+
+	template <typename T>
+	struct triplet
+	{
+		uint32_t Row;
+		uint32_t Col;
+		T Value;
+	};
+
+	// Compressed sparse row matrix. Build it once from triplets, then reuse the
+	// structure for every matrix-vector product of the solve.
+	template <typename T>
+	struct csrmat
+	{
+		size_t Rows = 0;
+		size_t Cols = 0;
+		std::vector<size_t> RowOffsets;
+		std::vector<uint32_t> ColIndices;
+		std::vector<T> Values;
+
+		csrmat() = default;
+
+		size_t NonZeros() const;
+
+		// Duplicate entries are summed, which is how assembled stiffness matrices arrive
+		static csrmat<T> FromTriplets(size_t rows, size_t cols, std::vector<triplet<T>> triplets);
+
+		// Appends a 3x3 block for the coupling between points i and j of a 3N system
+		static void AddBlock(std::vector<triplet<T>>& triplets, uint32_t i, uint32_t j, const mat3<T>& block);
+
+		void Multiply(const vecx<T>& vector, vecx<T>& out) const;
+		vecx<T> Diagonal() const;
+
+		friend vecx<T> operator * (const csrmat<T>& lhs, const vecx<T>& rhs)
+		{
+			vecx<T> result;
+			lhs.Multiply(rhs, result);
+			return result;
+		}
+	};
+
+	template <typename T>
+	size_t csrmat<T>::NonZeros() const
+	{
+		return Values.size();
+	}
+
+	template <typename T>
+	csrmat<T> csrmat<T>::FromTriplets(size_t rows, size_t cols, std::vector<triplet<T>> triplets)
+	{
+		std::sort(triplets.begin(), triplets.end(), [](const triplet<T>& lhs, const triplet<T>& rhs)
+		{
+			return lhs.Row != rhs.Row ? lhs.Row < rhs.Row : lhs.Col < rhs.Col;
+		});
+
+		csrmat<T> result;
+		result.Rows = rows;
+		result.Cols = cols;
+		result.RowOffsets.assign(rows + 1, 0);
+		result.ColIndices.reserve(triplets.size());
+		result.Values.reserve(triplets.size());
+
+		for (size_t i = 0; i < triplets.size(); i++)
+		{
+			const triplet<T>& entry = triplets[i];
+			assert(entry.Row < rows && entry.Col < cols);
+
+			bool duplicate = i > 0 && triplets[i - 1].Row == entry.Row && triplets[i - 1].Col == entry.Col;
+			if (duplicate)
+			{
+				result.Values.back() += entry.Value;
+				continue;
+			}
+
+			result.ColIndices.push_back(entry.Col);
+			result.Values.push_back(entry.Value);
+			result.RowOffsets[entry.Row + 1]++;
+		}
+
+		for (size_t row = 0; row < rows; row++)
+			result.RowOffsets[row + 1] += result.RowOffsets[row];
+
+		return result;
+	}
+
+	template <typename T>
+	void csrmat<T>::AddBlock(std::vector<triplet<T>>& triplets, uint32_t i, uint32_t j, const mat3<T>& block)
+	{
+		for (uint32_t col = 0; col < 3; col++)
+			for (uint32_t row = 0; row < 3; row++)
+			{
+				T value = block.Elements[col * 3 + row];
+				if (value != T(0))
+					triplets.push_back({ i * 3 + row, j * 3 + col, value });
+			}
+	}
+
+	template <typename T>
+	void csrmat<T>::Multiply(const vecx<T>& vector, vecx<T>& out) const
+	{
+		assert(vector.Size() == Cols);
+
+		// Rows are written while other rows still read vector, so an aliased product goes
+		// through a temporary
+		if (&out == &vector)
+		{
+			vecx<T> result;
+			Multiply(vector, result);
+			out.Elements.swap(result.Elements);
+			return;
+		}
+
+		MATHS_PROFILE_KERNEL("csrmat::Multiply", Rows, NonZeros() * (sizeof(T) + sizeof(uint32_t)) + (Rows + 1) * sizeof(size_t));
+
+		out.Resize(Rows);
+
+		const size_t* offsets = RowOffsets.data();
+		const uint32_t* indices = ColIndices.data();
+		const T* values = Values.data();
+		const T* x = vector.Elements.data();
+		T* y = out.Elements.data();
+
+		// Rows are independent so each thread owns a contiguous range of the output
+		size_t perRow = Rows > 0 ? std::max<size_t>(1, NonZeros() / Rows) : 1;
+		Utils::ParallelFor(Rows, std::max<size_t>(256, ParallelThreshold / perRow), [=](size_t begin, size_t end)
+		{
+			for (size_t row = begin; row < end; row++)
+			{
+				T sum = T(0);
+				for (size_t k = offsets[row]; k < offsets[row + 1]; k++)
+					sum += values[k] * x[indices[k]];
+				y[row] = sum;
+			}
+		});
+	}
+
+	template <typename T>
+	vecx<T> csrmat<T>::Diagonal() const
+	{
+		vecx<T> result(Rows);
+		for (size_t row = 0; row < Rows; row++)
+			for (size_t k = RowOffsets[row]; k < RowOffsets[row + 1]; k++)
+				if (ColIndices[k] == row)
+					result[row] = Values[k];
+		return result;
+	}
+
+}
\ No newline at end of file
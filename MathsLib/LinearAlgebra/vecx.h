@@ -0,0 +1,243 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+#include "../Utils/scalar.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+namespace Maths::LinearAlgebra {
+
+	using namespace Maths::Containers;
+
+	// Dynamically sized vector. Element-wise operations and reductions are split across
+	// threads once the vector is large enough to make that worthwhile.
+	template <typename T>
+	struct vecx
+	{
+		std::vector<T> Elements;
+
+		vecx() = default;
+		vecx(size_t size, T value = T(0));
+
+		size_t Size() const;
+		void Resize(size_t size, T value = T(0));
+
+		T& operator [] (size_t index);
+		const T& operator [] (size_t index) const;
+
+		vecx<T>& Add(const vecx<T>& other);
+		vecx<T>& Subtract(const vecx<T>& other);
+		vecx<T>& Multiply(T scalar);
+
+		vecx<T>& operator += (const vecx<T>& rhs);
+		vecx<T>& operator -= (const vecx<T>& rhs);
+		vecx<T>& operator *= (T scalar);
+
+		// this += scalar * other, the core update of the iterative solvers
+		vecx<T>& AddScaled(const vecx<T>& other, T scalar);
+
+		static T Dot(const vecx<T>& lhs, const vecx<T>& rhs);
+
+		T Magnitude() const;
+
+		// An array of N vec3 is viewed as a 3N vector laid out X0 Y0 Z0 X1 ...
+		static vecx<T> FromVec3(const vec3<T>* vectors, size_t count);
+		void ToVec3(vec3<T>* vectors) const;
+
+		friend vecx<T> operator + (vecx<T> lhs, const vecx<T>& rhs)
+		{
+			return lhs.Add(rhs);
+		}
+
+		friend vecx<T> operator - (vecx<T> lhs, const vecx<T>& rhs)
+		{
+			return lhs.Subtract(rhs);
+		}
+
+		friend vecx<T> operator * (vecx<T> lhs, T scalar)
+		{
+			return lhs.Multiply(scalar);
+		}
+
+		friend std::ostream& operator << (std::ostream& os, const vecx<T>& vector)
+		{
+			for (const T& element : vector.Elements)
+				os << element << "\t";
+			return os;
+		}
+	};
+
+	// Element count below which vector operations stay on the calling thread
+	constexpr size_t ParallelThreshold = 1 << 15;
+
+	template <typename T>
+	vecx<T>::vecx(size_t size, T value) : Elements(size, value)
+	{
+
+	}
+
+	template <typename T>
+	size_t vecx<T>::Size() const
+	{
+		return Elements.size();
+	}
+
+	template <typename T>
+	void vecx<T>::Resize(size_t size, T value)
+	{
+		Elements.resize(size, value);
+	}
+
+	template <typename T>
+	T& vecx<T>::operator [] (size_t index)
+	{
+		return Elements[index];
+	}
+
+	template <typename T>
+	const T& vecx<T>::operator [] (size_t index) const
+	{
+		return Elements[index];
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::Add(const vecx<T>& other)
+	{
+		assert(other.Size() == Size());
+
+		T* lhs = Elements.data();
+		const T* rhs = other.Elements.data();
+		Utils::ParallelFor(Size(), ParallelThreshold, [=](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				lhs[i] += rhs[i];
+		});
+
+		return *this;
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::Subtract(const vecx<T>& other)
+	{
+		assert(other.Size() == Size());
+
+		T* lhs = Elements.data();
+		const T* rhs = other.Elements.data();
+		Utils::ParallelFor(Size(), ParallelThreshold, [=](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				lhs[i] -= rhs[i];
+		});
+
+		return *this;
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::Multiply(T scalar)
+	{
+		T* lhs = Elements.data();
+		Utils::ParallelFor(Size(), ParallelThreshold, [=](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				lhs[i] *= scalar;
+		});
+
+		return *this;
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::operator += (const vecx<T>& rhs)
+	{
+		return Add(rhs);
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::operator -= (const vecx<T>& rhs)
+	{
+		return Subtract(rhs);
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::operator *= (T scalar)
+	{
+		return Multiply(scalar);
+	}
+
+	template <typename T>
+	vecx<T>& vecx<T>::AddScaled(const vecx<T>& other, T scalar)
+	{
+		assert(other.Size() == Size());
+
+		T* lhs = Elements.data();
+		const T* rhs = other.Elements.data();
+		Utils::ParallelFor(Size(), ParallelThreshold, [=](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				lhs[i] += rhs[i] * scalar;
+		});
+
+		return *this;
+	}
+
+	template <typename T>
+	T vecx<T>::Dot(const vecx<T>& lhs, const vecx<T>& rhs)
+	{
+		assert(lhs.Size() == rhs.Size());
+
+		MATHS_PROFILE_KERNEL("vecx::Dot", lhs.Size(), 2 * lhs.Size() * sizeof(T));
+
+		const T* a = lhs.Elements.data();
+		const T* b = rhs.Elements.data();
+
+		return Utils::ParallelReduce(lhs.Size(), ParallelThreshold, T(0),
+			[=](size_t begin, size_t end)
+			{
+				// Four independent accumulators break the add dependency chain
+				T sum[4] = { T(0), T(0), T(0), T(0) };
+				size_t i = begin;
+				for (; i + 4 <= end; i += 4)
+				{
+					sum[0] += a[i] * b[i];
+					sum[1] += a[i + 1] * b[i + 1];
+					sum[2] += a[i + 2] * b[i + 2];
+					sum[3] += a[i + 3] * b[i + 3];
+				}
+				for (; i < end; i++)
+					sum[0] += a[i] * b[i];
+				return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+			},
+			[](T x, T y) { return x + y; });
+	}
+
+	template <typename T>
+	T vecx<T>::Magnitude() const
+	{
+		return Utils::Sqrt(Dot(*this, *this));
+	}
+
+	template <typename T>
+	vecx<T> vecx<T>::FromVec3(const vec3<T>* vectors, size_t count)
+	{
+		static_assert(sizeof(vec3<T>) == 3 * sizeof(T), "vec3 must be tightly packed");
+
+		vecx<T> result(count * 3);
+		if (count > 0)
+			memcpy(result.Elements.data(), vectors, count * sizeof(vec3<T>));
+		return result;
+	}
+
+	template <typename T>
+	void vecx<T>::ToVec3(vec3<T>* vectors) const
+	{
+		if (!Elements.empty())
+			memcpy(vectors, Elements.data(), (Size() / 3) * sizeof(vec3<T>));
+	}
+
+}
\ No newline at end of file
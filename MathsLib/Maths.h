@@ -1,7 +1,40 @@
 #pragma once
 
-#include "Containers\vec2.h"
-#include "Containers\vec3.h"
-#include "Containers\vec4.h"
-#include "Containers\mat3.h"
-#include "Containers\mat4.h"
\ No newline at end of file
+#include "Containers/vec.h"
+#include "Containers/vec2.h"
+#include "Containers/vec3.h"
+#include "Containers/vec4.h"
+#include "Containers/mat.h"
+#include "Containers/mat3.h"
+#include "Containers/mat4.h"
+#include "Containers/affine.h"
+#include "Containers/structured.h"
+#include "Containers/quat.h"
+#include "Containers/dualquat.h"
+#include "Containers/fixed.h"
+#include "Containers/interval.h"
+
+#include "Transforms/cached.h"
+#include "Transforms/decompose.h"
+
+#include "Geometry/aabb.h"
+#include "Geometry/ray.h"
+#include "Geometry/clustering.h"
+#include "Geometry/predicates.h"
+#include "Geometry/mesh.h"
+#include "Geometry/reductions.h"
+
+#include "Spatial/grid.h"
+#include "Spatial/morton.h"
+
+#include "Animation/track.h"
+#include "Animation/skinning.h"
+
+#include "LinearAlgebra/vecx.h"
+#include "LinearAlgebra/matx.h"
+#include "LinearAlgebra/sparse.h"
+#include "LinearAlgebra/solvers.h"
+#include "LinearAlgebra/decompositions.h"
+
+#include "Utils/accuracy.h"
+#include "Utils/async.h"
\ No newline at end of file
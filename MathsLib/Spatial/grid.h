@@ -0,0 +1,472 @@
+#pragma once
+
+#include "morton.h"
+#include "../Containers/vec3.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace Maths::Spatial {
+
+	using namespace Maths::Containers;
+
+	// Hashed uniform grid over an array of points for radius and k-nearest queries.
+	// Points are radix-sorted by the Morton or Hilbert key of their cell, so each cell's
+	// points are contiguous and neighbouring cells are mostly close in memory, and a copy
+	// of the positions is kept in that order so queries read memory linearly. A hash
+	// table maps each occupied cell to its range.
+	//
+	// Update() handles the common case where most points stay in their cell: positions
+	// are refreshed in place and points that changed cell move to a small overflow list
+	// that queries scan linearly. The grid is rebuilt once that list grows past
+	// RebuildFraction of the points.
+	template <typename T>
+	class spatial_grid
+	{
+	public:
+		static constexpr uint32_t Invalid = std::numeric_limits<uint32_t>::max();
+
+		T RebuildFraction = T(1) / T(32);
+
+		// Curve ordering the cells in memory on the next Build. Hilbert keeps more of a
+		// query's cells together but its keys cost more to compute.
+		space_curve CellOrder = space_curve::Morton;
+
+		spatial_grid(T cellSize);
+
+		void Build(const vec3<T>* points, size_t count);
+		void Update(const vec3<T>* points);
+
+		// Calls func(index, distanceSquared) for every point within radius of centre
+		template <typename F>
+		void ForEachInRadius(const vec3<T>& centre, T radius, F&& func) const;
+
+		void QueryRadius(const vec3<T>& centre, T radius, std::vector<uint32_t>& out) const;
+		void QueryKNearest(const vec3<T>& centre, uint32_t k, std::vector<uint32_t>& out) const;
+
+		size_t Size() const;
+		size_t MovedCount() const;
+
+	private:
+		struct cell_coord
+		{
+			int32_t X, Y, Z;
+		};
+
+		// Slots [Start, End) of the sorted arrays hold the points of Cell
+		struct cell_range
+		{
+			cell_coord Cell;
+			uint32_t Start = Invalid;
+			uint32_t End = Invalid;
+		};
+
+		cell_coord Cell(const vec3<T>& point) const;
+		size_t Hash(const cell_coord& cell) const;
+
+		template <typename F>
+		void ForEachInCell(const cell_coord& cell, F&& func) const;
+
+		T m_CellSize;
+		T m_InvCellSize;
+		size_t m_TableMask = 0;
+		size_t m_CellCount = 0;
+
+		std::vector<cell_range> m_Table;		// Open addressing, at most half full
+		std::vector<uint32_t> m_SortedIndices;	// Original point index, or Invalid once moved out
+		std::vector<vec3<T>> m_SortedPoints;
+		std::vector<cell_coord> m_SortedCells;	// Cell of each slot when it was sorted
+		std::vector<uint32_t> m_SortedSlot;		// Original index -> position in the sorted arrays
+		std::vector<uint32_t> m_Moved;			// Points that left their cell since the last build
+		std::vector<vec3<T>> m_Points;			// Latest positions, by original index
+
+		cell_coord m_MinCell = { 0, 0, 0 };
+		cell_coord m_MaxCell = { 0, 0, 0 };
+	};
+
+	template <typename T>
+	spatial_grid<T>::spatial_grid(T cellSize) : m_CellSize(cellSize), m_InvCellSize(T(1) / cellSize)
+	{
+
+	}
+
+	template <typename T>
+	typename spatial_grid<T>::cell_coord spatial_grid<T>::Cell(const vec3<T>& point) const
+	{
+		using std::floor;
+		return cell_coord{
+			int32_t(floor(point.X * m_InvCellSize)),
+			int32_t(floor(point.Y * m_InvCellSize)),
+			int32_t(floor(point.Z * m_InvCellSize)) };
+	}
+
+	template <typename T>
+	size_t spatial_grid<T>::Hash(const cell_coord& cell) const
+	{
+		uint32_t h = (uint32_t(cell.X) * 73856093u) ^ (uint32_t(cell.Y) * 19349663u) ^ (uint32_t(cell.Z) * 83492791u);
+		return size_t(h) & m_TableMask;
+	}
+
+	template <typename T>
+	void spatial_grid<T>::Build(const vec3<T>* points, size_t count)
+	{
+		MATHS_PROFILE_KERNEL("spatial_grid::Build", count, count * (2 * sizeof(vec3<T>) + sizeof(uint64_t) + 3 * sizeof(uint32_t)));
+
+		// Slots and indices are 32 bit, with the largest value reserved for Invalid
+		assert(count < Invalid);
+
+		m_Points.assign(points, points + count);
+		m_SortedIndices.resize(count);
+		m_SortedPoints.resize(count);
+		m_SortedCells.resize(count);
+		m_SortedSlot.resize(count);
+		m_Moved.clear();
+		m_Table.clear();
+		m_CellCount = 0;
+		if (count == 0)
+			return;
+
+		std::vector<cell_coord> cells(count);
+		Utils::ParallelFor(count, 1 << 14, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				cells[i] = Cell(points[i]);
+		});
+
+		using bounds = std::pair<cell_coord, cell_coord>;
+		const int32_t Lowest = std::numeric_limits<int32_t>::min(), Highest = std::numeric_limits<int32_t>::max();
+		bounds range = Utils::ParallelReduce(count, 1 << 14, bounds({ Highest, Highest, Highest }, { Lowest, Lowest, Lowest }),
+			[&](size_t begin, size_t end)
+			{
+				bounds local({ Highest, Highest, Highest }, { Lowest, Lowest, Lowest });
+				for (size_t i = begin; i < end; i++)
+				{
+					local.first = { std::min(local.first.X, cells[i].X), std::min(local.first.Y, cells[i].Y), std::min(local.first.Z, cells[i].Z) };
+					local.second = { std::max(local.second.X, cells[i].X), std::max(local.second.Y, cells[i].Y), std::max(local.second.Z, cells[i].Z) };
+				}
+				return local;
+			},
+			[](const bounds& a, const bounds& b)
+			{
+				return bounds({ std::min(a.first.X, b.first.X), std::min(a.first.Y, b.first.Y), std::min(a.first.Z, b.first.Z) },
+					{ std::max(a.second.X, b.second.X), std::max(a.second.Y, b.second.Y), std::max(a.second.Z, b.second.Z) });
+			});
+		m_MinCell = range.first;
+		m_MaxCell = range.second;
+
+		// Keys from the cell offsets to the minimum cell. The curves take 21 bits per axis;
+		// past that, distinct cells can share a key and are separated below.
+		cell_coord min = m_MinCell;
+		space_curve curve = CellOrder;
+		std::vector<uint64_t> keys(count);
+		Utils::ParallelFor(count, 1 << 14, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				uint64_t x = uint32_t(cells[i].X) - uint32_t(min.X), y = uint32_t(cells[i].Y) - uint32_t(min.Y), z = uint32_t(cells[i].Z) - uint32_t(min.Z);
+				keys[i] = curve == space_curve::Hilbert ? Hilbert63(x, y, z) : Morton63(x, y, z);
+			}
+		});
+
+		// Stable, so each cell's points stay in index order and the layout does not
+		// depend on thread timing
+		SortByKey(keys.data(), count, m_SortedIndices.data());
+
+		auto cellLess = [&](uint32_t a, uint32_t b)
+		{
+			const cell_coord& ca = cells[a];
+			const cell_coord& cb = cells[b];
+			return ca.X != cb.X ? ca.X < cb.X : ca.Y != cb.Y ? ca.Y < cb.Y : ca.Z < cb.Z;
+		};
+		const int64_t KeyRange = 0x1FFFFF;
+		if (int64_t(m_MaxCell.X) - m_MinCell.X > KeyRange || int64_t(m_MaxCell.Y) - m_MinCell.Y > KeyRange || int64_t(m_MaxCell.Z) - m_MinCell.Z > KeyRange)
+		{
+			for (size_t first = 0; first < count;)
+			{
+				size_t last = first + 1;
+				while (last < count && keys[last] == keys[first])
+					last++;
+				std::stable_sort(m_SortedIndices.begin() + first, m_SortedIndices.begin() + last, cellLess);
+				first = last;
+			}
+		}
+
+		Utils::ParallelFor(count, 1 << 14, [&](size_t begin, size_t end)
+		{
+			for (size_t slot = begin; slot < end; slot++)
+			{
+				uint32_t index = m_SortedIndices[slot];
+				m_SortedPoints[slot] = points[index];
+				m_SortedCells[slot] = cells[index];
+				m_SortedSlot[index] = uint32_t(slot);
+			}
+		});
+
+		// One table entry per run of equal cells, in a table at least twice their number
+		std::vector<cell_range> runs;
+		for (size_t slot = 0; slot < count; slot++)
+		{
+			const cell_coord& cell = m_SortedCells[slot];
+			if (runs.empty() || cell.X != runs.back().Cell.X || cell.Y != runs.back().Cell.Y || cell.Z != runs.back().Cell.Z)
+			{
+				if (!runs.empty())
+					runs.back().End = uint32_t(slot);
+				runs.push_back({ cell, uint32_t(slot), Invalid });
+			}
+		}
+		runs.back().End = uint32_t(count);
+
+		size_t tableSize = 16;
+		while (tableSize < 2 * runs.size())
+			tableSize <<= 1;
+		m_TableMask = tableSize - 1;
+		m_CellCount = runs.size();
+		m_Table.assign(tableSize, cell_range{});
+
+		for (const cell_range& run : runs)
+		{
+			size_t slot = Hash(run.Cell);
+			while (m_Table[slot].Start != Invalid)
+				slot = (slot + 1) & m_TableMask;
+			m_Table[slot] = run;
+		}
+	}
+
+	template <typename T>
+	void spatial_grid<T>::Update(const vec3<T>* points)
+	{
+		size_t count = m_Points.size();
+		MATHS_PROFILE_KERNEL("spatial_grid::Update", count, count * 2 * sizeof(vec3<T>));
+
+		std::vector<std::vector<uint32_t>> movedPerChunk(Utils::ThreadCount());
+		std::atomic<size_t> chunkCounter{ 0 };
+
+		Utils::ParallelFor(count, 1 << 14, [&](size_t begin, size_t end)
+		{
+			std::vector<uint32_t>& local = movedPerChunk[chunkCounter.fetch_add(1)];
+			for (size_t i = begin; i < end; i++)
+			{
+				m_Points[i] = points[i];
+				uint32_t slot = m_SortedSlot[i];
+				if (slot == Invalid)
+					continue;
+
+				cell_coord cell = Cell(points[i]);
+				const cell_coord& sorted = m_SortedCells[slot];
+				if (cell.X == sorted.X && cell.Y == sorted.Y && cell.Z == sorted.Z)
+					m_SortedPoints[slot] = points[i];
+				else
+					local.push_back(uint32_t(i));
+			}
+		});
+
+		for (const std::vector<uint32_t>& local : movedPerChunk)
+			for (uint32_t index : local)
+			{
+				m_SortedIndices[m_SortedSlot[index]] = Invalid;
+				m_SortedSlot[index] = Invalid;
+				m_Moved.push_back(index);
+			}
+
+		if (T(m_Moved.size()) > T(count) * RebuildFraction)
+			Build(points, count);
+	}
+
+	template <typename T>
+	template <typename F>
+	void spatial_grid<T>::ForEachInCell(const cell_coord& cell, F&& func) const
+	{
+		// Linear probing up to the cell or an empty entry
+		for (size_t entry = Hash(cell);; entry = (entry + 1) & m_TableMask)
+		{
+			const cell_range& range = m_Table[entry];
+			if (range.Start == Invalid)
+				return;
+			if (range.Cell.X != cell.X || range.Cell.Y != cell.Y || range.Cell.Z != cell.Z)
+				continue;
+
+			for (uint32_t slot = range.Start; slot < range.End; slot++)
+			{
+				uint32_t index = m_SortedIndices[slot];
+				if (index != Invalid)
+					func(index, m_SortedPoints[slot]);
+			}
+			return;
+		}
+	}
+
+	template <typename T>
+	template <typename F>
+	void spatial_grid<T>::ForEachInRadius(const vec3<T>& centre, T radius, F&& func) const
+	{
+		if (m_Table.empty())
+			return;
+
+		T radiusSquared = radius * radius;
+		auto visit = [&](uint32_t index, const vec3<T>& point)
+		{
+			T dx = point.X - centre.X;
+			T dy = point.Y - centre.Y;
+			T dz = point.Z - centre.Z;
+			T distanceSquared = dx * dx + dy * dy + dz * dz;
+			if (distanceSquared <= radiusSquared)
+				func(index, distanceSquared);
+		};
+
+		cell_coord low = Cell(centre - radius);
+		cell_coord high = Cell(centre + radius);
+		low = { std::max(low.X, m_MinCell.X), std::max(low.Y, m_MinCell.Y), std::max(low.Z, m_MinCell.Z) };
+		high = { std::min(high.X, m_MaxCell.X), std::min(high.Y, m_MaxCell.Y), std::min(high.Z, m_MaxCell.Z) };
+
+		// A query covering more cells than are occupied is cheaper as a linear scan
+		int64_t cells = int64_t(high.X - low.X + 1) * (high.Y - low.Y + 1) * (high.Z - low.Z + 1);
+		if (cells > int64_t(m_CellCount))
+		{
+			for (uint32_t slot = 0; slot < m_SortedIndices.size(); slot++)
+				if (m_SortedIndices[slot] != Invalid)
+					visit(m_SortedIndices[slot], m_SortedPoints[slot]);
+		}
+		else
+		{
+			for (int32_t z = low.Z; z <= high.Z; z++)
+				for (int32_t y = low.Y; y <= high.Y; y++)
+					for (int32_t x = low.X; x <= high.X; x++)
+						ForEachInCell(cell_coord{ x, y, z }, visit);
+		}
+
+		for (uint32_t index : m_Moved)
+			visit(index, m_Points[index]);
+	}
+
+	template <typename T>
+	void spatial_grid<T>::QueryRadius(const vec3<T>& centre, T radius, std::vector<uint32_t>& out) const
+	{
+		out.clear();
+		ForEachInRadius(centre, radius, [&](uint32_t index, T) { out.push_back(index); });
+	}
+
+	template <typename T>
+	void spatial_grid<T>::QueryKNearest(const vec3<T>& centre, uint32_t k, std::vector<uint32_t>& out) const
+	{
+		out.clear();
+		if (k == 0 || m_Points.empty())
+			return;
+
+		// Max-heap of the best k so far, keyed on squared distance
+		using entry = std::pair<T, uint32_t>;
+		std::priority_queue<entry> best;
+		auto offer = [&](uint32_t index, const vec3<T>& point)
+		{
+			vec3<T> d = point - centre;
+			T distanceSquared = vec3<T>::Dot(d, d);
+			if (best.size() < k)
+				best.push({ distanceSquared, index });
+			else if (distanceSquared < best.top().first)
+			{
+				best.pop();
+				best.push({ distanceSquared, index });
+			}
+		};
+
+		for (uint32_t index : m_Moved)
+			offer(index, m_Points[index]);
+
+		// Grow cube shells around the centre cell, clamped to the occupied bounds, until the
+		// shell is further away than the current k-th neighbour or covers every occupied
+		// cell. Shells start at the first one that reaches the bounds, so a query from far
+		// outside the grid does not walk the empty cells in between.
+		cell_coord c = Cell(centre);
+		auto outside = [](int32_t value, int32_t low, int32_t high) { return std::max({ low - value, value - high, 0 }); };
+		int32_t firstRing = std::max({ outside(c.X, m_MinCell.X, m_MaxCell.X), outside(c.Y, m_MinCell.Y, m_MaxCell.Y), outside(c.Z, m_MinCell.Z, m_MaxCell.Z) });
+		int32_t lastRing = std::max({ std::abs(c.X - m_MinCell.X), std::abs(c.X - m_MaxCell.X),
+			std::abs(c.Y - m_MinCell.Y), std::abs(c.Y - m_MaxCell.Y),
+			std::abs(c.Z - m_MinCell.Z), std::abs(c.Z - m_MaxCell.Z) });
+
+		// Cells of the cube of the given radius around c that lie within the bounds
+		auto clampedCells = [&](int32_t ring)
+		{
+			if (ring < firstRing)
+				return int64_t(0);
+			auto extent = [&](int32_t centreCell, int32_t low, int32_t high)
+			{
+				return int64_t(std::min(centreCell + ring, high)) - std::max(centreCell - ring, low) + 1;
+			};
+			return extent(c.X, m_MinCell.X, m_MaxCell.X) * extent(c.Y, m_MinCell.Y, m_MaxCell.Y) * extent(c.Z, m_MinCell.Z, m_MaxCell.Z);
+		};
+
+		int64_t visited = 0;
+		for (int32_t ring = firstRing; ring <= lastRing; ring++)
+		{
+			if (best.size() == k)
+			{
+				T reach = T(ring - 1) * m_CellSize;
+				if (ring > 0 && reach * reach > best.top().first)
+					break;
+			}
+
+			// Once the shells would probe more cells than are occupied, scan the points instead
+			visited += clampedCells(ring) - clampedCells(ring - 1);
+			if (visited > int64_t(m_CellCount))
+			{
+				best = std::priority_queue<entry>();
+				for (uint32_t index : m_Moved)
+					offer(index, m_Points[index]);
+				for (uint32_t slot = 0; slot < m_SortedIndices.size(); slot++)
+					if (m_SortedIndices[slot] != Invalid)
+						offer(m_SortedIndices[slot], m_SortedPoints[slot]);
+				break;
+			}
+
+			int32_t zLow = std::max(c.Z - ring, m_MinCell.Z), zHigh = std::min(c.Z + ring, m_MaxCell.Z);
+			int32_t yLow = std::max(c.Y - ring, m_MinCell.Y), yHigh = std::min(c.Y + ring, m_MaxCell.Y);
+			int32_t xLow = std::max(c.X - ring, m_MinCell.X), xHigh = std::min(c.X + ring, m_MaxCell.X);
+			for (int32_t z = zLow; z <= zHigh; z++)
+				for (int32_t y = yLow; y <= yHigh; y++)
+				{
+					if (z == c.Z - ring || z == c.Z + ring || y == c.Y - ring || y == c.Y + ring)
+					{
+						for (int32_t x = xLow; x <= xHigh; x++)
+							ForEachInCell(cell_coord{ x, y, z }, offer);
+					}
+					else
+					{
+						// Inside the shell's faces only its two X ends belong to it
+						if (c.X - ring >= m_MinCell.X)
+							ForEachInCell(cell_coord{ c.X - ring, y, z }, offer);
+						if (ring > 0 && c.X + ring <= m_MaxCell.X)
+							ForEachInCell(cell_coord{ c.X + ring, y, z }, offer);
+					}
+				}
+		}
+
+		out.resize(best.size());
+		for (size_t i = out.size(); i-- > 0;)
+		{
+			out[i] = best.top().second;
+			best.pop();
+		}
+	}
+
+	template <typename T>
+	size_t spatial_grid<T>::Size() const
+	{
+		return m_Points.size();
+	}
+
+	template <typename T>
+	size_t spatial_grid<T>::MovedCount() const
+	{
+		return m_Moved.size();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Geometry/aabb.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+#include "../Utils/simd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Maths::Spatial {
+
+	using namespace Maths::Containers;
+
+	enum class space_curve
+	{
+		Morton,
+		Hilbert
+	};
+
+	// Morton (Z-order) keys interleave the bits of the cell coordinates, x in the lowest
+	// bit of each triple: 10 bits per axis for 30-bit keys, 21 bits per axis for 63-bit keys
+	uint32_t Morton30(uint32_t x, uint32_t y, uint32_t z);
+	uint64_t Morton63(uint64_t x, uint64_t y, uint64_t z);
+
+	// Hilbert keys for the same cell coordinates. Unlike Morton order, consecutive keys
+	// are always neighbouring cells, which gives better locality at a higher cost per key.
+	uint32_t Hilbert30(uint32_t x, uint32_t y, uint32_t z);
+	uint64_t Hilbert63(uint64_t x, uint64_t y, uint64_t z);
+
+	namespace Detail {
+
+		// Spreads the low 10 bits of v so there are two zero bits between each: one
+		// bit deposit with BMI2, otherwise a branch-free sequence of shifts and masks
+		inline uint32_t SpreadBits3(uint32_t v)
+		{
+#ifdef MATHS_BMI2
+			return _pdep_u32(v, 0x09249249u);
+#else
+			v &= 0x000003FFu;
+			v = (v | (v << 16)) & 0x030000FFu;
+			v = (v | (v << 8)) & 0x0300F00Fu;
+			v = (v | (v << 4)) & 0x030C30C3u;
+			v = (v | (v << 2)) & 0x09249249u;
+			return v;
+#endif
+		}
+
+		// Spreads the low 21 bits of v so there are two zero bits between each
+		inline uint64_t SpreadBits3(uint64_t v)
+		{
+#if defined(MATHS_BMI2) && (defined(__x86_64__) || defined(_M_X64))
+			return _pdep_u64(v, 0x1249249249249249ull);
+#else
+			v &= 0x00000000001FFFFFull;
+			v = (v | (v << 32)) & 0x001F00000000FFFFull;
+			v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+			v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+			v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+			v = (v | (v << 2)) & 0x1249249249249249ull;
+			return v;
+#endif
+		}
+
+		// Skilling's transform from axis coordinates to the "transposed" Hilbert index,
+		// whose bits read x, y, z from the most significant bit down form the key
+		template <typename U>
+		void AxesToTranspose(U (&axes)[3], uint32_t bits)
+		{
+			U top = U(1) << (bits - 1);
+
+			for (U q = top; q > 1; q >>= 1)
+			{
+				U p = q - 1;
+				for (int i = 0; i < 3; i++)
+				{
+					if (axes[i] & q)
+					{
+						axes[0] ^= p;
+					}
+					else
+					{
+						U t = (axes[0] ^ axes[i]) & p;
+						axes[0] ^= t;
+						axes[i] ^= t;
+					}
+				}
+			}
+
+			axes[1] ^= axes[0];
+			axes[2] ^= axes[1];
+
+			U t = 0;
+			for (U q = top; q > 1; q >>= 1)
+				if (axes[2] & q)
+					t ^= q - 1;
+
+			for (int i = 0; i < 3; i++)
+				axes[i] ^= t;
+		}
+
+		// Cell coordinate of v on a grid of maxCell + 1 cells starting at min
+		template <typename T>
+		uint32_t Quantise(T v, T min, T scale, uint32_t maxCell)
+		{
+			T cell = (v - min) * scale;
+			if (!(cell > T(0)))
+				return 0;
+			return cell >= T(maxCell) ? maxCell : uint32_t(cell);
+		}
+
+#ifdef MATHS_SSE2
+		// The shifts and masks of SpreadBits3 on four 32 bit lanes
+		inline __m128i SpreadBits3(__m128i v)
+		{
+			v = _mm_and_si128(v, _mm_set1_epi32(0x000003FF));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 16)), _mm_set1_epi32(0x030000FF));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 8)), _mm_set1_epi32(0x0300F00F));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 4)), _mm_set1_epi32(0x030C30C3));
+			v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 2)), _mm_set1_epi32(0x09249249));
+			return v;
+		}
+
+		// Quantise on four lanes. max returns its second operand for NaN, so NaN, zero and
+		// negative cells all give cell 0 as in the scalar version.
+		inline __m128i Quantise(__m128 v, __m128 min, __m128 scale, __m128 maxCell)
+		{
+			__m128 cell = _mm_mul_ps(_mm_sub_ps(v, min), scale);
+			return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(cell, _mm_setzero_ps()), maxCell));
+		}
+
+		// 30-bit Morton keys of four float points
+		inline void MortonKeys4(const vec3<float>* points, const __m128* min, const __m128* scale, __m128 maxCell, uint32_t* keys)
+		{
+			__m128i x = Quantise(_mm_setr_ps(points[0].X, points[1].X, points[2].X, points[3].X), min[0], scale[0], maxCell);
+			__m128i y = Quantise(_mm_setr_ps(points[0].Y, points[1].Y, points[2].Y, points[3].Y), min[1], scale[1], maxCell);
+			__m128i z = Quantise(_mm_setr_ps(points[0].Z, points[1].Z, points[2].Z, points[3].Z), min[2], scale[2], maxCell);
+
+			__m128i key = _mm_or_si128(SpreadBits3(x), _mm_slli_epi32(SpreadBits3(y), 1));
+			key = _mm_or_si128(key, _mm_slli_epi32(SpreadBits3(z), 2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(keys), key);
+		}
+#endif
+
+		// Keys of the quantised points. interleaved says the keys are Morton30 codes,
+		// which for float points are computed four at a time with SSE2 instead.
+		template <typename K, typename T, typename Encode>
+		void EncodeKeys(const vec3<T>* points, size_t count, const Geometry::aabb<T>& bounds, K* keys, uint32_t maxCell, Encode encode, bool interleaved = false)
+		{
+			vec3<T> extent = bounds.Max - bounds.Min;
+			vec3<T> scale(
+				extent.X > T(0) ? T(maxCell) / extent.X : T(0),
+				extent.Y > T(0) ? T(maxCell) / extent.Y : T(0),
+				extent.Z > T(0) ? T(maxCell) / extent.Z : T(0));
+			vec3<T> min = bounds.Min;
+
+			Utils::ParallelFor(count, 1 << 14, [=](size_t begin, size_t end)
+			{
+				size_t i = begin;
+#ifdef MATHS_SSE2
+				if constexpr (std::is_same_v<T, float> && std::is_same_v<K, uint32_t>)
+				{
+					if (interleaved)
+					{
+						__m128 lanesMin[3] = { _mm_set1_ps(min.X), _mm_set1_ps(min.Y), _mm_set1_ps(min.Z) };
+						__m128 lanesScale[3] = { _mm_set1_ps(scale.X), _mm_set1_ps(scale.Y), _mm_set1_ps(scale.Z) };
+						__m128 lanesMax = _mm_set1_ps(float(maxCell));
+						for (; i < end - (end - begin) % 4; i += 4)
+							MortonKeys4(points + i, lanesMin, lanesScale, lanesMax, keys + i);
+					}
+				}
+#endif
+				for (; i < end; i++)
+				{
+					const vec3<T>& p = points[i];
+					keys[i] = encode(
+						K(Quantise(p.X, min.X, scale.X, maxCell)),
+						K(Quantise(p.Y, min.Y, scale.Y, maxCell)),
+						K(Quantise(p.Z, min.Z, scale.Z, maxCell)));
+				}
+			});
+		}
+
+		template <typename V>
+		void Gather(const uint32_t* order, size_t count, V* values)
+		{
+			std::vector<V> gathered(count);
+			Utils::ParallelFor(count, 1 << 14, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					gathered[i] = values[order[i]];
+			});
+			std::move(gathered.begin(), gathered.end(), values);
+		}
+
+	}
+
+	inline uint32_t Morton30(uint32_t x, uint32_t y, uint32_t z)
+	{
+		return Detail::SpreadBits3(x) | (Detail::SpreadBits3(y) << 1) | (Detail::SpreadBits3(z) << 2);
+	}
+
+	inline uint64_t Morton63(uint64_t x, uint64_t y, uint64_t z)
+	{
+		return Detail::SpreadBits3(x) | (Detail::SpreadBits3(y) << 1) | (Detail::SpreadBits3(z) << 2);
+	}
+
+	inline uint32_t Hilbert30(uint32_t x, uint32_t y, uint32_t z)
+	{
+		uint32_t axes[3] = { x & 0x3FFu, y & 0x3FFu, z & 0x3FFu };
+		Detail::AxesToTranspose(axes, 10);
+		return Morton30(axes[2], axes[1], axes[0]);
+	}
+
+	inline uint64_t Hilbert63(uint64_t x, uint64_t y, uint64_t z)
+	{
+		uint64_t axes[3] = { x & 0x1FFFFFull, y & 0x1FFFFFull, z & 0x1FFFFFull };
+		Detail::AxesToTranspose(axes, 21);
+		return Morton63(axes[2], axes[1], axes[0]);
+	}
+
+	// Batch key generation for points inside bounds (points outside are clamped to the
+	// nearest cell). The key width follows the output type: uint32_t for 30-bit keys,
+	// uint64_t for 63-bit keys. 30-bit Morton keys of float points are built four per
+	// SSE2 register; the other curves and widths go one point at a time.
+	template <typename T>
+	void MortonKeys(const vec3<T>* points, size_t count, const Geometry::aabb<T>& bounds, uint32_t* keys)
+	{
+		MATHS_PROFILE_KERNEL("MortonKeys", count, count * (sizeof(vec3<T>) + sizeof(uint32_t)));
+		Detail::EncodeKeys(points, count, bounds, keys, 0x3FFu, [](uint32_t x, uint32_t y, uint32_t z) { return Morton30(x, y, z); }, true);
+	}
+
+	template <typename T>
+	void MortonKeys(const vec3<T>* points, size_t count, const Geometry::aabb<T>& bounds, uint64_t* keys)
+	{
+		MATHS_PROFILE_KERNEL("MortonKeys", count, count * (sizeof(vec3<T>) + sizeof(uint64_t)));
+		Detail::EncodeKeys(points, count, bounds, keys, 0x1FFFFFu, [](uint64_t x, uint64_t y, uint64_t z) { return Morton63(x, y, z); });
+	}
+
+	template <typename T>
+	void HilbertKeys(const vec3<T>* points, size_t count, const Geometry::aabb<T>& bounds, uint32_t* keys)
+	{
+		MATHS_PROFILE_KERNEL("HilbertKeys", count, count * (sizeof(vec3<T>) + sizeof(uint32_t)));
+		Detail::EncodeKeys(points, count, bounds, keys, 0x3FFu, [](uint32_t x, uint32_t y, uint32_t z) { return Hilbert30(x, y, z); });
+	}
+
+	template <typename T>
+	void HilbertKeys(const vec3<T>* points, size_t count, const Geometry::aabb<T>& bounds, uint64_t* keys)
+	{
+		MATHS_PROFILE_KERNEL("HilbertKeys", count, count * (sizeof(vec3<T>) + sizeof(uint64_t)));
+		Detail::EncodeKeys(points, count, bounds, keys, 0x1FFFFFu, [](uint64_t x, uint64_t y, uint64_t z) { return Hilbert63(x, y, z); });
+	}
+
+	// Stable LSD radix sort of keys in place, 8 bits per pass. order[i] receives the
+	// original index of the i-th sorted key. Passes over bytes that are the same in
+	// every key are skipped, so 30-bit keys never take more than four passes.
+	template <typename K>
+	void SortByKey(K* keys, size_t count, uint32_t* order)
+	{
+		MATHS_PROFILE_KERNEL("SortByKey", count, count * 4 * (sizeof(K) + sizeof(uint32_t)));
+
+		constexpr size_t Radix = 256;
+		size_t chunks = std::max<size_t>(1, std::min(Utils::ThreadCount(), count >> 14));
+		size_t chunkSize = (count + chunks - 1) / chunks;
+
+		// Bits that differ between any two keys
+		std::pair<K, K> bits = Utils::ParallelReduce(count, 1 << 14, std::pair<K, K>(K(0), K(~K(0))),
+			[=](size_t begin, size_t end)
+			{
+				std::pair<K, K> local(K(0), K(~K(0)));
+				for (size_t i = begin; i < end; i++)
+				{
+					local.first |= keys[i];
+					local.second &= keys[i];
+				}
+				return local;
+			},
+			[](const std::pair<K, K>& a, const std::pair<K, K>& b) { return std::pair<K, K>(a.first | b.first, a.second & b.second); });
+		K differing = bits.first ^ bits.second;
+
+		for (size_t i = 0; i < count; i++)
+			order[i] = uint32_t(i);
+
+		std::vector<K> keyBuffer(count);
+		std::vector<uint32_t> orderBuffer(count);
+		std::vector<size_t> offsets(chunks * Radix);
+
+		K* keysIn = keys;
+		K* keysOut = keyBuffer.data();
+		uint32_t* orderIn = order;
+		uint32_t* orderOut = orderBuffer.data();
+
+		for (uint32_t shift = 0; shift < sizeof(K) * 8; shift += 8)
+		{
+			if (((differing >> shift) & K(Radix - 1)) == 0)
+				continue;
+
+			// Per chunk digit histograms
+			Utils::ParallelFor(chunks, 1, [&](size_t first, size_t last)
+			{
+				for (size_t chunk = first; chunk < last; chunk++)
+				{
+					size_t* histogram = &offsets[chunk * Radix];
+					std::fill(histogram, histogram + Radix, size_t(0));
+					size_t end = std::min(count, (chunk + 1) * chunkSize);
+					for (size_t i = chunk * chunkSize; i < end; i++)
+						histogram[(keysIn[i] >> shift) & K(Radix - 1)]++;
+				}
+			});
+
+			// Digit major, chunk minor prefix sum keeps the scatter stable
+			size_t total = 0;
+			for (size_t digit = 0; digit < Radix; digit++)
+			{
+				for (size_t chunk = 0; chunk < chunks; chunk++)
+				{
+					size_t digitCount = offsets[chunk * Radix + digit];
+					offsets[chunk * Radix + digit] = total;
+					total += digitCount;
+				}
+			}
+
+			Utils::ParallelFor(chunks, 1, [&](size_t first, size_t last)
+			{
+				for (size_t chunk = first; chunk < last; chunk++)
+				{
+					size_t* offset = &offsets[chunk * Radix];
+					size_t end = std::min(count, (chunk + 1) * chunkSize);
+					for (size_t i = chunk * chunkSize; i < end; i++)
+					{
+						size_t slot = offset[(keysIn[i] >> shift) & K(Radix - 1)]++;
+						keysOut[slot] = keysIn[i];
+						orderOut[slot] = orderIn[i];
+					}
+				}
+			});
+
+			std::swap(keysIn, keysOut);
+			std::swap(orderIn, orderOut);
+		}
+
+		if (keysIn != keys)
+		{
+			std::copy(keysIn, keysIn + count, keys);
+			std::copy(orderIn, orderIn + count, order);
+		}
+	}
+
+	// Permutes each array so that element i becomes the element at order[i], e.g. to
+	// carry payload arrays along with a sort
+	template <typename... V>
+	void Reorder(const uint32_t* order, size_t count, V*... arrays)
+	{
+		(Detail::Gather(order, count, arrays), ...);
+	}
+
+	// Sorts points along a space filling curve over their bounds, using 63-bit keys.
+	// order[i] receives the original index of the i-th sorted point; pass it to Reorder
+	// for any per-point payload.
+	template <typename T>
+	void SpatialSort(vec3<T>* points, size_t count, uint32_t* order, space_curve curve = space_curve::Hilbert)
+	{
+		MATHS_PROFILE_CALL("SpatialSort");
+
+		Geometry::aabb<T> bounds = Geometry::aabb<T>::Empty();
+		for (size_t i = 0; i < count; i++)
+			bounds.Expand(points[i]);
+
+		std::vector<uint64_t> keys(count);
+		if (curve == space_curve::Hilbert)
+			HilbertKeys(points, count, bounds, keys.data());
+		else
+			MortonKeys(points, count, bounds, keys.data());
+
+		SortByKey(keys.data(), count, order);
+		Reorder(order, count, points);
+	}
+
+}
\ No newline at end of file
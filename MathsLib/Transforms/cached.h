@@ -0,0 +1,274 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Containers/mat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/parallel.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Maths::Transforms {
+
+	using namespace Maths::Containers;
+
+	// World matrix with lazily derived inverse and normal matrix. Every change bumps
+	// Version; each derived product remembers the version it was built from and is only
+	// rebuilt when read after a change, so static objects never pay for it again.
+	// The const accessors write the cache when it is stale, so concurrent reads are only
+	// safe once Refresh (or RefreshTransforms) has run since the last change.
+	template <typename T>
+	class cached_transform
+	{
+	public:
+		cached_transform();
+		cached_transform(const mat4<T>& world);
+
+		void Set(const mat4<T>& world);
+		void Invalidate();
+
+		// Rebuilds any stale derived product now, so later const reads do not write
+		void Refresh();
+
+		const mat4<T>& World() const;
+		uint64_t Version() const;
+
+		const mat4<T>& Inverse() const;
+		const mat3<T>& NormalMatrix() const;	// Inverse-transpose of the upper 3x3
+
+		// True if a derived product will be rebuilt on its next read
+		bool IsStale() const;
+
+	private:
+		mat4<T> m_World;
+		uint64_t m_Version = 1;
+
+		mutable mat4<T> m_Inverse;
+		mutable mat3<T> m_NormalMatrix;
+		mutable uint64_t m_InverseVersion = 0;
+		mutable uint64_t m_NormalVersion = 0;
+	};
+
+	// View and projection with a lazily combined view-projection and its inverse. Like
+	// cached_transform, the first read after a change writes the cache, so call Refresh
+	// before sharing a changed camera between threads.
+	template <typename T>
+	class cached_camera
+	{
+	public:
+		cached_camera();
+
+		void SetView(const mat4<T>& view);
+		void SetProjection(const mat4<T>& projection);
+
+		void Refresh();
+
+		const mat4<T>& View() const;
+		const mat4<T>& Projection() const;
+		const mat4<T>& ViewProjection() const;
+		const mat4<T>& InverseViewProjection() const;
+
+	private:
+		mat4<T> m_View;
+		mat4<T> m_Projection;
+		uint64_t m_ViewVersion = 1;
+		uint64_t m_ProjectionVersion = 1;
+
+		mutable mat4<T> m_ViewProjection;
+		mutable mat4<T> m_InverseViewProjection;
+		mutable uint64_t m_ViewSeen = 0;
+		mutable uint64_t m_ProjectionSeen = 0;
+		mutable uint64_t m_InverseViewSeen = 0;
+		mutable uint64_t m_InverseProjectionSeen = 0;
+	};
+
+	namespace Detail {
+
+		// Affine matrices (last row [0 0 0 1]) invert through their 3x3 part, which is
+		// far cheaper than the general 4x4 inverse
+		template <typename T>
+		mat4<T> InverseWorld(const mat4<T>& world)
+		{
+			const T* m = world.Elements;
+			if (m[3] != T(0) || m[7] != T(0) || m[11] != T(0) || m[15] != T(1))
+				return mat4<T>::Inverse(world);
+
+			mat3<T> linear = mat3<T>::Inverse(mat3<T>(world));
+			vec3<T> t = linear * vec3<T>(m[12], m[13], m[14]);
+
+			mat4<T> result(linear);
+			result.Cols[3] = vec4<T>(-t.X, -t.Y, -t.Z, T(1));
+			return result;
+		}
+
+	}
+
+	template <typename T>
+	cached_transform<T>::cached_transform() : m_World(T(1))
+	{
+
+	}
+
+	template <typename T>
+	cached_transform<T>::cached_transform(const mat4<T>& world) : m_World(world)
+	{
+
+	}
+
+	template <typename T>
+	void cached_transform<T>::Set(const mat4<T>& world)
+	{
+		m_World = world;
+		m_Version++;
+	}
+
+	template <typename T>
+	void cached_transform<T>::Invalidate()
+	{
+		m_Version++;
+	}
+
+	template <typename T>
+	void cached_transform<T>::Refresh()
+	{
+		Inverse();
+		NormalMatrix();
+	}
+
+	template <typename T>
+	const mat4<T>& cached_transform<T>::World() const
+	{
+		return m_World;
+	}
+
+	template <typename T>
+	uint64_t cached_transform<T>::Version() const
+	{
+		return m_Version;
+	}
+
+	template <typename T>
+	const mat4<T>& cached_transform<T>::Inverse() const
+	{
+		if (m_InverseVersion != m_Version)
+		{
+			m_Inverse = Detail::InverseWorld(m_World);
+			m_InverseVersion = m_Version;
+		}
+		return m_Inverse;
+	}
+
+	template <typename T>
+	const mat3<T>& cached_transform<T>::NormalMatrix() const
+	{
+		if (m_NormalVersion != m_Version)
+		{
+			m_NormalMatrix = mat3<T>::Transpose(mat3<T>::Inverse(mat3<T>(m_World)));
+			m_NormalVersion = m_Version;
+		}
+		return m_NormalMatrix;
+	}
+
+	template <typename T>
+	bool cached_transform<T>::IsStale() const
+	{
+		return m_InverseVersion != m_Version || m_NormalVersion != m_Version;
+	}
+
+	template <typename T>
+	cached_camera<T>::cached_camera() : m_View(T(1)), m_Projection(T(1))
+	{
+
+	}
+
+	template <typename T>
+	void cached_camera<T>::SetView(const mat4<T>& view)
+	{
+		m_View = view;
+		m_ViewVersion++;
+	}
+
+	template <typename T>
+	void cached_camera<T>::SetProjection(const mat4<T>& projection)
+	{
+		m_Projection = projection;
+		m_ProjectionVersion++;
+	}
+
+	template <typename T>
+	void cached_camera<T>::Refresh()
+	{
+		InverseViewProjection();
+	}
+
+	template <typename T>
+	const mat4<T>& cached_camera<T>::View() const
+	{
+		return m_View;
+	}
+
+	template <typename T>
+	const mat4<T>& cached_camera<T>::Projection() const
+	{
+		return m_Projection;
+	}
+
+	template <typename T>
+	const mat4<T>& cached_camera<T>::ViewProjection() const
+	{
+		if (m_ViewSeen != m_ViewVersion || m_ProjectionSeen != m_ProjectionVersion)
+		{
+			m_ViewProjection = m_Projection * m_View;
+			m_ViewSeen = m_ViewVersion;
+			m_ProjectionSeen = m_ProjectionVersion;
+		}
+		return m_ViewProjection;
+	}
+
+	template <typename T>
+	const mat4<T>& cached_camera<T>::InverseViewProjection() const
+	{
+		if (m_InverseViewSeen != m_ViewVersion || m_InverseProjectionSeen != m_ProjectionVersion)
+		{
+			m_InverseViewProjection = mat4<T>::Inverse(ViewProjection());
+			m_InverseViewSeen = m_ViewVersion;
+			m_InverseProjectionSeen = m_ProjectionVersion;
+		}
+		return m_InverseViewProjection;
+	}
+
+	// Marks the listed transforms as changed without touching their world matrices,
+	// e.g. after a parent moved
+	template <typename T>
+	void InvalidateTransforms(cached_transform<T>* transforms, const uint32_t* indices, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			transforms[indices[i]].Invalidate();
+	}
+
+	template <typename T>
+	void SetTransforms(cached_transform<T>* transforms, const uint32_t* indices, const mat4<T>* worlds, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			transforms[indices[i]].Set(worlds[i]);
+	}
+
+	// Eagerly rebuilds the derived products of stale transforms across threads, so the
+	// render loop only ever reads cached values. Up to date transforms cost one compare.
+	// Each transform is written by one thread; nothing else may access them meanwhile.
+	template <typename T>
+	void RefreshTransforms(cached_transform<T>* transforms, size_t count)
+	{
+		MATHS_PROFILE_KERNEL("RefreshTransforms", count, count * sizeof(cached_transform<T>));
+
+		Utils::ParallelFor(count, 1024, [=](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				if (transforms[i].IsStale())
+					transforms[i].Refresh();
+			}
+		});
+	}
+
+}
\ No newline at end of file
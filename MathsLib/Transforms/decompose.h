@@ -0,0 +1,209 @@
+#pragma once
+
+#include "../Containers/vec3.h"
+#include "../Containers/mat.h"
+#include "../Containers/quat.h"
+#include "../Utils/instrumentation.h"
+#include "../Utils/lanes.h"
+#include "../Utils/parallel.h"
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace Maths::Transforms {
+
+	using namespace Maths::Containers;
+
+	// Splits a matrix into translation, rotation and scale so that
+	// matrix = Translation(translation) * ToMatrix(rotation) * Scale(scale).
+	//
+	// The rotation is the Gram-Schmidt frame of the upper 3x3 columns, so the X axis keeps
+	// its direction exactly. Shear cannot be represented and is dropped: the scale is the
+	// diagonal of the triangular factor, and the result reproduces the matrix only when
+	// the columns are orthogonal (any chain of rotations and scales applied in that order).
+	// A reflection (negative determinant) becomes a negative Z scale, so the rotation is
+	// always proper; it is returned normalised with W >= 0.
+	//
+	// Returns false, leaving an identity rotation and the column lengths as the scale, when
+	// the bottom row is not [0 0 0 1] (projections) or the upper 3x3 is singular to within
+	// rounding (a zero scale, or columns that are linearly dependent). The translation is
+	// always the last column.
+	template <typename T>
+	bool Decompose(const mat4<T>& matrix, vec3<T>& translation, quat<T>& rotation, vec3<T>& scale);
+
+	// Batch form; succeeded may be null. Four float matrices are decomposed at once in SSE
+	// lanes.
+	template <typename T>
+	void Decompose(const mat4<T>* matrices, size_t count, vec3<T>* translations, quat<T>* rotations, vec3<T>* scales, bool* succeeded = nullptr);
+
+	namespace Detail {
+
+		template <typename L>
+		L Dot3(const L* lhs, const L* rhs)
+		{
+			return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+		}
+
+		// m is the column-major matrix, rotation is quaternion XYZW. Returns the success mask.
+		template <typename L>
+		auto Decompose(const L* m, L* translation, L* rotation, L* scale)
+		{
+			constexpr float Epsilon = std::is_same_v<L, double> ? float(std::numeric_limits<double>::epsilon()) : std::numeric_limits<float>::epsilon();
+
+			for (int i = 0; i < 3; i++)
+				translation[i] = m[12 + i];
+
+			const L* c0 = m;
+			const L* c1 = m + 4;
+			const L* c2 = m + 8;
+			L lengths[3] = { Utils::Sqrt(Dot3(c0, c0)), Utils::Sqrt(Dot3(c1, c1)), Utils::Sqrt(Dot3(c2, c2)) };
+
+			// Gram-Schmidt; r holds the orthonormal columns
+			L r[9];
+			L sx = lengths[0];
+			for (int i = 0; i < 3; i++)
+				r[i] = c0[i] / sx;
+
+			L d = Dot3(r, c1);
+			for (int i = 0; i < 3; i++)
+				r[3 + i] = c1[i] - r[i] * d;
+			L sy = Utils::Sqrt(Dot3(r + 3, r + 3));
+			for (int i = 0; i < 3; i++)
+				r[3 + i] = r[3 + i] / sy;
+
+			d = Dot3(r, c2);
+			for (int i = 0; i < 3; i++)
+				r[6 + i] = c2[i] - r[i] * d;
+			d = Dot3(r + 3, r + 6);
+			for (int i = 0; i < 3; i++)
+				r[6 + i] = r[6 + i] - r[3 + i] * d;
+			L sz = Utils::Sqrt(Dot3(r + 6, r + 6));
+			for (int i = 0; i < 3; i++)
+				r[6 + i] = r[6 + i] / sz;
+
+			// Comparisons with NaN are false, so non-finite input fails too
+			L tolerance = L(Epsilon * 16.0f) * (lengths[0] + lengths[1] + lengths[2]);
+			auto valid = Utils::And(Utils::And(Utils::Less(tolerance, sx), Utils::Less(tolerance, sy)), Utils::Less(tolerance, sz));
+			auto affine = Utils::And(Utils::And(Utils::Equal(m[3], L(0.0f)), Utils::Equal(m[7], L(0.0f))), Utils::And(Utils::Equal(m[11], L(0.0f)), Utils::Equal(m[15], L(1.0f))));
+			auto succeeded = Utils::And(valid, affine);
+
+			// Turn a reflection into a negative Z scale
+			L handedness = r[2] * (r[3] * r[7] - r[4] * r[6]) + r[5] * (r[1] * r[6] - r[0] * r[7]) + r[8] * (r[0] * r[4] - r[1] * r[3]);
+			auto reflected = Utils::Less(handedness, L(0.0f));
+			sz = Utils::Select(reflected, -sz, sz);
+			for (int i = 0; i < 3; i++)
+				r[6 + i] = Utils::Select(reflected, -r[6 + i], r[6 + i]);
+
+			// Quaternion from the largest of 4w^2, 4x^2, 4y^2 and 4z^2, as in quat::FromMatrix
+			// but with selects in place of the branches
+			L r00 = r[0], r11 = r[4], r22 = r[8];
+			L w4 = L(1.0f) + r00 + r11 + r22;
+			L x4 = L(1.0f) + r00 - r11 - r22;
+			L y4 = L(1.0f) - r00 + r11 - r22;
+			L z4 = L(1.0f) - r00 - r11 + r22;
+			L yz = r[5] - r[7], zx = r[6] - r[2], xy = r[1] - r[3];
+			L yzSum = r[5] + r[7], zxSum = r[6] + r[2], xySum = r[1] + r[3];
+
+			L q[4] = { yz, zx, xy, w4 };
+			L largest = w4;
+
+			auto pick = [&](L candidate, L x, L y, L z, L w)
+			{
+				auto larger = Utils::Less(largest, candidate);
+				largest = Utils::Select(larger, candidate, largest);
+				q[0] = Utils::Select(larger, x, q[0]);
+				q[1] = Utils::Select(larger, y, q[1]);
+				q[2] = Utils::Select(larger, z, q[2]);
+				q[3] = Utils::Select(larger, w, q[3]);
+			};
+			pick(x4, x4, xySum, zxSum, yz);
+			pick(y4, xySum, y4, yzSum, zx);
+			pick(z4, zxSum, yzSum, z4, xy);
+
+			// Dividing by the length both normalises and flips W to be non-negative
+			L length = Utils::Sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+			length = Utils::Select(Utils::Less(q[3], L(0.0f)), -length, length);
+
+			const L identity[4] = { L(0.0f), L(0.0f), L(0.0f), L(1.0f) };
+			for (int i = 0; i < 4; i++)
+				rotation[i] = Utils::Select(succeeded, q[i] / length, identity[i]);
+
+			scale[0] = Utils::Select(succeeded, sx, lengths[0]);
+			scale[1] = Utils::Select(succeeded, sy, lengths[1]);
+			scale[2] = Utils::Select(succeeded, sz, lengths[2]);
+
+			return succeeded;
+		}
+
+		template <typename T>
+		void DecomposeRange(const mat4<T>* matrices, size_t begin, size_t end, vec3<T>* translations, quat<T>* rotations, vec3<T>* scales, bool* succeeded)
+		{
+			size_t i = begin;
+#ifdef MATHS_SSE
+			if constexpr (std::is_same_v<T, float>)
+			{
+				for (; i + 4 <= end; i += 4)
+				{
+					const mat4<T>* m = matrices + i;
+					vec3<T>* t = translations + i;
+					quat<T>* r = rotations + i;
+					vec3<T>* s = scales + i;
+
+					Utils::lanes4 elements[16], translation[3], rotation[4], scale[3];
+					for (int e = 0; e < 16; e++)
+						elements[e] = Utils::Gather(&m[0].Elements[e], &m[1].Elements[e], &m[2].Elements[e], &m[3].Elements[e]);
+
+					Utils::lanes4 valid = Decompose(elements, translation, rotation, scale);
+
+					Utils::Scatter(translation[0], &t[0].X, &t[1].X, &t[2].X, &t[3].X);
+					Utils::Scatter(translation[1], &t[0].Y, &t[1].Y, &t[2].Y, &t[3].Y);
+					Utils::Scatter(translation[2], &t[0].Z, &t[1].Z, &t[2].Z, &t[3].Z);
+					Utils::Scatter(rotation[0], &r[0].X, &r[1].X, &r[2].X, &r[3].X);
+					Utils::Scatter(rotation[1], &r[0].Y, &r[1].Y, &r[2].Y, &r[3].Y);
+					Utils::Scatter(rotation[2], &r[0].Z, &r[1].Z, &r[2].Z, &r[3].Z);
+					Utils::Scatter(rotation[3], &r[0].W, &r[1].W, &r[2].W, &r[3].W);
+					Utils::Scatter(scale[0], &s[0].X, &s[1].X, &s[2].X, &s[3].X);
+					Utils::Scatter(scale[1], &s[0].Y, &s[1].Y, &s[2].Y, &s[3].Y);
+					Utils::Scatter(scale[2], &s[0].Z, &s[1].Z, &s[2].Z, &s[3].Z);
+
+					if (succeeded)
+					{
+						int bits = _mm_movemask_ps(valid.Value);
+						for (int k = 0; k < 4; k++)
+							succeeded[i + k] = (bits >> k) & 1;
+					}
+				}
+			}
+#endif
+			for (; i < end; i++)
+			{
+				T translation[3], rotation[4], scale[3];
+				bool valid = Decompose(matrices[i].Elements, translation, rotation, scale);
+
+				translations[i] = vec3<T>(translation[0], translation[1], translation[2]);
+				rotations[i] = quat<T>(rotation[0], rotation[1], rotation[2], rotation[3]);
+				scales[i] = vec3<T>(scale[0], scale[1], scale[2]);
+				if (succeeded)
+					succeeded[i] = valid;
+			}
+		}
+
+	}
+
+	template <typename T>
+	bool Decompose(const mat4<T>& matrix, vec3<T>& translation, quat<T>& rotation, vec3<T>& scale)
+	{
+		bool succeeded;
+		Detail::DecomposeRange(&matrix, 0, 1, &translation, &rotation, &scale, &succeeded);
+		return succeeded;
+	}
+
+	template <typename T>
+	void Decompose(const mat4<T>* matrices, size_t count, vec3<T>* translations, quat<T>* rotations, vec3<T>* scales, bool* succeeded)
+	{
+		MATHS_PROFILE_KERNEL("Decompose", count, count * (sizeof(mat4<T>) + 2 * sizeof(vec3<T>) + sizeof(quat<T>)));
+		Utils::ParallelFor(count, 1024, [=](size_t begin, size_t end) { Detail::DecomposeRange(matrices, begin, end, translations, rotations, scales, succeeded); });
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Tools for checking a kernel's SIMD or approximate path against a reference: the error of
+// each result in units in the last place (ULPs) and max/mean statistics over a run. The
+// reference is usually the same formula evaluated in long double. Throughput of the same
+// run comes from the instrumentation counters (MATHS_PROFILE_KERNEL), so both can be
+// reported side by side.
+
+namespace Maths::Utils {
+
+	// Number of representable values between lhs and rhs, so 0 when they are equal and 1 for
+	// neighbours. +0 and -0 are equal, and lhs and rhs on either side of zero count the
+	// values crossed. Two NaNs are equal; a NaN and a number are as far apart as possible.
+	template <typename T>
+	uint64_t UlpDistance(T lhs, T rhs);
+
+	// Distance from the reference rounded to T, i.e. the error beyond the unavoidable half
+	// ULP of rounding
+	template <typename T>
+	uint64_t UlpError(T computed, long double reference);
+
+	// Error in ULPs of scale rather than of the reference. For results that come from
+	// cancelling terms, e.g. a dot product, pass the sum of the terms' magnitudes: the error
+	// stays bounded where the result itself is close to zero.
+	template <typename T>
+	uint64_t UlpError(T computed, long double reference, long double scale);
+
+	struct ulp_stats
+	{
+		uint64_t Max = 0;
+		uint64_t Count = 0;
+		double Total = 0.0;
+		size_t WorstIndex = 0;		// Index passed to Add with the largest error
+
+		void Add(uint64_t error, size_t index);
+
+		// Combines the statistics of another run, e.g. from another thread
+		void Merge(const ulp_stats& other);
+
+		double Mean() const;
+	};
+
+	// Statistics of computed[i] against reference[i]
+	template <typename T>
+	ulp_stats UlpError(const T* computed, const long double* reference, size_t count);
+
+	// Finite inputs where implementations typically lose accuracy: signed zeros, the smallest
+	// and largest subnormals, the smallest normal, values around 1, the square roots of the
+	// extremes (whose products overflow or underflow), the largest integer stored exactly
+	// and the largest finite value, each with both signs
+	template <typename T>
+	std::vector<T> AdversarialValues();
+
+	namespace Detail {
+
+		// Maps the bit pattern to an integer that increases with the value, with both zeros at 0
+		template <typename T>
+		int64_t OrderedBits(T value)
+		{
+			static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "ULP distances need an IEEE 754 float or double");
+
+			using bits_type = std::conditional_t<std::is_same_v<T, float>, uint32_t, uint64_t>;
+			constexpr bits_type SignBit = bits_type(1) << (sizeof(bits_type) * 8 - 1);
+
+			bits_type bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			int64_t magnitude = int64_t(bits & ~SignBit);
+			return (bits & SignBit) ? -magnitude : magnitude;
+		}
+
+	}
+
+	template <typename T>
+	uint64_t UlpDistance(T lhs, T rhs)
+	{
+		bool lhsNaN = std::isnan(lhs), rhsNaN = std::isnan(rhs);
+		if (lhsNaN || rhsNaN)
+			return lhsNaN && rhsNaN ? 0 : std::numeric_limits<uint64_t>::max();
+
+		int64_t a = Detail::OrderedBits(lhs), b = Detail::OrderedBits(rhs);
+		return a > b ? uint64_t(a) - uint64_t(b) : uint64_t(b) - uint64_t(a);
+	}
+
+	template <typename T>
+	uint64_t UlpError(T computed, long double reference)
+	{
+		return UlpDistance(computed, T(reference));
+	}
+
+	template <typename T>
+	uint64_t UlpError(T computed, long double reference, long double scale)
+	{
+		if (std::isnan(computed) != std::isnan(reference))
+			return std::numeric_limits<uint64_t>::max();
+		if (std::isnan(computed))
+			return 0;
+
+		// Spacing of T at the magnitude of scale, never below the smallest subnormal
+		T magnitude = T(std::fabs(scale));
+		long double spacing = (long double)(std::nextafter(magnitude, std::numeric_limits<T>::infinity())) - (long double)(magnitude);
+		spacing = std::fmax(spacing, (long double)(std::numeric_limits<T>::denorm_min()));
+
+		long double error = std::ceil(std::fabs((long double)(computed) - reference) / spacing);
+		if (!(error < 1e18L))
+			return std::numeric_limits<uint64_t>::max();
+		return uint64_t(error);
+	}
+
+	inline void ulp_stats::Add(uint64_t error, size_t index)
+	{
+		if (Count == 0 || error > Max)
+		{
+			Max = error;
+			WorstIndex = index;
+		}
+		Count++;
+		Total += double(error);
+	}
+
+	inline void ulp_stats::Merge(const ulp_stats& other)
+	{
+		if (other.Count == 0)
+			return;
+
+		if (Count == 0 || other.Max > Max)
+		{
+			Max = other.Max;
+			WorstIndex = other.WorstIndex;
+		}
+		Count += other.Count;
+		Total += other.Total;
+	}
+
+	inline double ulp_stats::Mean() const
+	{
+		return Count == 0 ? 0.0 : Total / double(Count);
+	}
+
+	template <typename T>
+	ulp_stats UlpError(const T* computed, const long double* reference, size_t count)
+	{
+		ulp_stats stats;
+		for (size_t i = 0; i < count; i++)
+			stats.Add(UlpError(computed[i], reference[i]), i);
+		return stats;
+	}
+
+	template <typename T>
+	std::vector<T> AdversarialValues()
+	{
+		using limits = std::numeric_limits<T>;
+		const T magnitudes[] =
+		{
+			T(0),
+			limits::denorm_min(),
+			limits::min() - limits::denorm_min(),
+			limits::min(),
+			std::sqrt(limits::min()),
+			limits::epsilon(),
+			T(1) - limits::epsilon() / T(2),
+			T(1),
+			T(1) + limits::epsilon(),
+			T(1) / limits::epsilon() * T(2),
+			std::sqrt(limits::max()),
+			limits::max()
+		};
+
+		std::vector<T> values;
+		values.reserve(2 * std::size(magnitudes));
+		for (T magnitude : magnitudes)
+		{
+			values.push_back(magnitude);
+			values.push_back(-magnitude);
+		}
+		return values;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,566 @@
+#pragma once
+
+#include "parallel.h"
+
+// Coroutine based async layer over the batch kernels; needs C++20 and is left out otherwise
+#if defined(__cpp_impl_coroutine)
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Maths::Utils {
+
+	// Fixed set of worker threads running posted jobs in order. Batch kernels called from a
+	// job run their ParallelFor inline, since the pool already occupies the cores.
+	class thread_pool
+	{
+	public:
+		explicit thread_pool(size_t threads = ThreadCount());
+
+		// Runs the jobs that are still queued, then joins
+		~thread_pool();
+
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator = (const thread_pool&) = delete;
+
+		void Post(std::function<void()> job);
+		size_t Size() const;
+
+		// co_await pool.Schedule() continues the coroutine on a worker thread
+		auto Schedule();
+
+	private:
+		void Run();
+
+		std::vector<std::thread> m_Workers;
+		std::deque<std::function<void()>> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		bool m_Stopping = false;
+	};
+
+	template <typename T = void>
+	class task;
+
+	namespace Detail {
+
+		// Hands the thread straight to the coroutine awaiting the finished task
+		struct final_awaiter
+		{
+			bool await_ready() noexcept { return false; }
+
+			template <typename P>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept { return handle.promise().Continuation; }
+
+			void await_resume() noexcept {}
+		};
+
+		struct task_promise_base
+		{
+			std::coroutine_handle<> Continuation = std::noop_coroutine();
+			std::exception_ptr Exception;
+
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			final_awaiter final_suspend() noexcept { return {}; }
+
+			void unhandled_exception() { Exception = std::current_exception(); }
+		};
+
+		template <typename T>
+		struct task_promise : task_promise_base
+		{
+			std::optional<T> Value;
+
+			task<T> get_return_object();
+			void return_value(T value) { Value.emplace(std::move(value)); }
+
+			T Result()
+			{
+				if (Exception)
+					std::rethrow_exception(Exception);
+				return std::move(*Value);
+			}
+		};
+
+		template <>
+		struct task_promise<void> : task_promise_base
+		{
+			task<void> get_return_object();
+			void return_void() {}
+
+			void Result()
+			{
+				if (Exception)
+					std::rethrow_exception(Exception);
+			}
+		};
+
+		// Starts immediately and frees itself when it finishes
+		struct detached
+		{
+			struct promise_type
+			{
+				detached get_return_object() { return {}; }
+				std::suspend_never initial_suspend() noexcept { return {}; }
+				std::suspend_never final_suspend() noexcept { return {}; }
+				void return_void() {}
+				void unhandled_exception() { std::terminate(); }
+			};
+		};
+
+	}
+
+	// Lazily started coroutine producing a T. It runs when awaited, on the awaiting thread,
+	// and resumes the awaiting coroutine when it finishes; exceptions propagate to it.
+	template <typename T>
+	class task
+	{
+	public:
+		using promise_type = Detail::task_promise<T>;
+
+		task() = default;
+		explicit task(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+		task(task&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+
+		task& operator = (task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_Handle)
+					m_Handle.destroy();
+				m_Handle = std::exchange(other.m_Handle, nullptr);
+			}
+			return *this;
+		}
+
+		~task()
+		{
+			if (m_Handle)
+				m_Handle.destroy();
+		}
+
+		auto operator co_await() && noexcept
+		{
+			struct awaiter
+			{
+				std::coroutine_handle<promise_type> Handle;
+
+				bool await_ready() noexcept { return false; }
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+				{
+					Handle.promise().Continuation = awaiting;
+					return Handle;
+				}
+
+				T await_resume() { return Handle.promise().Result(); }
+			};
+			return awaiter{ m_Handle };
+		}
+
+	private:
+		std::coroutine_handle<promise_type> m_Handle;
+	};
+
+	template <typename T>
+	task<T> Detail::task_promise<T>::get_return_object()
+	{
+		return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+	}
+
+	inline task<void> Detail::task_promise<void>::get_return_object()
+	{
+		return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+	}
+
+	// Runs a task to completion, blocking the calling thread, and returns its result
+	template <typename T>
+	T SyncWait(task<T> work);
+
+	// Awaitable ParallelFor: the ranges run as jobs on the pool and the awaiting coroutine
+	// resumes on whichever worker finishes the last one, so no thread blocks meanwhile. As
+	// with ParallelFor, once a range throws the ranges not yet started are skipped, and
+	// the first exception is rethrown from the co_await.
+	template <typename F>
+	task<> ParallelForAsync(thread_pool& pool, size_t count, size_t minChunk, F func);
+
+	// Fixed-capacity queue between coroutines. Send suspends while the channel is full and
+	// Receive while it is empty, so a producer such as a file reader never gets more than
+	// Capacity items ahead of the consumer and memory stays bounded. Suspended coroutines
+	// are resumed on the pool.
+	template <typename T>
+	class bounded_channel
+	{
+	public:
+		bounded_channel(thread_pool& pool, size_t capacity);
+
+		bounded_channel(const bounded_channel&) = delete;
+		bounded_channel& operator = (const bounded_channel&) = delete;
+
+		// co_await Send(value) gives false if the channel was closed and the value dropped
+		auto Send(T value);
+
+		// co_await Receive() gives nothing once the channel is closed and drained
+		auto Receive();
+
+		// Wakes every waiting coroutine; items already queued can still be received
+		void Close();
+
+	private:
+		struct send_awaiter;
+		struct receive_awaiter;
+
+		thread_pool& m_Pool;
+		size_t m_Capacity;
+		std::deque<T> m_Items;
+		std::deque<send_awaiter*> m_Senders;
+		std::deque<receive_awaiter*> m_Receivers;
+		std::mutex m_Mutex;
+		bool m_Closed = false;
+	};
+
+	namespace Detail {
+
+		// Set on pool threads so the batch kernels' ParallelFor runs inline there
+		inline void EnterPoolThread()
+		{
+			InsideParallelJob = true;
+		}
+
+		template <typename T>
+		using sync_result = std::optional<std::conditional_t<std::is_void_v<T>, bool, T>>;
+
+		// The outcome is kept in this frame until it is published under the mutex: SyncWait
+		// may return, destroying everything passed by reference, as soon as it sees done
+		template <typename T>
+		detached SignalWhenDone(task<T>& work, sync_result<T>& result, std::exception_ptr& exception, bool& finished, std::mutex& mutex, std::condition_variable& done)
+		{
+			sync_result<T> value;
+			std::exception_ptr error;
+			try
+			{
+				if constexpr (std::is_void_v<T>)
+				{
+					co_await std::move(work);
+					value.emplace(true);
+				}
+				else
+				{
+					value.emplace(co_await std::move(work));
+				}
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			result = std::move(value);
+			exception = std::move(error);
+			finished = true;
+			done.notify_all();
+		}
+
+	}
+
+	inline thread_pool::thread_pool(size_t threads)
+	{
+		threads = std::max<size_t>(threads, 1);
+		m_Workers.reserve(threads);
+		for (size_t i = 0; i < threads; i++)
+			m_Workers.emplace_back([this]() { Run(); });
+	}
+
+	inline thread_pool::~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Wake.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	inline void thread_pool::Post(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back(std::move(job));
+		}
+		m_Wake.notify_one();
+	}
+
+	inline size_t thread_pool::Size() const
+	{
+		return m_Workers.size();
+	}
+
+	inline auto thread_pool::Schedule()
+	{
+		struct awaiter
+		{
+			thread_pool& Pool;
+
+			bool await_ready() noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> handle) { Pool.Post([handle]() { handle.resume(); }); }
+			void await_resume() noexcept {}
+		};
+		return awaiter{ *this };
+	}
+
+	inline void thread_pool::Run()
+	{
+		Detail::EnterPoolThread();
+
+		for (;;)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Wake.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+				if (m_Jobs.empty())
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+			job();
+		}
+	}
+
+	template <typename T>
+	T SyncWait(task<T> work)
+	{
+		Detail::sync_result<T> result;
+		std::exception_ptr exception;
+		bool finished = false;
+		std::mutex mutex;
+		std::condition_variable done;
+
+		Detail::SignalWhenDone(work, result, exception, finished, mutex, done);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [&]() { return finished; });
+		}
+
+		if (exception)
+			std::rethrow_exception(exception);
+		if constexpr (!std::is_void_v<T>)
+			return std::move(*result);
+	}
+
+	template <typename F>
+	task<> ParallelForAsync(thread_pool& pool, size_t count, size_t minChunk, F func)
+	{
+		if (count == 0)
+			co_return;
+
+		struct awaiter
+		{
+			thread_pool& Pool;
+			size_t Count;
+			size_t ChunkSize;
+			size_t Chunks;
+			F& Func;
+			std::atomic<size_t> Remaining;
+			std::atomic<bool> Failed{ false };
+			std::exception_ptr Error{};	// Written once, by the job that set Failed
+
+			bool await_ready() noexcept { return false; }
+
+			// The job finishing last resumes the coroutine, which destroys this awaiter, and
+			// that can happen before the last Post returns: only locals are used after it
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				thread_pool& pool = Pool;
+				size_t chunks = Chunks;
+				for (size_t chunk = 0; chunk < chunks; chunk++)
+				{
+					pool.Post([this, chunk, handle]()
+					{
+						if (!Failed.load(std::memory_order_relaxed))
+						{
+							try
+							{
+								size_t begin = chunk * ChunkSize;
+								Func(begin, std::min(begin + ChunkSize, Count));
+							}
+							catch (...)
+							{
+								if (!Failed.exchange(true))
+									Error = std::current_exception();
+							}
+						}
+
+						// The release half publishes Error to the job that resumes
+						if (Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+							handle.resume();
+					});
+				}
+			}
+
+			void await_resume()
+			{
+				if (Error)
+					std::rethrow_exception(Error);
+			}
+		};
+
+		size_t chunks = std::min(pool.Size(), (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+		chunks = std::max<size_t>(chunks, 1);
+		size_t chunkSize = (count + chunks - 1) / chunks;
+		chunks = (count + chunkSize - 1) / chunkSize;
+
+		co_await awaiter{ pool, count, chunkSize, chunks, func, chunks };
+	}
+
+	template <typename T>
+	struct bounded_channel<T>::send_awaiter
+	{
+		bounded_channel<T>& Channel;
+		T Value;
+		std::coroutine_handle<> Handle{};
+		bool Sent = false;
+
+		bool await_ready() noexcept { return false; }
+
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			std::unique_lock<std::mutex> lock(Channel.m_Mutex);
+			if (Channel.m_Closed)
+				return false;
+
+			// A waiting receiver means the queue is empty; hand the value over directly
+			if (!Channel.m_Receivers.empty())
+			{
+				receive_awaiter* receiver = Channel.m_Receivers.front();
+				Channel.m_Receivers.pop_front();
+				receiver->Value.emplace(std::move(Value));
+				lock.unlock();
+
+				Sent = true;
+				std::coroutine_handle<> waiting = receiver->Handle;
+				Channel.m_Pool.Post([waiting]() { waiting.resume(); });
+				return false;
+			}
+
+			if (Channel.m_Items.size() < Channel.m_Capacity)
+			{
+				Channel.m_Items.push_back(std::move(Value));
+				Sent = true;
+				return false;
+			}
+
+			// Full: wait for a receiver to take the value. Nothing may touch this awaiter
+			// after the unlock, since the coroutine can be resumed from then on.
+			Handle = handle;
+			Channel.m_Senders.push_back(this);
+			return true;
+		}
+
+		bool await_resume() noexcept { return Sent; }
+	};
+
+	template <typename T>
+	struct bounded_channel<T>::receive_awaiter
+	{
+		bounded_channel<T>& Channel;
+		std::optional<T> Value{};
+		std::coroutine_handle<> Handle{};
+
+		bool await_ready() noexcept { return false; }
+
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			std::unique_lock<std::mutex> lock(Channel.m_Mutex);
+			if (!Channel.m_Items.empty())
+			{
+				Value.emplace(std::move(Channel.m_Items.front()));
+				Channel.m_Items.pop_front();
+
+				// Room again: move the first waiting sender's value into the queue
+				if (!Channel.m_Senders.empty())
+				{
+					send_awaiter* sender = Channel.m_Senders.front();
+					Channel.m_Senders.pop_front();
+					Channel.m_Items.push_back(std::move(sender->Value));
+					sender->Sent = true;
+					lock.unlock();
+
+					std::coroutine_handle<> waiting = sender->Handle;
+					Channel.m_Pool.Post([waiting]() { waiting.resume(); });
+				}
+				return false;
+			}
+
+			if (Channel.m_Closed)
+				return false;
+
+			Handle = handle;
+			Channel.m_Receivers.push_back(this);
+			return true;
+		}
+
+		std::optional<T> await_resume() { return std::move(Value); }
+	};
+
+	template <typename T>
+	bounded_channel<T>::bounded_channel(thread_pool& pool, size_t capacity) : m_Pool(pool), m_Capacity(std::max<size_t>(capacity, 1))
+	{
+
+	}
+
+	template <typename T>
+	auto bounded_channel<T>::Send(T value)
+	{
+		return send_awaiter{ *this, std::move(value) };
+	}
+
+	template <typename T>
+	auto bounded_channel<T>::Receive()
+	{
+		return receive_awaiter{ *this };
+	}
+
+	template <typename T>
+	void bounded_channel<T>::Close()
+	{
+		std::deque<send_awaiter*> senders;
+		std::deque<receive_awaiter*> receivers;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Closed = true;
+			senders.swap(m_Senders);
+			receivers.swap(m_Receivers);
+		}
+
+		for (send_awaiter* sender : senders)
+		{
+			std::coroutine_handle<> waiting = sender->Handle;
+			m_Pool.Post([waiting]() { waiting.resume(); });
+		}
+		for (receive_awaiter* receiver : receivers)
+		{
+			std::coroutine_handle<> waiting = receiver->Handle;
+			m_Pool.Post([waiting]() { waiting.resume(); });
+		}
+	}
+
+}
+
+#endif
\ No newline at end of file
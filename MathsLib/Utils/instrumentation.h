@@ -0,0 +1,304 @@
+#pragma once
+
+// Opt-in call counters and timing for the hot kernels. Define MATHS_INSTRUMENTATION
+// before including the library to enable them; otherwise the macros below expand to
+// nothing and the kernels compile exactly as before.
+//
+//   MATHS_PROFILE_CALL(name)                      counts a scalar call, times one call in SampleInterval
+//   MATHS_PROFILE_KERNEL(name, elements, bytes)   counts a batch call and always times it
+//
+// Counters are kept per thread without locking and are only summed when Aggregate()
+// or WriteChromeTrace() is called. When a thread exits, its slot (counters, events and
+// trace thread id) is handed to the next thread that starts, which keeps adding to the
+// same totals, so memory is bounded by the peak number of live threads.
+
+#ifdef MATHS_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Maths::Instrumentation {
+
+	constexpr size_t MaxKernels = 256;
+	constexpr size_t MaxEventsPerThread = 1 << 16;
+
+	// One in this many scalar calls is timed
+	inline std::atomic<uint32_t> SampleInterval{ 64 };
+
+	struct kernel_stats
+	{
+		std::string Name;
+		uint64_t Calls = 0;
+		uint64_t Elements = 0;
+		uint64_t Bytes = 0;
+		uint64_t TimedCalls = 0;
+		uint64_t TimedNanoseconds = 0;
+
+		// Estimated total time, scaling the timed calls up to all calls
+		double EstimatedMilliseconds() const
+		{
+			return TimedCalls == 0 ? 0.0 : (double(TimedNanoseconds) / double(TimedCalls)) * double(Calls) * 1e-6;
+		}
+	};
+
+	struct trace_event
+	{
+		uint32_t Kernel;
+		uint64_t Start;		// Nanoseconds since the instrumentation epoch
+		uint64_t Duration;
+		uint64_t Elements;
+	};
+
+	namespace Detail {
+
+		// Single writer (the owning thread), so relaxed load + store is enough and
+		// avoids a locked instruction on every call
+		struct counter
+		{
+			std::atomic<uint64_t> Calls{ 0 };
+			std::atomic<uint64_t> Elements{ 0 };
+			std::atomic<uint64_t> Bytes{ 0 };
+			std::atomic<uint64_t> TimedCalls{ 0 };
+			std::atomic<uint64_t> TimedNanoseconds{ 0 };
+			uint32_t SampleCountdown = 0;	// Only touched by the owning thread
+		};
+
+		inline void Bump(std::atomic<uint64_t>& value, uint64_t amount)
+		{
+			value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+
+		struct thread_data
+		{
+			uint32_t ThreadIndex = 0;
+			counter Counters[MaxKernels];
+
+			std::mutex EventMutex;
+			std::vector<trace_event> Events;
+		};
+
+		struct registry
+		{
+			std::mutex Mutex;
+			std::vector<std::string> Names;
+			std::vector<std::unique_ptr<thread_data>> Threads;
+			std::vector<thread_data*> FreeThreads;	// Slots of threads that have exited
+			std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+		};
+
+		inline registry& Registry()
+		{
+			static registry instance;
+			return instance;
+		}
+
+		// Owns the calling thread's slot and returns it to the registry at thread exit. The
+		// registry mutex orders the old thread's last counter writes before the next
+		// owner's first.
+		struct thread_slot
+		{
+			thread_data* Data;
+
+			thread_slot()
+			{
+				registry& reg = Registry();
+				std::lock_guard<std::mutex> lock(reg.Mutex);
+				if (!reg.FreeThreads.empty())
+				{
+					Data = reg.FreeThreads.back();
+					reg.FreeThreads.pop_back();
+				}
+				else
+				{
+					reg.Threads.push_back(std::make_unique<thread_data>());
+					Data = reg.Threads.back().get();
+					Data->ThreadIndex = uint32_t(reg.Threads.size() - 1);
+				}
+			}
+
+			~thread_slot()
+			{
+				registry& reg = Registry();
+				std::lock_guard<std::mutex> lock(reg.Mutex);
+				reg.FreeThreads.push_back(Data);
+			}
+
+			thread_slot(const thread_slot&) = delete;
+			thread_slot& operator = (const thread_slot&) = delete;
+		};
+
+		inline thread_data& ThreadData()
+		{
+			thread_local thread_slot slot;
+			return *slot.Data;
+		}
+
+		inline uint32_t RegisterKernel(const char* name)
+		{
+			registry& reg = Registry();
+			std::lock_guard<std::mutex> lock(reg.Mutex);
+
+			for (size_t i = 0; i < reg.Names.size(); i++)
+				if (reg.Names[i] == name)
+					return uint32_t(i);
+
+			if (reg.Names.size() >= MaxKernels)
+				return uint32_t(MaxKernels - 1);
+
+			reg.Names.push_back(name);
+			return uint32_t(reg.Names.size() - 1);
+		}
+
+		inline uint64_t Now()
+		{
+			return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - Registry().Epoch).count());
+		}
+
+		class scope
+		{
+		public:
+			scope(uint32_t kernel, uint64_t elements, uint64_t bytes, bool batch)
+				: m_Data(ThreadData()), m_Kernel(kernel), m_Elements(elements), m_Batch(batch)
+			{
+				counter& c = m_Data.Counters[kernel];
+				Bump(c.Calls, 1);
+				Bump(c.Elements, elements);
+				Bump(c.Bytes, bytes);
+
+				if (batch || c.SampleCountdown-- == 0)
+				{
+					c.SampleCountdown = SampleInterval.load(std::memory_order_relaxed) - 1;
+					m_Timed = true;
+					m_Start = Now();
+				}
+			}
+
+			~scope()
+			{
+				if (!m_Timed)
+					return;
+
+				uint64_t duration = Now() - m_Start;
+				counter& c = m_Data.Counters[m_Kernel];
+				Bump(c.TimedCalls, 1);
+				Bump(c.TimedNanoseconds, duration);
+
+				if (m_Batch)
+				{
+					std::lock_guard<std::mutex> lock(m_Data.EventMutex);
+					if (m_Data.Events.size() < MaxEventsPerThread)
+						m_Data.Events.push_back({ m_Kernel, m_Start, duration, m_Elements });
+				}
+			}
+
+			scope(const scope&) = delete;
+			scope& operator = (const scope&) = delete;
+
+		private:
+			thread_data& m_Data;
+			uint32_t m_Kernel;
+			uint64_t m_Elements;
+			uint64_t m_Start = 0;
+			bool m_Batch;
+			bool m_Timed = false;
+		};
+
+	}
+
+	// Sums the per-thread counters into one entry per kernel
+	inline std::vector<kernel_stats> Aggregate()
+	{
+		Detail::registry& reg = Detail::Registry();
+		std::lock_guard<std::mutex> lock(reg.Mutex);
+
+		std::vector<kernel_stats> result(reg.Names.size());
+		for (size_t k = 0; k < result.size(); k++)
+		{
+			result[k].Name = reg.Names[k];
+			for (const auto& thread : reg.Threads)
+			{
+				const Detail::counter& c = thread->Counters[k];
+				result[k].Calls += c.Calls.load(std::memory_order_relaxed);
+				result[k].Elements += c.Elements.load(std::memory_order_relaxed);
+				result[k].Bytes += c.Bytes.load(std::memory_order_relaxed);
+				result[k].TimedCalls += c.TimedCalls.load(std::memory_order_relaxed);
+				result[k].TimedNanoseconds += c.TimedNanoseconds.load(std::memory_order_relaxed);
+			}
+		}
+		return result;
+	}
+
+	// Zeroes every counter and drops the recorded trace events, e.g. at the start of a frame.
+	// Only call this while no instrumented kernel is running.
+	inline void Reset()
+	{
+		Detail::registry& reg = Detail::Registry();
+		std::lock_guard<std::mutex> lock(reg.Mutex);
+
+		for (const auto& thread : reg.Threads)
+		{
+			for (Detail::counter& c : thread->Counters)
+			{
+				c.Calls.store(0, std::memory_order_relaxed);
+				c.Elements.store(0, std::memory_order_relaxed);
+				c.Bytes.store(0, std::memory_order_relaxed);
+				c.TimedCalls.store(0, std::memory_order_relaxed);
+				c.TimedNanoseconds.store(0, std::memory_order_relaxed);
+			}
+
+			std::lock_guard<std::mutex> eventLock(thread->EventMutex);
+			thread->Events.clear();
+		}
+	}
+
+	// Writes the batch kernel calls as complete ("X") events in the Chrome trace event
+	// format, which chrome://tracing and Perfetto both load
+	inline void WriteChromeTrace(std::ostream& os)
+	{
+		Detail::registry& reg = Detail::Registry();
+		std::lock_guard<std::mutex> lock(reg.Mutex);
+
+		os << "{\"traceEvents\":[";
+		bool first = true;
+		for (const auto& thread : reg.Threads)
+		{
+			std::lock_guard<std::mutex> eventLock(thread->EventMutex);
+			for (const trace_event& event : thread->Events)
+			{
+				os << (first ? "\n" : ",\n");
+				first = false;
+				os << "{\"name\":\"" << reg.Names[event.Kernel] << "\",\"cat\":\"maths\",\"ph\":\"X\""
+					<< ",\"ts\":" << double(event.Start) * 1e-3
+					<< ",\"dur\":" << double(event.Duration) * 1e-3
+					<< ",\"pid\":0,\"tid\":" << thread->ThreadIndex
+					<< ",\"args\":{\"elements\":" << event.Elements << "}}";
+			}
+		}
+		os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+	}
+
+}
+
+#define MATHS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MATHS_PROFILE_CONCAT(a, b) MATHS_PROFILE_CONCAT_IMPL(a, b)
+
+#define MATHS_PROFILE_SCOPE(name, elements, bytes, batch) \
+	static const uint32_t MATHS_PROFILE_CONCAT(mathsKernel, __LINE__) = ::Maths::Instrumentation::Detail::RegisterKernel(name); \
+	::Maths::Instrumentation::Detail::scope MATHS_PROFILE_CONCAT(mathsScope, __LINE__)(MATHS_PROFILE_CONCAT(mathsKernel, __LINE__), uint64_t(elements), uint64_t(bytes), batch)
+
+#define MATHS_PROFILE_CALL(name) MATHS_PROFILE_SCOPE(name, 1, 0, false)
+#define MATHS_PROFILE_KERNEL(name, elements, bytes) MATHS_PROFILE_SCOPE(name, elements, bytes, true)
+
+#else
+
+#define MATHS_PROFILE_CALL(name)
+#define MATHS_PROFILE_KERNEL(name, elements, bytes)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "scalar.h"
+#include "simd.h"
+
+namespace Maths::Utils {
+
+	// Building blocks for kernels that are written once over a lane type L and have no
+	// data-dependent branches: L is either the scalar itself, where masks are bool, or
+	// lanes4, four floats in an SSE register with all-ones lanes as the mask. Batch
+	// kernels run four items per lanes4 and the remainder as scalars, and since every
+	// lane performs the scalar operations the results are bit-identical.
+
+	template <typename T>
+	bool Less(T lhs, T rhs)
+	{
+		return lhs < rhs;
+	}
+
+	template <typename T>
+	bool LessEqual(T lhs, T rhs)
+	{
+		return lhs <= rhs;
+	}
+
+	template <typename T>
+	bool Equal(T lhs, T rhs)
+	{
+		return lhs == rhs;
+	}
+
+	inline bool And(bool lhs, bool rhs)
+	{
+		return lhs && rhs;
+	}
+
+	template <typename T>
+	T Select(bool condition, T ifTrue, T ifFalse)
+	{
+		return condition ? ifTrue : ifFalse;
+	}
+
+	// Bit k set when lane k of the mask is, to branch on the lanes that passed a test
+	inline int Bits(bool mask)
+	{
+		return mask ? 1 : 0;
+	}
+
+#ifdef MATHS_SSE
+	struct lanes4
+	{
+		__m128 Value;
+
+		lanes4() = default;
+		lanes4(__m128 value) : Value(value) {}
+		lanes4(float value) : Value(_mm_set1_ps(value)) {}
+
+		friend lanes4 operator + (lanes4 lhs, lanes4 rhs) { return _mm_add_ps(lhs.Value, rhs.Value); }
+		friend lanes4 operator - (lanes4 lhs, lanes4 rhs) { return _mm_sub_ps(lhs.Value, rhs.Value); }
+		friend lanes4 operator * (lanes4 lhs, lanes4 rhs) { return _mm_mul_ps(lhs.Value, rhs.Value); }
+		friend lanes4 operator / (lanes4 lhs, lanes4 rhs) { return _mm_div_ps(lhs.Value, rhs.Value); }
+
+		// Flips the sign bit, so -0 comes out as for scalars
+		friend lanes4 operator - (lanes4 value) { return _mm_xor_ps(value.Value, _mm_set1_ps(-0.0f)); }
+	};
+
+	inline lanes4 Less(lanes4 lhs, lanes4 rhs)
+	{
+		return _mm_cmplt_ps(lhs.Value, rhs.Value);
+	}
+
+	inline lanes4 LessEqual(lanes4 lhs, lanes4 rhs)
+	{
+		return _mm_cmple_ps(lhs.Value, rhs.Value);
+	}
+
+	inline lanes4 Equal(lanes4 lhs, lanes4 rhs)
+	{
+		return _mm_cmpeq_ps(lhs.Value, rhs.Value);
+	}
+
+	inline lanes4 And(lanes4 lhs, lanes4 rhs)
+	{
+		return _mm_and_ps(lhs.Value, rhs.Value);
+	}
+
+	inline lanes4 Select(lanes4 condition, lanes4 ifTrue, lanes4 ifFalse)
+	{
+		return _mm_or_ps(_mm_and_ps(condition.Value, ifTrue.Value), _mm_andnot_ps(condition.Value, ifFalse.Value));
+	}
+
+	inline int Bits(lanes4 mask)
+	{
+		return _mm_movemask_ps(mask.Value);
+	}
+
+	inline lanes4 Sqrt(lanes4 value)
+	{
+		return _mm_sqrt_ps(value.Value);
+	}
+
+	// Lane k of each of the four pointers, for loading a field of four items
+	inline lanes4 Gather(const float* p0, const float* p1, const float* p2, const float* p3)
+	{
+		return _mm_setr_ps(*p0, *p1, *p2, *p3);
+	}
+
+	inline void Scatter(lanes4 value, float* p0, float* p1, float* p2, float* p3)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, value.Value);
+		*p0 = lanes[0];
+		*p1 = lanes[1];
+		*p2 = lanes[2];
+		*p3 = lanes[3];
+	}
+#endif
+
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Maths::Utils {
+
+	// Caps the threads the batch kernels use; 0 uses every hardware thread
+	inline std::atomic<size_t> MaxThreads{ 0 };
+
+	// Number of worker threads used by the batch kernels
+	inline size_t ThreadCount()
+	{
+		size_t limit = MaxThreads.load(std::memory_order_relaxed);
+		if (limit != 0)
+			return limit;
+
+		size_t count = std::thread::hardware_concurrency();
+		return count == 0 ? 1 : count;
+	}
+
+	namespace Detail {
+
+		// Set on threads that already belong to a pool of workers (see thread_pool), where
+		// ParallelFor runs inline rather than oversubscribing the cores
+		inline thread_local bool InsideParallelJob = false;
+
+		// One ParallelFor call. Whoever is free claims the next range, the caller included,
+		// so a call never waits on workers busy with other calls. Shared with the posted
+		// helpers, which may only get to run after the call has returned.
+		struct parallel_job
+		{
+			void (*Call)(void* func, size_t begin, size_t end);
+			void* Func;
+			size_t Count;
+			size_t ChunkSize;
+			size_t Chunks;
+
+			std::atomic<size_t> Next{ 0 };
+			std::atomic<size_t> Remaining{ 0 };
+			std::atomic<bool> Failed{ false };
+			std::exception_ptr Error;		// First exception thrown, written under Mutex
+			bool Done = false;
+			std::mutex Mutex;
+			std::condition_variable Finished;
+
+			// Claims and runs ranges until none are left. After a range throws, the ranges
+			// not yet started are skipped.
+			void Work()
+			{
+				for (size_t chunk = Next.fetch_add(1); chunk < Chunks; chunk = Next.fetch_add(1))
+				{
+					if (!Failed.load(std::memory_order_relaxed))
+					{
+						try
+						{
+							size_t begin = chunk * ChunkSize;
+							Call(Func, begin, std::min(begin + ChunkSize, Count));
+						}
+						catch (...)
+						{
+							std::lock_guard<std::mutex> lock(Mutex);
+							if (!Error)
+								Error = std::current_exception();
+							Failed.store(true, std::memory_order_relaxed);
+						}
+					}
+
+					if (Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						std::lock_guard<std::mutex> lock(Mutex);
+						Done = true;
+						Finished.notify_all();
+					}
+				}
+			}
+		};
+
+		// Threads kept alive for ParallelFor between calls, started on first use and grown
+		// when ThreadCount() goes up. Jobs are only ever helpers of a caller that is itself
+		// working on the same ranges, so a busy pool delays nothing but the speedup. The
+		// pool is never destroyed: idle workers just end with the process, which keeps
+		// their thread exit from running after other statics (the instrumentation
+		// registry) are gone.
+		class worker_pool
+		{
+		public:
+			void Post(const std::shared_ptr<parallel_job>& job, size_t helpers)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					while (m_Workers.size() < helpers)
+						m_Workers.emplace_back([this]() { Run(); });
+					for (size_t i = 0; i < helpers; i++)
+						m_Jobs.push_back(job);
+				}
+
+				if (helpers == 1)
+					m_Wake.notify_one();
+				else
+					m_Wake.notify_all();
+			}
+
+		private:
+			void Run()
+			{
+				InsideParallelJob = true;
+
+				for (;;)
+				{
+					std::shared_ptr<parallel_job> job;
+					{
+						std::unique_lock<std::mutex> lock(m_Mutex);
+						m_Wake.wait(lock, [this]() { return !m_Jobs.empty(); });
+						job = std::move(m_Jobs.front());
+						m_Jobs.pop_front();
+					}
+					job->Work();
+				}
+			}
+
+			std::vector<std::thread> m_Workers;
+			std::deque<std::shared_ptr<parallel_job>> m_Jobs;
+			std::mutex m_Mutex;
+			std::condition_variable m_Wake;
+		};
+
+		inline worker_pool& Workers()
+		{
+			static worker_pool* instance = new worker_pool;
+			return *instance;
+		}
+
+	}
+
+	// Splits [0, count) into contiguous ranges of at least minChunk elements, at most one
+	// per thread, and calls func(begin, end) for each range. The ranges run on the calling
+	// thread and on a persistent pool of workers, so a call costs a wake-up rather than
+	// thread creation, and everything runs inline when called from a pool worker. If func
+	// throws, ranges not yet started are skipped and the first exception is rethrown on
+	// the calling thread once every running range has finished.
+	template <typename F>
+	void ParallelFor(size_t count, size_t minChunk, F&& func)
+	{
+		if (count == 0)
+			return;
+
+		size_t chunks = std::min(ThreadCount(), (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+		if (chunks <= 1 || Detail::InsideParallelJob)
+		{
+			func(size_t(0), count);
+			return;
+		}
+
+		using function = std::remove_reference_t<F>;
+		std::shared_ptr<Detail::parallel_job> job = std::make_shared<Detail::parallel_job>();
+		job->Call = [](void* f, size_t begin, size_t end) { (*static_cast<function*>(f))(begin, end); };
+		job->Func = const_cast<void*>(static_cast<const void*>(std::addressof(func)));
+		job->Count = count;
+		job->ChunkSize = (count + chunks - 1) / chunks;
+		job->Chunks = (count + job->ChunkSize - 1) / job->ChunkSize;
+		job->Remaining.store(job->Chunks, std::memory_order_relaxed);
+
+		Detail::Workers().Post(job, job->Chunks - 1);
+		job->Work();
+
+		{
+			std::unique_lock<std::mutex> lock(job->Mutex);
+			job->Finished.wait(lock, [&]() { return job->Done; });
+		}
+
+		if (job->Error)
+			std::rethrow_exception(job->Error);
+	}
+
+	// Reduces [0, count) in contiguous ranges: each range is mapped with func(begin, end)
+	// on its own thread, then the partial results are combined in range order so the
+	// result only depends on the number of threads, not on scheduling.
+	template <typename R, typename F, typename Combine>
+	R ParallelReduce(size_t count, size_t minChunk, R identity, F&& func, Combine&& combine)
+	{
+		if (count == 0)
+			return identity;
+
+#ifdef MATHS_DETERMINISTIC
+		// Fixed size ranges, so the partial results and the rounding of their combination
+		// do not depend on the machine's thread count
+		size_t chunkSize = std::max<size_t>(minChunk, 1);
+		size_t chunks = (count + chunkSize - 1) / chunkSize;
+		if (chunks <= 1)
+			return combine(identity, func(size_t(0), count));
+#else
+		size_t chunks = std::min(ThreadCount(), (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+		if (chunks <= 1)
+			return combine(identity, func(size_t(0), count));
+
+		size_t chunkSize = (count + chunks - 1) / chunks;
+		chunks = (count + chunkSize - 1) / chunkSize;
+#endif
+
+		std::vector<R> partials(chunks, identity);
+		ParallelFor(chunks, 1, [&](size_t first, size_t last)
+		{
+			for (size_t chunk = first; chunk < last; chunk++)
+			{
+				size_t begin = chunk * chunkSize;
+				partials[chunk] = func(begin, std::min(begin + chunkSize, count));
+			}
+		});
+
+		R result = identity;
+		for (const R& partial : partials)
+			result = combine(result, partial);
+		return result;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "instrumentation.h"
+#include "parallel.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Scalar functions used by the containers. By default they forward to the standard
+// library (or to overloads found by argument-dependent lookup for custom scalar types).
+//
+// Define MATHS_DETERMINISTIC before including the library to get bitwise identical
+// results across machines and standard libraries, e.g. for lockstep simulation:
+//   - sin, cos, tan and acos of float and double use the software implementations below,
+//     evaluated in double with a fixed operation order
+//   - ParallelReduce splits work into fixed size ranges instead of one per thread
+// sqrt is left to the hardware: IEEE 754 requires it to be correctly rounded.
+//   - sin and cos of infinities, NaN and |x| beyond about 3.5e15, where the argument
+//     reduction below no longer has an integer quadrant, are NaN
+// The build must keep the compiler from fusing a * b + c into an FMA and from reordering
+// floating point operations: compile with -ffp-contract=off on GCC and Clang (both
+// contract by default when FMA is available) and without -ffast-math (/fp:fast on
+// MSVC). The MATHS_DETERMINISTIC CMake option sets both the define and the flags on the
+// Maths target. The SSE kernels already accumulate in the same order as the scalar ones.
+#if defined(MATHS_DETERMINISTIC) && defined(__FAST_MATH__)
+	#error "MATHS_DETERMINISTIC cannot be used with -ffast-math"
+#endif
+
+namespace Maths::Utils {
+
+	namespace Detail {
+
+#ifdef MATHS_DETERMINISTIC
+		inline constexpr bool Deterministic = true;
+#else
+		inline constexpr bool Deterministic = false;
+#endif
+
+		template <typename T>
+		inline constexpr bool UseSoftwareMaths = Deterministic && (std::is_same_v<T, float> || std::is_same_v<T, double>);
+
+		// Reduces x to r in [-pi/4, pi/4] with x = r + quadrant * pi/2. pi/2 is split in
+		// three parts (Cody-Waite): the result is float accurate while the first part times
+		// the quadrant is exact (|x| up to about 1e6) and within float precision in absolute
+		// terms up to about 1e9. Beyond 2^51 quarter turns (and for infinities and NaN)
+		// there is no defined quadrant: r is NaN and quadrant 0 on every machine, rather
+		// than whatever the float to integer conversion gives.
+		inline double ReduceHalfPi(double x, int64_t& quadrant)
+		{
+			constexpr double Limit = 2251799813685248.0;	// 2^51
+
+			// Selects rather than an early return, so the batch loop still vectorises
+			double k = x * 6.36619772367581382433e-01;
+			bool inRange = k > -Limit && k < Limit;
+			k = inRange ? k : 0.0;
+
+			// Adding and removing 1.5 * 2^52 rounds to the nearest integer without libm
+			k = (k + 6755399441055744.0) - 6755399441055744.0;
+			quadrant = int64_t(k);
+
+			double r = x - k * 1.57079632673412561417e+00;
+			r = r - k * 6.07710050630396597660e-11;
+			r = r - k * 2.02226624879595063154e-21;
+			return inRange ? r : std::numeric_limits<double>::quiet_NaN();
+		}
+
+		// Minimax polynomials on [-pi/4, pi/4] (coefficients from fdlibm)
+		inline double KernelSin(double r)
+		{
+			double z = r * r;
+			double p = 1.58969099521155010221e-10;
+			p = p * z - 2.50507602534068634195e-08;
+			p = p * z + 2.75573137070700676789e-06;
+			p = p * z - 1.98412698298579493134e-04;
+			p = p * z + 8.33333333332248946124e-03;
+			p = p * z - 1.66666666666666324348e-01;
+			return r + r * z * p;
+		}
+
+		inline double KernelCos(double r)
+		{
+			double z = r * r;
+			double p = -1.13596475577881948265e-11;
+			p = p * z + 2.08757232129817482790e-09;
+			p = p * z - 2.75573143513906633035e-07;
+			p = p * z + 2.48015872894767294178e-05;
+			p = p * z - 1.38888888888741095749e-03;
+			p = p * z + 4.16666666666666019037e-02;
+			return (1.0 - 0.5 * z) + z * z * p;
+		}
+
+		inline void SinCos(double x, double& s, double& c)
+		{
+			int64_t quadrant;
+			double r = ReduceHalfPi(x, quadrant);
+			double sr = KernelSin(r);
+			double cr = KernelCos(r);
+
+			// Rotate by the quadrant: (sin, cos) -> (cos, -sin) -> (-sin, -cos) -> (-cos, sin)
+			bool swap = (quadrant & 1) != 0;
+			s = swap ? cr : sr;
+			c = swap ? sr : cr;
+			s = (quadrant & 2) ? -s : s;
+			c = ((quadrant + 1) & 2) ? -c : c;
+		}
+
+		// asin for |x| <= 0.5 as x + x * R(x^2) (rational approximation from fdlibm)
+		inline double KernelAsin(double x)
+		{
+			double z = x * x;
+			double p = 3.47933107596021167570e-05;
+			p = p * z + 7.91534994289814532176e-04;
+			p = p * z - 4.00555345006794114027e-02;
+			p = p * z + 2.01212532134862925881e-01;
+			p = p * z - 3.25565818622400915405e-01;
+			p = p * z + 1.66666666666666657415e-01;
+			double q = 7.70381505559019352791e-02;
+			q = q * z - 6.88283971605453293030e-01;
+			q = q * z + 2.02094576023350569471e+00;
+			q = q * z - 2.40339491173441421878e+00;
+			q = q * z + 1.0;
+			return x + x * (z * p / q);
+		}
+
+		inline double Acos(double x)
+		{
+			constexpr double HalfPi = 1.57079632679489655800e+00;
+			constexpr double Pi = 3.14159265358979311600e+00;
+
+			if (x > 0.5)
+				return 2.0 * KernelAsin(std::sqrt((1.0 - x) * 0.5));
+			if (x < -0.5)
+				return Pi - 2.0 * KernelAsin(std::sqrt((1.0 + x) * 0.5));
+			return HalfPi - KernelAsin(x);
+		}
+
+	}
+
+	// Degrees to radians. Fixed point and other non floating point types divide by the
+	// larger constant, which keeps more of its significant bits.
+	template <typename T>
+	T Radians(T degrees)
+	{
+		if constexpr (std::is_floating_point_v<T>)
+			return degrees * T(0.0174533f);
+		else
+			return degrees / T(57.2957795f);
+	}
+
+	template <typename T>
+	T Sqrt(T x)
+	{
+		using std::sqrt;
+		return sqrt(x);
+	}
+
+	template <typename T>
+	T Sin(T x)
+	{
+		if constexpr (Detail::UseSoftwareMaths<T>)
+		{
+			double s, c;
+			Detail::SinCos(double(x), s, c);
+			return T(s);
+		}
+		else
+		{
+			using std::sin;
+			return sin(x);
+		}
+	}
+
+	template <typename T>
+	T Cos(T x)
+	{
+		if constexpr (Detail::UseSoftwareMaths<T>)
+		{
+			double s, c;
+			Detail::SinCos(double(x), s, c);
+			return T(c);
+		}
+		else
+		{
+			using std::cos;
+			return cos(x);
+		}
+	}
+
+	template <typename T>
+	T Tan(T x)
+	{
+		if constexpr (Detail::UseSoftwareMaths<T>)
+		{
+			double s, c;
+			Detail::SinCos(double(x), s, c);
+			return T(s / c);
+		}
+		else
+		{
+			using std::tan;
+			return tan(x);
+		}
+	}
+
+	// Expects x in [-1, 1]
+	template <typename T>
+	T Acos(T x)
+	{
+		if constexpr (Detail::UseSoftwareMaths<T>)
+		{
+			return T(Detail::Acos(double(x)));
+		}
+		else
+		{
+			using std::acos;
+			return acos(x);
+		}
+	}
+
+	// Batch sine and cosine. In deterministic mode the loop body only uses selects, so
+	// the compiler can vectorise it.
+	template <typename T>
+	void SinCos(const T* angles, T* sines, T* cosines, size_t count)
+	{
+		MATHS_PROFILE_KERNEL("SinCos", count, count * 3 * sizeof(T));
+
+		ParallelFor(count, 1 << 14, [=](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				if constexpr (Detail::UseSoftwareMaths<T>)
+				{
+					double s, c;
+					Detail::SinCos(double(angles[i]), s, c);
+					sines[i] = T(s);
+					cosines[i] = T(c);
+				}
+				else
+				{
+					sines[i] = Sin(angles[i]);
+					cosines[i] = Cos(angles[i]);
+				}
+			}
+		});
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+// MATHS_SSE is defined when SSE intrinsics can be used for the float specialisations.
+// Define MATHS_DISABLE_SIMD before including the library to force the scalar kernels.
+#if !defined(MATHS_DISABLE_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#define MATHS_SSE 1
+	#include <xmmintrin.h>
+#endif
+
+// MATHS_SSE2 is defined when the SSE2 integer instructions can be used as well
+#if defined(MATHS_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define MATHS_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+// MATHS_SSE41 is defined when SSE4.1 is available, for the integer kernels that need signed
+// 32 to 64 bit multiplies and blends
+#if !defined(MATHS_DISABLE_SIMD) && defined(__SSE4_1__)
+	#define MATHS_SSE41 1
+	#include <smmintrin.h>
+#endif
+
+// MATHS_BMI2 is defined when the BMI2 bit deposit/extract instructions are available.
+// They are scalar instructions, but MATHS_DISABLE_SIMD turns them off too so that the
+// scalar backend runs the portable code.
+#if !defined(MATHS_DISABLE_SIMD) && defined(__BMI2__)
+	#define MATHS_BMI2 1
+	#include <immintrin.h>
+#endif
\ No newline at end of file
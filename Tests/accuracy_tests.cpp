@@ -0,0 +1,697 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// Fast paths against the same formulas evaluated in long double. Results built from
+// cancelling terms (dot products, cofactors) are measured in ULPs of the terms' magnitude,
+// since their error relative to a near-zero result is unbounded.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Tests;
+using Utils::UlpError;
+using Utils::ulp_stats;
+
+using real = long double;
+
+namespace {
+
+	constexpr size_t Count = 1 << 16;
+
+	vec3<float> RandomVec3(float min, float max)
+	{
+		return vec3<float>(Uniform(min, max), Uniform(min, max), Uniform(min, max));
+	}
+
+	vec4<float> RandomVec4(float min, float max)
+	{
+		return vec4<float>(Uniform(min, max), Uniform(min, max), Uniform(min, max), Uniform(min, max));
+	}
+
+	quat<float> RandomRotation()
+	{
+		return quat<float>::Rotation(Uniform(-180.0f, 180.0f), RandomVec3(-1.0f, 1.0f) + vec3<float>(0.0f, 0.0f, 1e-3f));
+	}
+
+	template <size_t C, size_t R>
+	mat<C, R, float> RandomMat(float min, float max)
+	{
+		mat<C, R, float> result;
+		for (float& element : result.Elements)
+			element = Uniform(min, max);
+		return result;
+	}
+
+	// Rotation times a scale in [0.5, 2] per axis, so the condition number is at most 4
+	mat4<float> RandomTRS()
+	{
+		vec3<float> scale(Uniform(0.5f, 2.0f), Uniform(0.5f, 2.0f), Uniform(0.5f, 2.0f));
+		mat4<float> result = quat<float>::ToMatrix(RandomRotation());
+		result.Cols[0] *= scale.X;
+		result.Cols[1] *= scale.Y;
+		result.Cols[2] *= scale.Z;
+		result.Cols[3] = vec4<float>(RandomVec3(-10.0f, 10.0f), 1.0f);
+		return result;
+	}
+
+	template <size_t N>
+	vec<N, real> Widen(const vec<N, float>& value)
+	{
+		vec<N, real> result;
+		for (size_t i = 0; i < N; i++)
+			result[i] = real(value[i]);
+		return result;
+	}
+
+	template <size_t C, size_t R>
+	mat<C, R, real> Widen(const mat<C, R, float>& matrix)
+	{
+		mat<C, R, real> result;
+		for (size_t i = 0; i < C * R; i++)
+			result.Elements[i] = real(matrix.Elements[i]);
+		return result;
+	}
+
+	quat<real> Widen(const quat<float>& rotation)
+	{
+		return quat<real>(rotation.X, rotation.Y, rotation.Z, rotation.W);
+	}
+
+	// Every component of a float result against the long double one, in ULPs of scale
+	template <size_t N>
+	void Accumulate(ulp_stats& stats, const float* computed, const real* reference, real scale, size_t index)
+	{
+		for (size_t i = 0; i < N; i++)
+			stats.Add(UlpError(computed[i], reference[i], scale), index);
+	}
+
+	// Adversarial vectors: every component drawn from the adversarial magnitudes
+	std::vector<vec3<float>> AdversarialVec3s()
+	{
+		std::vector<float> values = Utils::AdversarialValues<float>();
+		std::vector<vec3<float>> result;
+		for (float x : values)
+			for (size_t k = 0; k < 8; k++)
+				result.emplace_back(x, values[Random()() % values.size()], values[Random()() % values.size()]);
+		return result;
+	}
+
+}
+
+MATHS_TEST(VecNormalise)
+{
+	std::vector<vec3<float>> inputs(Count);
+	for (vec3<float>& v : inputs)
+		v = RandomVec3(-100.0f, 100.0f);
+
+	auto measure = [](const std::vector<vec3<float>>& values)
+	{
+		std::vector<vec3<float>> outputs(values.size());
+		for (size_t i = 0; i < values.size(); i++)
+			outputs[i] = values[i].Normalise();
+
+		ulp_stats stats;
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			vec3<real> v = Widen(values[i]);
+			real length = std::sqrt(v.X * v.X + v.Y * v.Y + v.Z * v.Z);
+			real reference[3] = { v.X / length, v.Y / length, v.Z / length };
+			for (int c = 0; c < 3; c++)
+				stats.Add(UlpError(outputs[i][c], reference[c]), i);
+		}
+		return stats;
+	};
+
+	ReportAccuracy("vec::Normalise", "random", measure(inputs), 4);
+
+	// Squared lengths of subnormal vectors underflow and of huge ones overflow
+	ReportAccuracy("vec::Normalise", "adversarial", measure(AdversarialVec3s()), ReportOnly);
+}
+
+MATHS_TEST(VecDotCross)
+{
+	std::vector<vec3<float>> lhs(Count), rhs(Count), cross(Count);
+	std::vector<float> dot(Count);
+	for (size_t i = 0; i < Count; i++)
+	{
+		lhs[i] = RandomVec3(-10.0f, 10.0f);
+		rhs[i] = RandomVec3(-10.0f, 10.0f);
+	}
+
+	{
+		MATHS_PROFILE_KERNEL("vec3::Dot", Count, Count * (2 * sizeof(vec3<float>) + sizeof(float)));
+		for (size_t i = 0; i < Count; i++)
+			dot[i] = vec3<float>::Dot(lhs[i], rhs[i]);
+	}
+	{
+		MATHS_PROFILE_KERNEL("vec3::Cross", Count, Count * 3 * sizeof(vec3<float>));
+		for (size_t i = 0; i < Count; i++)
+			cross[i] = vec3<float>::Cross(lhs[i], rhs[i]);
+	}
+
+	ulp_stats dotStats, crossStats;
+	for (size_t i = 0; i < Count; i++)
+	{
+		vec3<real> a = Widen(lhs[i]), b = Widen(rhs[i]);
+
+		real terms = std::fabs(a.X * b.X) + std::fabs(a.Y * b.Y) + std::fabs(a.Z * b.Z);
+		dotStats.Add(UlpError(dot[i], a.X * b.X + a.Y * b.Y + a.Z * b.Z, terms), i);
+
+		crossStats.Add(UlpError(cross[i].X, a.Y * b.Z - a.Z * b.Y, std::fabs(a.Y * b.Z) + std::fabs(a.Z * b.Y)), i);
+		crossStats.Add(UlpError(cross[i].Y, a.Z * b.X - a.X * b.Z, std::fabs(a.Z * b.X) + std::fabs(a.X * b.Z)), i);
+		crossStats.Add(UlpError(cross[i].Z, a.X * b.Y - a.Y * b.X, std::fabs(a.X * b.Y) + std::fabs(a.Y * b.X)), i);
+	}
+
+	ReportAccuracy("vec3::Dot", "random", dotStats, 3);
+	ReportAccuracy("vec3::Cross", "random", crossStats, 2);
+}
+
+MATHS_TEST(MatMultiply)
+{
+	constexpr size_t MatrixCount = Count / 4;
+
+	std::vector<mat4<float>> lhs(MatrixCount), rhs(MatrixCount), products(MatrixCount);
+	std::vector<vec4<float>> vectors(MatrixCount), transformed(MatrixCount);
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		lhs[i] = RandomMat<4, 4>(-10.0f, 10.0f);
+		rhs[i] = RandomMat<4, 4>(-10.0f, 10.0f);
+		vectors[i] = RandomVec4(-10.0f, 10.0f);
+	}
+
+	for (size_t i = 0; i < MatrixCount; i++)
+		products[i] = lhs[i] * rhs[i];
+	{
+		MATHS_PROFILE_KERNEL("mat4 * vec4", MatrixCount, MatrixCount * (sizeof(mat4<float>) + 2 * sizeof(vec4<float>)));
+		for (size_t i = 0; i < MatrixCount; i++)
+			transformed[i] = lhs[i] * vectors[i];
+	}
+
+	ulp_stats matrixStats, vectorStats;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		mat4<real> a = Widen(lhs[i]), b = Widen(rhs[i]);
+		vec4<real> v = Widen(vectors[i]);
+
+		for (int row = 0; row < 4; row++)
+		{
+			for (int col = 0; col < 4; col++)
+			{
+				real sum = 0, terms = 0;
+				for (int k = 0; k < 4; k++)
+				{
+					real term = a.Elements[k * 4 + row] * b.Elements[col * 4 + k];
+					sum += term;
+					terms += std::fabs(term);
+				}
+				matrixStats.Add(UlpError(products[i].Elements[col * 4 + row], sum, terms), i);
+			}
+
+			real sum = 0, terms = 0;
+			for (int k = 0; k < 4; k++)
+			{
+				real term = a.Elements[k * 4 + row] * v[k];
+				sum += term;
+				terms += std::fabs(term);
+			}
+			vectorStats.Add(UlpError(transformed[i][row], sum, terms), i);
+		}
+	}
+
+	ReportAccuracy("mat::Multiply", "random", matrixStats, 4);
+	ReportAccuracy("mat4 * vec4", "random", vectorStats, 4);
+}
+
+MATHS_TEST(MatInverse)
+{
+	constexpr size_t MatrixCount = Count / 4;
+
+	// Well conditioned: errors in ULPs of the largest element of the inverse
+	ulp_stats inverse3, inverse4;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		mat4<float> matrix = RandomTRS();
+		mat3<float> linear(matrix);
+
+		mat4<float> computed4 = mat4<float>::Inverse(matrix);
+		mat3<float> computed3 = mat3<float>::Inverse(linear);
+		mat4<real> reference4 = mat4<real>::Inverse(Widen(matrix));
+		mat3<real> reference3 = mat3<real>::Inverse(Widen(linear));
+
+		real scale4 = 0, scale3 = 0;
+		for (real element : reference4.Elements)
+			scale4 = std::fmax(scale4, std::fabs(element));
+		for (real element : reference3.Elements)
+			scale3 = std::fmax(scale3, std::fabs(element));
+
+		Accumulate<16>(inverse4, computed4.Elements, reference4.Elements, scale4, i);
+		Accumulate<9>(inverse3, computed3.Elements, reference3.Elements, scale3, i);
+	}
+	ReportAccuracy("mat::Inverse", "mat3 cond<=4", inverse3, 8);
+	ReportAccuracy("mat::Inverse", "mat4 cond<=4", inverse4, 12);
+
+	// Near singular mat3: the third column is a combination of the first two plus a small
+	// perturbation. The error grows with the condition number, so only the residual is
+	// checked: |A * inverse(A) - I| within a small multiple of cond(A) * epsilon.
+	ulp_stats nearSingular;
+	size_t residualFailures = 0;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		float perturbation = std::ldexp(1.0f, -int(4 + i % 16));
+		vec3<float> c0 = RandomVec3(-1.0f, 1.0f), c1 = RandomVec3(-1.0f, 1.0f);
+		vec3<float> c2 = c0 * Uniform(-1.0f, 1.0f) + c1 * Uniform(-1.0f, 1.0f) + RandomVec3(-1.0f, 1.0f) * perturbation;
+		mat3<float> matrix(c0, c1, c2);
+
+		mat3<float> computed = mat3<float>::Inverse(matrix);
+		mat3<real> wide = Widen(matrix);
+		mat3<real> reference = mat3<real>::Inverse(wide);
+
+		real norm = 0, inverseNorm = 0;
+		for (int e = 0; e < 9; e++)
+		{
+			norm = std::fmax(norm, std::fabs(wide.Elements[e]));
+			inverseNorm = std::fmax(inverseNorm, std::fabs(reference.Elements[e]));
+		}
+		Accumulate<9>(nearSingular, computed.Elements, reference.Elements, inverseNorm, i);
+
+		mat3<real> product = wide * Widen(computed);
+		real residual = 0;
+		for (int col = 0; col < 3; col++)
+			for (int row = 0; row < 3; row++)
+				residual = std::fmax(residual, std::fabs(product.Elements[col * 3 + row] - (row == col ? 1 : 0)));
+
+		real condition = 9 * norm * inverseNorm;
+		if (!(residual <= 64 * condition * std::numeric_limits<float>::epsilon()))
+			residualFailures++;
+	}
+	ReportAccuracy("mat::Inverse", "mat3 singular", nearSingular, ReportOnly);
+	MATHS_CHECK(residualFailures == 0);
+}
+
+MATHS_TEST(LookAt)
+{
+	constexpr size_t MatrixCount = Count / 4;
+
+	std::vector<vec3<float>> positions(MatrixCount), centres(MatrixCount);
+	std::vector<mat4<float>> views(MatrixCount);
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		positions[i] = RandomVec3(-100.0f, 100.0f);
+		centres[i] = RandomVec3(-100.0f, 100.0f);
+	}
+
+	{
+		MATHS_PROFILE_KERNEL("mat4::LookAt", MatrixCount, MatrixCount * (2 * sizeof(vec3<float>) + sizeof(mat4<float>)));
+		for (size_t i = 0; i < MatrixCount; i++)
+			views[i] = mat4<float>::LookAt(positions[i], centres[i]);
+	}
+
+	// Rotation rows are unit length, so their error is in ULPs of 1; the translation
+	// column in ULPs of the distance from the origin
+	ulp_stats stats;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		vec3<real> position = Widen(positions[i]);
+		mat4<real> reference = mat4<real>::LookAt(position, Widen(centres[i]));
+		real distance = std::sqrt(real(vec3<real>::Dot(position, position)));
+
+		Accumulate<12>(stats, views[i].Elements, reference.Elements, 1, i);
+		Accumulate<4>(stats, views[i].Elements + 12, reference.Elements + 12, distance, i);
+	}
+	ReportAccuracy("mat4::LookAt", "random", stats, 6);
+
+	// Degenerate inputs: the eye on the target, and up parallel to the view direction.
+	// There is no valid frame, so the result must not be a finite matrix that looks like
+	// one; anything finite has to be a proper orthonormal frame.
+	const vec3<float> up(0.0f, 1.0f, 0.0f);
+	const vec3<float> degenerate[][2] =
+	{
+		{ vec3<float>(1.0f, 2.0f, 3.0f), vec3<float>(1.0f, 2.0f, 3.0f) },
+		{ vec3<float>(0.0f, 0.0f, 0.0f), vec3<float>(0.0f, 5.0f, 0.0f) },
+		{ vec3<float>(0.0f, 5.0f, 0.0f), vec3<float>(0.0f, -5.0f, 0.0f) },
+		{ vec3<float>(0.0f, 0.0f, 0.0f), vec3<float>(0.0f, 1e-30f, 0.0f) },
+		{ vec3<float>(0.0f, 0.0f, 0.0f), vec3<float>(1e-30f, 1.0f, 0.0f) }
+	};
+
+	for (const auto& input : degenerate)
+	{
+		mat4<float> view = mat4<float>::LookAt(input[0], input[1], up);
+
+		bool finite = true;
+		for (float element : view.Elements)
+			finite = finite && std::isfinite(element);
+		if (!finite)
+			continue;
+
+		mat3<float> rotation(view);
+		mat3<float> gram = mat3<float>::Transpose(rotation) * rotation;
+		for (int col = 0; col < 3; col++)
+			for (int row = 0; row < 3; row++)
+				MATHS_CHECK(std::fabs(gram.Elements[col * 3 + row] - (row == col ? 1.0f : 0.0f)) < 1e-5f);
+	}
+}
+
+MATHS_TEST(QuatKernels)
+{
+	std::vector<quat<float>> lhs(Count), rhs(Count), products(Count), slerps(Count);
+	std::vector<mat4<float>> matrices(Count);
+	std::vector<vec3<float>> vectors(Count), rotated(Count);
+	std::vector<float> t(Count);
+	for (size_t i = 0; i < Count; i++)
+	{
+		lhs[i] = RandomRotation();
+		rhs[i] = RandomRotation();
+		vectors[i] = RandomVec3(-10.0f, 10.0f);
+		t[i] = Uniform(0.0f, 1.0f);
+	}
+
+	{
+		MATHS_PROFILE_KERNEL("quat::Multiply", Count, Count * 3 * sizeof(quat<float>));
+		for (size_t i = 0; i < Count; i++)
+			products[i] = lhs[i] * rhs[i];
+	}
+	{
+		MATHS_PROFILE_KERNEL("quat::Rotate", Count, Count * (sizeof(quat<float>) + 2 * sizeof(vec3<float>)));
+		for (size_t i = 0; i < Count; i++)
+			rotated[i] = lhs[i].Rotate(vectors[i]);
+	}
+	{
+		MATHS_PROFILE_KERNEL("quat::Slerp", Count, Count * 3 * sizeof(quat<float>));
+		for (size_t i = 0; i < Count; i++)
+			slerps[i] = quat<float>::Slerp(lhs[i], rhs[i], t[i]);
+	}
+	{
+		MATHS_PROFILE_KERNEL("quat::ToMatrix", Count, Count * (sizeof(quat<float>) + sizeof(mat4<float>)));
+		for (size_t i = 0; i < Count; i++)
+			matrices[i] = quat<float>::ToMatrix(lhs[i]);
+	}
+
+	// Unit quaternions: components in ULPs of 1, rotated vectors in ULPs of their length
+	ulp_stats multiply, rotate, slerp, matrix;
+	for (size_t i = 0; i < Count; i++)
+	{
+		quat<real> a = Widen(lhs[i]), b = Widen(rhs[i]);
+		quat<real> product = a * b;
+		quat<real> interpolated = quat<real>::Slerp(a, b, real(t[i]));
+		vec3<real> v = Widen(vectors[i]);
+		vec3<real> r = a.Rotate(v);
+		real length = std::sqrt(real(vec3<real>::Dot(v, v)));
+
+		real productReference[4] = { product.X, product.Y, product.Z, product.W };
+		real slerpReference[4] = { interpolated.X, interpolated.Y, interpolated.Z, interpolated.W };
+		real rotateReference[3] = { r.X, r.Y, r.Z };
+		Accumulate<4>(multiply, &products[i].X, productReference, 1, i);
+		Accumulate<4>(slerp, &slerps[i].X, slerpReference, 1, i);
+		Accumulate<3>(rotate, &rotated[i].X, rotateReference, length, i);
+
+		mat4<real> reference = quat<real>::ToMatrix(a);
+		Accumulate<16>(matrix, matrices[i].Elements, reference.Elements, 1, i);
+	}
+
+	ReportAccuracy("quat::Multiply", "unit", multiply, 4);
+	ReportAccuracy("quat::Rotate", "unit", rotate, 8);
+	ReportAccuracy("quat::Slerp", "unit", slerp, 4);
+	ReportAccuracy("quat::ToMatrix", "unit", matrix, 4);
+}
+
+MATHS_TEST(SinCosBatch)
+{
+	auto measure = [](const std::vector<float>& angles)
+	{
+		std::vector<float> sines(angles.size()), cosines(angles.size());
+		Utils::SinCos(angles.data(), sines.data(), cosines.data(), angles.size());
+
+		ulp_stats stats;
+		for (size_t i = 0; i < angles.size(); i++)
+		{
+			stats.Add(UlpError(sines[i], std::sin(real(angles[i]))), i);
+			stats.Add(UlpError(cosines[i], std::cos(real(angles[i]))), i);
+		}
+		return stats;
+	};
+
+	std::vector<float> angles(Count);
+	for (float& angle : angles)
+		angle = Uniform(-100.0f, 100.0f);
+	ReportAccuracy("SinCos", "random", measure(angles), 2);
+
+	std::vector<float> adversarial;
+	for (float value : Utils::AdversarialValues<float>())
+		if (std::fabs(value) < 1e9f)
+			adversarial.push_back(value);
+	ReportAccuracy("SinCos", "adversarial", measure(adversarial), 2);
+}
+
+// The software sin/cos used by MATHS_DETERMINISTIC: float accurate where the first part
+// of pi/2 times the quadrant is exact, within a float ulp of 1 in absolute terms up to
+// 1e9, and NaN rather than an undefined float to integer conversion once the quadrant
+// runs out
+MATHS_TEST(SoftwareSinCosRange)
+{
+	ulp_stats stats;
+	double largestError = 0.0;
+	for (size_t i = 0; i < Count; i++)
+	{
+		double x = Uniform(-1e5, 1e5);
+		double s, c;
+		Utils::Detail::SinCos(x, s, c);
+		stats.Add(UlpError(float(s), std::sin(real(x))), i);
+		stats.Add(UlpError(float(c), std::cos(real(x))), i);
+
+		x = Uniform(-1e9, 1e9);
+		Utils::Detail::SinCos(x, s, c);
+		largestError = std::max({ largestError, double(std::fabs(s - std::sin(real(x)))), double(std::fabs(c - std::cos(real(x)))) });
+	}
+	ReportAccuracy("Detail::SinCos", "|x| < 1e5", stats, 1);
+	MATHS_CHECK(largestError < double(std::numeric_limits<float>::epsilon()));
+
+	bool undefined = true;
+	for (double x : { std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+		std::numeric_limits<double>::quiet_NaN(), 1e16, -1e16, 1e300, -std::numeric_limits<double>::max() })
+	{
+		double s = 0.0, c = 0.0;
+		Utils::Detail::SinCos(x, s, c);
+		undefined = undefined && std::isnan(s) && std::isnan(c);
+	}
+	MATHS_CHECK(undefined);
+
+	// The last reducible magnitude still gives a value in [-1, 1]
+	double s, c;
+	Utils::Detail::SinCos(1e15, s, c);
+	MATHS_CHECK(std::fabs(s) <= 1.0 && std::fabs(c) <= 1.0);
+}
+
+MATHS_TEST(DecomposeBatch)
+{
+	constexpr size_t MatrixCount = Count / 4;
+
+	std::vector<mat4<float>> matrices(MatrixCount);
+	for (mat4<float>& matrix : matrices)
+		matrix = RandomTRS();
+
+	std::vector<vec3<float>> translations(MatrixCount), scales(MatrixCount);
+	std::vector<quat<float>> rotations(MatrixCount);
+	Transforms::Decompose(matrices.data(), MatrixCount, translations.data(), rotations.data(), scales.data());
+
+	ulp_stats rotationStats, scaleStats;
+	size_t mismatches = 0;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		vec3<real> translation, scale;
+		quat<real> rotation;
+		Transforms::Decompose(Widen(matrices[i]), translation, rotation, scale);
+
+		real rotationReference[4] = { rotation.X, rotation.Y, rotation.Z, rotation.W };
+		real scaleReference[3] = { scale.X, scale.Y, scale.Z };
+		Accumulate<4>(rotationStats, &rotations[i].X, rotationReference, 1, i);
+		for (int c = 0; c < 3; c++)
+			scaleStats.Add(UlpError(scales[i][c], scaleReference[c]), i);
+
+		// The SSE lanes must reproduce the scalar path bit for bit
+		vec3<float> t, s;
+		quat<float> r;
+		Transforms::Decompose(matrices[i], t, r, s);
+		if (std::memcmp(&t, &translations[i], sizeof(t)) != 0 || std::memcmp(&r, &rotations[i], sizeof(r)) != 0 || std::memcmp(&s, &scales[i], sizeof(s)) != 0)
+			mismatches++;
+	}
+
+	ReportAccuracy("Decompose", "rotation", rotationStats, 4);
+	ReportAccuracy("Decompose", "scale", scaleStats, 4);
+	MATHS_CHECK(mismatches == 0);
+}
+
+MATHS_TEST(DecompositionsBatch)
+{
+	constexpr size_t MatrixCount = Count / 8;
+
+	std::vector<mat3<float>> matrices(MatrixCount), symmetric(MatrixCount);
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		matrices[i] = RandomMat<3, 3>(-1.0f, 1.0f);
+		symmetric[i] = mat3<float>::Transpose(matrices[i]) * matrices[i];
+	}
+
+	std::vector<LinearAlgebra::svd3<float>> svds(MatrixCount);
+	std::vector<LinearAlgebra::symmetric_eigen3<float>> eigens(MatrixCount);
+	LinearAlgebra::SVD(matrices.data(), MatrixCount, svds.data());
+	LinearAlgebra::SymmetricEigen(symmetric.data(), MatrixCount, eigens.data());
+
+	// Singular and eigenvalues in ULPs of the largest one
+	ulp_stats sigmaStats, eigenStats;
+	size_t mismatches = 0;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		LinearAlgebra::svd3<real> svd = LinearAlgebra::SVD(Widen(matrices[i]));
+		LinearAlgebra::symmetric_eigen3<real> eigen = LinearAlgebra::SymmetricEigen(Widen(symmetric[i]));
+
+		real sigma[3] = { svd.Sigma.X, svd.Sigma.Y, svd.Sigma.Z };
+		real values[3] = { eigen.Values.X, eigen.Values.Y, eigen.Values.Z };
+		Accumulate<3>(sigmaStats, &svds[i].Sigma.X, sigma, std::fabs(sigma[0]), i);
+		Accumulate<3>(eigenStats, &eigens[i].Values.X, values, std::fabs(values[0]), i);
+
+		LinearAlgebra::svd3<float> single = LinearAlgebra::SVD(matrices[i]);
+		if (std::memcmp(&single, &svds[i], sizeof(single)) != 0)
+			mismatches++;
+	}
+
+	ReportAccuracy("SVD", "random", sigmaStats, 32);
+	ReportAccuracy("SymmetricEigen", "A^T A", eigenStats, 48);
+	MATHS_CHECK(mismatches == 0);
+}
+
+namespace {
+
+	// R diag(l, l + d1, l - d2) R^T with gaps d down to 1e-8 l, where the Jacobi rotations
+	// converge slowest
+	mat3<double> ClusteredSymmetric()
+	{
+		double l = Uniform(-1.0, 1.0);
+		double d1 = std::pow(10.0, Uniform(-8.0, 0.0)), d2 = std::pow(10.0, Uniform(-8.0, 0.0));
+		quat<double> rotation = quat<double>::Rotation(Uniform(-180.0, 180.0), vec3<double>(Uniform(-1.0, 1.0), Uniform(-1.0, 1.0), Uniform(-1.0, 1.0) + 1e-3));
+		mat4<double> r = quat<double>::ToMatrix(rotation);
+
+		mat3<double> result;
+		double values[3] = { l, l + d1, l - d2 };
+		for (int col = 0; col < 3; col++)
+			for (int row = col; row < 3; row++)
+				result.Cols[col][row] = result.Cols[row][col] = r.Cols[0][row] * values[0] * r.Cols[0][col] + r.Cols[1][row] * values[1] * r.Cols[1][col] + r.Cols[2][row] * values[2] * r.Cols[2][col];
+		return result;
+	}
+
+	// V diag(values) V^T in long double against the input, in ULPs of its largest element
+	void AccumulateReconstruction(ulp_stats& stats, const mat3<double>& input, const mat3<double>& left, const vec3<double>& values, const mat3<double>& right, size_t index)
+	{
+		real scale = 0;
+		for (double element : input.Elements)
+			scale = std::max(scale, real(std::fabs(element)));
+
+		for (int col = 0; col < 3; col++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				real sum = 0;
+				for (int k = 0; k < 3; k++)
+					sum += real(left.Cols[k][row]) * real(values[k]) * real(right.Cols[k][col]);
+				stats.Add(UlpError(input.Cols[col][row], sum, scale), index);
+			}
+		}
+	}
+
+}
+
+// Reconstruction error of the double decompositions, which need more Jacobi sweeps than
+// float to reach their own rounding error
+MATHS_TEST(DecompositionsDouble)
+{
+	constexpr size_t MatrixCount = 20000;
+
+	std::vector<mat3<double>> matrices(MatrixCount), symmetric(MatrixCount), clustered(MatrixCount);
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		for (double& element : matrices[i].Elements)
+			element = Uniform(-1.0, 1.0);
+		symmetric[i] = mat3<double>::Transpose(matrices[i]) * matrices[i];
+		clustered[i] = ClusteredSymmetric();
+	}
+
+	std::vector<LinearAlgebra::svd3<double>> svds(MatrixCount);
+	std::vector<LinearAlgebra::symmetric_eigen3<double>> eigens(MatrixCount), clusteredEigens(MatrixCount);
+	LinearAlgebra::SVD(matrices.data(), MatrixCount, svds.data());
+	LinearAlgebra::SymmetricEigen(symmetric.data(), MatrixCount, eigens.data());
+	LinearAlgebra::SymmetricEigen(clustered.data(), MatrixCount, clusteredEigens.data());
+
+	ulp_stats svdStats, eigenStats, clusteredStats;
+	for (size_t i = 0; i < MatrixCount; i++)
+	{
+		AccumulateReconstruction(svdStats, matrices[i], svds[i].U, svds[i].Sigma, svds[i].V, i);
+		AccumulateReconstruction(eigenStats, symmetric[i], eigens[i].Vectors, eigens[i].Values, eigens[i].Vectors, i);
+		AccumulateReconstruction(clusteredStats, clustered[i], clusteredEigens[i].Vectors, clusteredEigens[i].Values, clusteredEigens[i].Vectors, i);
+	}
+
+	ReportAccuracy("SVD", "double U S V^T", svdStats, 100);
+	ReportAccuracy("SymmetricEigen", "double A^T A", eigenStats, 192);
+	ReportAccuracy("SymmetricEigen", "double cluster", clusteredStats, 192);
+}
+
+MATHS_TEST(TransformPointsBatch)
+{
+	affine<float> matrix(RandomTRS());
+	std::vector<vec3<float>> points(Count), transformed(Count);
+	for (vec3<float>& point : points)
+		point = RandomVec3(-100.0f, 100.0f);
+
+	TransformPoints(matrix, points.data(), Count, transformed.data());
+
+	ulp_stats stats;
+	for (size_t i = 0; i < Count; i++)
+	{
+		vec3<real> p = Widen(points[i]);
+		for (int row = 0; row < 3; row++)
+		{
+			real terms[4] = { real(matrix.Elements[row]) * p.X, real(matrix.Elements[3 + row]) * p.Y, real(matrix.Elements[6 + row]) * p.Z, real(matrix.Elements[9 + row]) };
+			real sum = terms[0] + terms[1] + terms[2] + terms[3];
+			real magnitude = std::fabs(terms[0]) + std::fabs(terms[1]) + std::fabs(terms[2]) + std::fabs(terms[3]);
+			stats.Add(UlpError(transformed[i][row], sum, magnitude), i);
+		}
+	}
+	ReportAccuracy("TransformPoints", "random", stats, 4);
+}
+
+MATHS_TEST(Reductions)
+{
+	std::vector<vec3<float>> values(Count * 4);
+	for (vec3<float>& value : values)
+		value = RandomVec3(-1.0f, 1.0f) * Uniform(1.0f, 1000.0f);
+
+	real reference[3] = {};
+	real magnitude = 0;
+	for (const vec3<float>& value : values)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			reference[c] += value[c];
+			magnitude = std::fmax(magnitude, std::fabs(reference[c]));
+		}
+	}
+
+	// Kahan sums are correctly rounded up to an ulp of the total; the others drift with
+	// the number of terms, pairwise only logarithmically
+	vec3<float> kahan = Geometry::Sum(values.data(), values.size(), Geometry::summation::Kahan);
+	vec3<float> pairwise = Geometry::Sum(values.data(), values.size(), Geometry::summation::Pairwise);
+	vec3<float> naive = Geometry::Sum(values.data(), values.size(), Geometry::summation::Naive);
+
+	ulp_stats kahanStats, pairwiseStats, naiveStats;
+	Accumulate<3>(kahanStats, &kahan.X, reference, magnitude, 0);
+	Accumulate<3>(pairwiseStats, &pairwise.X, reference, magnitude, 0);
+	Accumulate<3>(naiveStats, &naive.X, reference, magnitude, 0);
+
+	ReportAccuracy("Sum", "Kahan", kahanStats, 2);
+	ReportAccuracy("Sum", "pairwise", pairwiseStats, 4);
+	ReportAccuracy("Sum", "naive", naiveStats, ReportOnly);
+}
\ No newline at end of file
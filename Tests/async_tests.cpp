@@ -0,0 +1,199 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Coroutine layer: SyncWait and ParallelForAsync are run many times in a row, since their
+// lifetime bugs only show when a worker finishes before the posting thread moves on, and
+// the channel pipeline is timed against the sequential load-then-compute loop it replaces.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Tests;
+using Utils::task;
+using Utils::thread_pool;
+
+namespace {
+
+	constexpr size_t Repeats = 2000;
+
+	task<int> Twice(thread_pool& pool, int value)
+	{
+		co_await pool.Schedule();
+		co_return value * 2;
+	}
+
+	task<> Throw(thread_pool& pool)
+	{
+		co_await pool.Schedule();
+		throw std::runtime_error("expected");
+	}
+
+}
+
+MATHS_TEST(SyncWaitResults)
+{
+	thread_pool pool(4);
+
+	bool correct = true;
+	for (size_t i = 0; i < Repeats; i++)
+		correct = correct && Utils::SyncWait(Twice(pool, int(i))) == int(i) * 2;
+	MATHS_CHECK(correct);
+
+	size_t caught = 0;
+	for (size_t i = 0; i < 100; i++)
+	{
+		try
+		{
+			Utils::SyncWait(Throw(pool));
+		}
+		catch (const std::runtime_error&)
+		{
+			caught++;
+		}
+	}
+	MATHS_CHECK(caught == 100);
+}
+
+MATHS_TEST(ParallelForAsyncCoverage)
+{
+	thread_pool pool(4);
+
+	// Tiny chunks so the last job often finishes while the loop is still posting
+	std::vector<std::atomic<int>> visits(37);
+	bool correct = true;
+	for (size_t i = 0; i < Repeats; i++)
+	{
+		for (std::atomic<int>& visit : visits)
+			visit = 0;
+
+		Utils::SyncWait(Utils::ParallelForAsync(pool, visits.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t j = begin; j < end; j++)
+				visits[j]++;
+		}));
+
+		for (std::atomic<int>& visit : visits)
+			correct = correct && visit == 1;
+	}
+	MATHS_CHECK(correct);
+}
+
+// A throwing range reaches the awaiting coroutine instead of terminating the pool worker
+MATHS_TEST(ParallelForAsyncExceptions)
+{
+	thread_pool pool(4);
+
+	size_t caught = 0;
+	for (size_t i = 0; i < Repeats; i++)
+	{
+		size_t thrower = i % 8;
+		try
+		{
+			Utils::SyncWait(Utils::ParallelForAsync(pool, 8, 1, [&](size_t begin, size_t end)
+			{
+				if (begin <= thrower && thrower < end)
+					throw std::runtime_error("range failed");
+			}));
+		}
+		catch (const std::runtime_error&)
+		{
+			caught++;
+		}
+	}
+	MATHS_CHECK(caught == Repeats);
+
+	// The pool is still usable afterwards
+	std::atomic<size_t> total{ 0 };
+	Utils::SyncWait(Utils::ParallelForAsync(pool, 100, 1, [&](size_t begin, size_t end) { total += end - begin; }));
+	MATHS_CHECK(total == 100);
+}
+
+namespace {
+
+	constexpr size_t Batches = 24;
+	constexpr size_t BatchSize = 1 << 14;
+	constexpr auto LoadLatency = std::chrono::milliseconds(2);
+
+	// Stands in for reading a batch from disk: the thread waits, the core is free
+	std::vector<vec3<float>> LoadBatch(size_t index)
+	{
+		std::this_thread::sleep_for(LoadLatency);
+
+		std::vector<vec3<float>> points(BatchSize);
+		for (size_t i = 0; i < BatchSize; i++)
+			points[i] = vec3<float>(float(index), float(i), float(index + i) * 0.5f);
+		return points;
+	}
+
+	vec3<float> ProcessBatch(const std::vector<vec3<float>>& points)
+	{
+		std::vector<vec3<float>> transformed(points.size());
+		affine<float> transform = affine<float>::Rotation(30.0f, vec3<float>(0.0f, 1.0f, 0.0f));
+		for (int pass = 0; pass < 8; pass++)
+			TransformPoints(transform, pass == 0 ? points.data() : transformed.data(), points.size(), transformed.data());
+		return Geometry::Sum(transformed.data(), transformed.size());
+	}
+
+	task<> Produce(thread_pool& pool, Utils::bounded_channel<std::vector<vec3<float>>>& channel)
+	{
+		co_await pool.Schedule();
+		for (size_t i = 0; i < Batches; i++)
+			co_await channel.Send(LoadBatch(i));
+		channel.Close();
+	}
+
+	task<> Consume(thread_pool& pool, Utils::bounded_channel<std::vector<vec3<float>>>& channel, std::vector<vec3<float>>& sums)
+	{
+		co_await pool.Schedule();
+		while (std::optional<std::vector<vec3<float>>> batch = co_await channel.Receive())
+			sums.push_back(ProcessBatch(*batch));
+	}
+
+}
+
+// Overlap efficiency is the share of the shorter stage (loading or processing) hidden
+// behind the longer one: 1 when the pipeline takes as long as its slowest stage alone
+MATHS_TEST(ChannelOverlap)
+{
+	using clock = std::chrono::steady_clock;
+	auto milliseconds = [](clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+	std::vector<vec3<float>> sequential;
+	double loadTime = 0.0, processTime = 0.0;
+	clock::time_point start = clock::now();
+	for (size_t i = 0; i < Batches; i++)
+	{
+		clock::time_point loadStart = clock::now();
+		std::vector<vec3<float>> batch = LoadBatch(i);
+		clock::time_point processStart = clock::now();
+		sequential.push_back(ProcessBatch(batch));
+		loadTime += milliseconds(processStart - loadStart);
+		processTime += milliseconds(clock::now() - processStart);
+	}
+	double sequentialTime = milliseconds(clock::now() - start);
+
+	thread_pool pool(2);
+	Utils::bounded_channel<std::vector<vec3<float>>> channel(pool, 2);
+	std::vector<vec3<float>> pipelined;
+	start = clock::now();
+	std::thread producer([&]() { Utils::SyncWait(Produce(pool, channel)); });
+	Utils::SyncWait(Consume(pool, channel, pipelined));
+	producer.join();
+	double pipelinedTime = milliseconds(clock::now() - start);
+
+	MATHS_CHECK(pipelined.size() == sequential.size());
+	MATHS_CHECK(std::memcmp(pipelined.data(), sequential.data(), sequential.size() * sizeof(vec3<float>)) == 0);
+
+	double hidden = sequentialTime - pipelinedTime;
+	double efficiency = hidden / std::min(loadTime, processTime);
+	std::printf("  channel pipeline: sequential %.1f ms (load %.1f, process %.1f), pipelined %.1f ms, overlap efficiency %.2f\n",
+		sequentialTime, loadTime, processTime, pipelinedTime, efficiency);
+}
\ No newline at end of file
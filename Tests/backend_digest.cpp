@@ -0,0 +1,328 @@
+#include "Maths.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Bitwise comparison of the SIMD and scalar backends under MATHS_DETERMINISTIC. The same
+// source is built twice, once with MATHS_DISABLE_SIMD, and both builds run every kernel
+// with SSE paths on the same inputs. The SIMD build writes one hash per kernel, and the
+// scalar build recomputes them with --compare and fails on any difference: a single bit
+// of drift (a fused multiply-add, a reordered sum) changes the hash.
+//
+//   backend_digest <file>            writes the digests
+//   backend_digest --compare <file>  fails unless this build produces the same digests
+
+using namespace Maths;
+using namespace Maths::Containers;
+
+namespace {
+
+	constexpr size_t Count = 4099;
+
+	// std::uniform_real_distribution is implementation defined, so inputs come from a
+	// fixed LCG to stay identical across standard libraries
+	struct generator
+	{
+		uint64_t State = 0x853c49e6748fea9bull;
+
+		float Uniform(float min, float max)
+		{
+			State = State * 6364136223846793005ull + 1442695040888963407ull;
+			return min + (max - min) * (float(uint32_t(State >> 40)) / float(1u << 24));
+		}
+
+		vec3<float> Vec3(float min, float max)
+		{
+			float x = Uniform(min, max), y = Uniform(min, max), z = Uniform(min, max);
+			return vec3<float>(x, y, z);
+		}
+
+		quat<float> Rotation()
+		{
+			float angle = Uniform(-180.0f, 180.0f);
+			return quat<float>::Rotation(angle, Vec3(-1.0f, 1.0f) + vec3<float>(0.0f, 0.0f, 1e-3f));
+		}
+
+		mat4<float> TRS()
+		{
+			vec3<float> scale(Uniform(0.5f, 2.0f), Uniform(0.5f, 2.0f), Uniform(0.5f, 2.0f));
+			mat4<float> result = quat<float>::ToMatrix(Rotation());
+			result.Cols[0] *= scale.X;
+			result.Cols[1] *= scale.Y;
+			result.Cols[2] *= scale.Z;
+			result.Cols[3] = vec4<float>(Vec3(-10.0f, 10.0f), 1.0f);
+			return result;
+		}
+
+		template <size_t C, size_t R>
+		mat<C, R, float> Mat(float min, float max)
+		{
+			mat<C, R, float> result;
+			for (float& element : result.Elements)
+				element = Uniform(min, max);
+			return result;
+		}
+	};
+
+	struct digest
+	{
+		std::string Kernel;
+		uint64_t Hash;
+	};
+
+	// FNV-1a over the bytes of the results
+	template <typename T>
+	uint64_t Hash(const std::vector<T>& values)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values.data());
+		for (size_t i = 0; i < values.size() * sizeof(T); i++)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		return hash;
+	}
+
+	std::vector<digest> Run()
+	{
+		std::vector<digest> digests;
+		generator random;
+
+		std::vector<mat4<float>> lhs(Count), rhs(Count);
+		std::vector<vec4<float>> vectors(Count);
+		for (size_t i = 0; i < Count; i++)
+		{
+			lhs[i] = random.Mat<4, 4>(-2.0f, 2.0f);
+			rhs[i] = random.TRS();
+			vectors[i] = vec4<float>(random.Vec3(-100.0f, 100.0f), 1.0f);
+		}
+
+		{
+			std::vector<mat4<float>> products(Count);
+			std::vector<vec4<float>> transformed(Count);
+			for (size_t i = 0; i < Count; i++)
+			{
+				products[i] = lhs[i] * rhs[i];
+				transformed[i] = lhs[i] * vectors[i];
+			}
+			digests.push_back({ "mat4 * mat4", Hash(products) });
+			digests.push_back({ "mat4 * vec4", Hash(transformed) });
+		}
+
+		{
+			std::vector<mat4<float>> inverses(Count);
+			std::vector<vec3<float>> normalised(Count);
+			for (size_t i = 0; i < Count; i++)
+			{
+				inverses[i] = mat4<float>::Inverse(rhs[i]);
+				normalised[i] = vec3<float>(vectors[i].X, vectors[i].Y, vectors[i].Z).Normalise();
+			}
+			digests.push_back({ "mat4::Inverse", Hash(inverses) });
+			digests.push_back({ "vec3::Normalise", Hash(normalised) });
+		}
+
+		{
+			std::vector<quat<float>> slerped(Count);
+			std::vector<mat4<float>> matrices(Count);
+			for (size_t i = 0; i < Count; i++)
+			{
+				quat<float> a = random.Rotation(), b = random.Rotation();
+				slerped[i] = quat<float>::Slerp(a, b, random.Uniform(0.0f, 1.0f));
+				matrices[i] = quat<float>::ToMatrix(a * b);
+			}
+			digests.push_back({ "quat::Slerp", Hash(slerped) });
+			digests.push_back({ "quat::ToMatrix", Hash(matrices) });
+		}
+
+		{
+			std::vector<float> angles(Count), sines(Count), cosines(Count);
+			for (float& angle : angles)
+				angle = random.Uniform(-1000.0f, 1000.0f);
+			Utils::SinCos(angles.data(), sines.data(), cosines.data(), Count);
+			digests.push_back({ "SinCos sin", Hash(sines) });
+			digests.push_back({ "SinCos cos", Hash(cosines) });
+		}
+
+		{
+			std::vector<mat4<float>> projected(Count), translated(Count);
+			projection_mat4<float> projection = projection_mat4<float>::Perspective(60.0f, 1.5f, 0.1f, 1000.0f);
+			for (size_t i = 0; i < Count; i++)
+			{
+				translation_mat4<float> translation(random.Vec3(-50.0f, 50.0f));
+				projected[i] = projection * rhs[i];
+				translated[i] = translation * lhs[i];
+			}
+			digests.push_back({ "projection_mat4 * mat4", Hash(projected) });
+			digests.push_back({ "translation_mat4 * mat4", Hash(translated) });
+		}
+
+		{
+			std::vector<vec3<float>> translations(Count), scales(Count);
+			std::vector<quat<float>> rotations(Count);
+			Transforms::Decompose(rhs.data(), Count, translations.data(), rotations.data(), scales.data());
+			digests.push_back({ "Decompose translation", Hash(translations) });
+			digests.push_back({ "Decompose rotation", Hash(rotations) });
+			digests.push_back({ "Decompose scale", Hash(scales) });
+		}
+
+		{
+			std::vector<mat3<float>> matrices(Count), symmetric(Count);
+			for (size_t i = 0; i < Count; i++)
+			{
+				matrices[i] = random.Mat<3, 3>(-1.0f, 1.0f);
+				symmetric[i] = mat3<float>::Transpose(matrices[i]) * matrices[i];
+			}
+
+			std::vector<LinearAlgebra::svd3<float>> svds(Count);
+			std::vector<LinearAlgebra::symmetric_eigen3<float>> eigens(Count);
+			std::vector<LinearAlgebra::polar3<float>> polars(Count);
+			LinearAlgebra::SVD(matrices.data(), Count, svds.data());
+			LinearAlgebra::SymmetricEigen(symmetric.data(), Count, eigens.data());
+			LinearAlgebra::PolarDecomposition(matrices.data(), Count, polars.data());
+			digests.push_back({ "SVD", Hash(svds) });
+			digests.push_back({ "SymmetricEigen", Hash(eigens) });
+			digests.push_back({ "PolarDecomposition", Hash(polars) });
+		}
+
+		{
+			std::vector<vec3<float>> points(Count), transformed(Count);
+			for (vec3<float>& point : points)
+				point = random.Vec3(-100.0f, 100.0f);
+			TransformPoints(affine<float>(rhs[0]), points.data(), Count, transformed.data());
+			digests.push_back({ "TransformPoints", Hash(transformed) });
+
+			std::vector<vec3<float>> sums;
+			for (Geometry::summation method : { Geometry::summation::Naive, Geometry::summation::Kahan, Geometry::summation::Pairwise })
+				sums.push_back(Geometry::Sum(points.data(), Count, method));
+			digests.push_back({ "Sum", Hash(sums) });
+		}
+
+		{
+			// Points partly outside the bounds, so both clamps are taken
+			std::vector<vec3<float>> points(Count);
+			for (vec3<float>& point : points)
+				point = random.Vec3(-12.0f, 12.0f);
+			std::vector<uint32_t> keys(Count);
+			Spatial::MortonKeys(points.data(), Count, Geometry::aabb<float>{ vec3<float>(-10.0f), vec3<float>(10.0f) }, keys.data());
+			digests.push_back({ "MortonKeys", Hash(keys) });
+		}
+
+		{
+			// Integer kernels: SSE4.1 transforms four points per step when the build has it
+			std::vector<vec3<fixed16>> points(Count), transformed(Count), directions(Count);
+			for (vec3<fixed16>& point : points)
+				point = vec3<fixed16>(fixed16(random.Uniform(-3.0e4f, 3.0e4f)), fixed16(random.Uniform(-100.0f, 100.0f)), fixed16(random.Uniform(-1.0f, 1.0f)));
+			mat4<fixed16> matrix;
+			for (size_t i = 0; i < 16; i++)
+				matrix.Elements[i] = fixed16(rhs[0].Elements[i]);
+			TransformPoints(matrix, points.data(), Count, transformed.data());
+			TransformDirections(matrix, points.data(), Count, directions.data());
+			digests.push_back({ "TransformPoints fixed16", Hash(transformed) });
+			digests.push_back({ "TransformDirections fixed16", Hash(directions) });
+		}
+
+		{
+			// A jittered grid, so triangles differ in shape and the UVs in orientation
+			constexpr uint32_t Side = 45;
+			std::vector<vec3<float>> positions;
+			std::vector<vec2<float>> uvs;
+			std::vector<uint32_t> indices;
+			for (uint32_t y = 0; y <= Side; y++)
+				for (uint32_t x = 0; x <= Side; x++)
+				{
+					positions.push_back(vec3<float>(float(x), float(y), 0.0f) + random.Vec3(-0.3f, 0.3f));
+					float u = random.Uniform(-1.0f, 1.0f);
+					uvs.push_back(vec2<float>(u, random.Uniform(-1.0f, 1.0f)));
+				}
+			for (uint32_t y = 0; y < Side; y++)
+				for (uint32_t x = 0; x < Side; x++)
+				{
+					uint32_t i = y * (Side + 1) + x;
+					indices.insert(indices.end(), { i, i + 1, i + Side + 2, i, i + Side + 2, i + Side + 1 });
+				}
+
+			size_t triangles = indices.size() / 3;
+			Geometry::mesh_adjacency adjacency = Geometry::mesh_adjacency::Build(indices.data(), triangles, positions.size());
+			std::vector<vec3<float>> normals(positions.size()), areaNormals(positions.size());
+			std::vector<vec4<float>> tangents(positions.size());
+			Geometry::ComputeNormals(positions.data(), indices.data(), triangles, adjacency, normals.data());
+			Geometry::ComputeNormals(positions.data(), indices.data(), triangles, adjacency, areaNormals.data(), Geometry::normal_weighting::Area);
+			Geometry::ComputeTangents(positions.data(), uvs.data(), normals.data(), indices.data(), triangles, adjacency, tangents.data());
+			digests.push_back({ "ComputeNormals angle", Hash(normals) });
+			digests.push_back({ "ComputeNormals area", Hash(areaNormals) });
+			digests.push_back({ "ComputeTangents", Hash(tangents) });
+		}
+
+		{
+			// Lights spread through the view volume, with radii from point-like to many clusters
+			Geometry::cluster_grid<float> grid = Geometry::cluster_grid<float>::Build(mat4<float>::Perspective(60.0f, 1.5f, 0.1f, 100.0f), 16, 9, 24, 0.1f, 100.0f);
+			std::vector<vec3<float>> positions(Count);
+			std::vector<float> radii(Count);
+			for (size_t i = 0; i < Count; i++)
+			{
+				positions[i] = vec3<float>(random.Uniform(-60.0f, 60.0f), random.Uniform(-40.0f, 40.0f), random.Uniform(-100.0f, 0.0f));
+				radii[i] = random.Uniform(0.01f, 8.0f);
+			}
+			Geometry::light_list lights;
+			Geometry::AssignLights(grid, mat4<float>(1.0f), positions.data(), radii.data(), Count, lights);
+			digests.push_back({ "AssignLights offsets", Hash(lights.Offsets) });
+			digests.push_back({ "AssignLights indices", Hash(lights.Indices) });
+		}
+
+		return digests;
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	bool compare = argc == 3 && std::strcmp(argv[1], "--compare") == 0;
+	if (argc != 2 && !compare)
+	{
+		std::printf("usage: backend_digest [--compare] <file>\n");
+		return 2;
+	}
+
+	const char* path = argv[argc - 1];
+	std::vector<digest> digests = Run();
+
+	if (!compare)
+	{
+		FILE* file = std::fopen(path, "w");
+		if (!file)
+		{
+			std::printf("cannot write %s\n", path);
+			return 2;
+		}
+		for (const digest& entry : digests)
+			std::fprintf(file, "%016llx %s\n", (unsigned long long)entry.Hash, entry.Kernel.c_str());
+		std::fclose(file);
+		return 0;
+	}
+
+	FILE* file = std::fopen(path, "r");
+	if (!file)
+	{
+		std::printf("cannot read %s\n", path);
+		return 2;
+	}
+
+	size_t mismatches = 0;
+	char line[256];
+	for (const digest& entry : digests)
+	{
+		unsigned long long expected = 0;
+		if (!std::fgets(line, sizeof(line), file) || std::sscanf(line, "%llx", &expected) != 1 || expected != entry.Hash)
+		{
+			mismatches++;
+			std::printf("MISMATCH %s\n", entry.Kernel.c_str());
+		}
+		else
+			std::printf("identical %s\n", entry.Kernel.c_str());
+	}
+	std::fclose(file);
+
+	std::printf("\n%zu kernel(s) differ between backends\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Spellings that compiled when vec2, vec3 and vec4 were class templates, deduced through
+// the aliases now that they name vec<N, T>. Fixed point: arithmetic against exact integer
+// references, the documented accuracy of the table functions, wrapping on overflow and
+// the batch transforms against one point at a time. Affine inverses round trip random
+// scale, rotation and translation compositions and agree with the mat4 inverse.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Tests;
+
+namespace {
+
+	// Scale, then rotation about a random axis, then translation; scales keep the
+	// condition number at most 16
+	template <typename T>
+	affine<T> RandomAffine()
+	{
+		vec3<T> scale(T(Uniform(0.25, 4.0)), T(Uniform(0.25, 4.0)), T(Uniform(0.25, 4.0)));
+		vec3<T> axis(T(Uniform(-1.0, 1.0)), T(Uniform(-1.0, 1.0)), T(Uniform(0.1, 1.0)));
+		vec3<T> translation(T(Uniform(-100.0, 100.0)), T(Uniform(-100.0, 100.0)), T(Uniform(-100.0, 100.0)));
+		return affine<T>::Translation(translation) * affine<T>::Rotation(T(Uniform(-180.0, 180.0)), axis) * affine<T>::Scale(scale);
+	}
+
+	template <typename T>
+	T MaxDifference(const mat4x3<T>& lhs, const mat4x3<T>& rhs)
+	{
+		T difference = T(0);
+		for (size_t i = 0; i < 12; i++)
+			difference = std::max(difference, std::abs(lhs.Elements[i] - rhs.Elements[i]));
+		return difference;
+	}
+
+	// Largest element error of Inverse(a) * a and a * Inverse(a) against the identity and
+	// of the point round trip relative to the translation scale, over random transforms
+	template <typename T>
+	T AffineRoundTripError()
+	{
+		T error = T(0);
+		for (int i = 0; i < 1000; i++)
+		{
+			affine<T> matrix = RandomAffine<T>();
+			affine<T> inverse = affine<T>::Inverse(matrix);
+			error = std::max(error, MaxDifference<T>(inverse * matrix, affine<T>::Identity()));
+			error = std::max(error, MaxDifference<T>(matrix * inverse, affine<T>::Identity()));
+
+			vec3<T> point(T(Uniform(-100.0, 100.0)), T(Uniform(-100.0, 100.0)), T(Uniform(-100.0, 100.0)));
+			vec3<T> back = inverse.TransformPoint(matrix.TransformPoint(point));
+			for (size_t c = 0; c < 3; c++)
+				error = std::max(error, std::abs(back[c] - point[c]) / T(100));
+		}
+		return error;
+	}
+
+#if defined(__SIZEOF_INT128__)
+	__extension__ typedef __int128 int128;
+#endif
+
+	// Largest errors of sin and cos over [-10, 10] and of acos over [-1, 1], against the
+	// standard functions of the same fixed point input
+	template <typename F>
+	void TableErrors(double& sine, double& cosine, double& arcCosine)
+	{
+		sine = cosine = arcCosine = 0.0;
+		for (int i = -40000; i <= 40000; i++)
+		{
+			F angle(i * 2.5e-4);
+			sine = std::max(sine, std::abs(double(Utils::Sin(angle)) - std::sin(double(angle))));
+			cosine = std::max(cosine, std::abs(double(Utils::Cos(angle)) - std::cos(double(angle))));
+
+			F x(i * 2.5e-5);
+			arcCosine = std::max(arcCosine, std::abs(double(Utils::Acos(x)) - std::acos(double(x))));
+		}
+	}
+
+}
+
+MATHS_TEST(VecDeduction)
+{
+	auto up = vec3(0.0f, 1.0f, 0.0f);
+	auto uv = vec2(0.5, 0.25);
+	auto colour = vec4(1.0f, 0.5f, 0.25f, 1.0f);
+	auto splat = vec3(2.0f);
+	auto point = vec4(up, 1.0f);
+	vec3 cell(1, 2, 3);
+	auto generic = vec(1.0f, 2.0f, 3.0f);
+
+	static_assert(std::is_same_v<decltype(up), vec3<float>>);
+	static_assert(std::is_same_v<decltype(uv), vec2<double>>);
+	static_assert(std::is_same_v<decltype(colour), vec4<float>>);
+	static_assert(std::is_same_v<decltype(splat), vec3<float>>);
+	static_assert(std::is_same_v<decltype(point), vec4<float>>);
+	static_assert(std::is_same_v<decltype(cell), vec3<int>>);
+	static_assert(std::is_same_v<decltype(generic), vec3<float>>);
+
+	mat4<float> view = mat4<float>::LookAt(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+	mat4<float> defaultUp = mat4<float>::LookAt(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f, 0.0f, 0.0f));
+	MATHS_CHECK(std::memcmp(view.Elements, defaultUp.Elements, sizeof(view.Elements)) == 0);
+	MATHS_CHECK(splat == vec3(2.0f, 2.0f, 2.0f));
+	MATHS_CHECK(point.W == 1.0f && point.Y == 1.0f);
+	MATHS_CHECK(cell.Z == 3 && uv.Y == 0.25 && colour.Z == 0.25f && generic.Z == 3.0f);
+}
+
+MATHS_TEST(FixedArithmetic)
+{
+	MATHS_CHECK(fixed16(1.5).Raw == 0x18000 && fixed16(-2).Raw == -0x20000 && fixed16(0.1).Raw == 6554);
+	MATHS_CHECK(double(fixed16::FromRaw(1)) == 1.0 / 65536.0 && int(fixed16(-1.5)) == -2 && int(fixed16(2.75)) == 2);
+
+	// Multiplication rounds half up, division truncates towards zero
+	MATHS_CHECK((fixed16::FromRaw(1) * fixed16(0.5)).Raw == 1 && (fixed16::FromRaw(1) * fixed16(0.25)).Raw == 0);
+	MATHS_CHECK((fixed16(1) / fixed16(3)).Raw == 21845 && (fixed16(-1) / fixed16(3)).Raw == -21845);
+	MATHS_CHECK(fixed16(3) - fixed16(4.5) == fixed16(-1.5) && -fixed16(2) < fixed16(1) && fixed16(1) >= fixed16(1));
+
+	bool exact = true;
+	for (int i = 0; i < 10000; i++)
+	{
+		fixed16 a(Uniform(-180.0, 180.0)), b(Uniform(-180.0, 180.0));
+		exact = exact && (a + b).Raw == a.Raw + b.Raw && (a - b).Raw == a.Raw - b.Raw;
+		exact = exact && (a * b).Raw == (int64_t(a.Raw) * b.Raw + (1 << 15)) >> 16;
+		exact = exact && (a / b).Raw == int64_t(a.Raw) * 65536 / b.Raw;
+	}
+	MATHS_CHECK(exact);
+
+#if defined(__SIZEOF_INT128__)
+	MATHS_CHECK(fixed32(-0.25).Raw == -(int64_t(1) << 30));
+	for (int i = 0; i < 10000; i++)
+	{
+		fixed32 a(Uniform(-4.0e4, 4.0e4)), b(Uniform(-4.0e4, 4.0e4));
+		exact = exact && (a * b).Raw == int64_t((int128(a.Raw) * b.Raw + (int128(1) << 31)) >> 32);
+		exact = exact && (a / b).Raw == int64_t((int128(a.Raw) << 32) / b.Raw);
+	}
+	MATHS_CHECK(exact);
+#endif
+
+	// Through the containers, whose literals convert to fixed
+	vec3<fixed16> v(fixed16(1), fixed16(2), fixed16(2));
+	MATHS_CHECK(v.Magnitude() == fixed16(3) && vec3<fixed16>::Dot(v, v) == fixed16(9));
+	mat4<fixed16> scale = mat4<fixed16>::Scale(vec3<fixed16>(fixed16(2), fixed16(0.5), fixed16(-1)));
+	vec4<fixed16> scaled = scale * vec4<fixed16>(v, fixed16(1));
+	MATHS_CHECK(scaled.X == fixed16(2) && scaled.Y == fixed16(1) && scaled.Z == fixed16(-2) && scaled.W == fixed16(1));
+}
+
+MATHS_TEST(FixedTrigonometry)
+{
+	// fixed16 is limited by its own step of 1.5e-5: sin and cos stay within half of it
+	double sine, cosine, arcCosine;
+	TableErrors<fixed16>(sine, cosine, arcCosine);
+	MATHS_CHECK(sine < 8e-6 && cosine < 8e-6 && arcCosine < 1e-4);
+
+#if defined(__SIZEOF_INT128__)
+	TableErrors<fixed32>(sine, cosine, arcCosine);
+	MATHS_CHECK(sine < 3e-7 && cosine < 3e-7 && arcCosine < 1e-7);
+#endif
+
+	// sqrt is the exact root rounded down: r^2 <= x < (r + 1)^2 in raw units
+	bool roots = true;
+	for (int i = 0; i < 10000; i++)
+	{
+		fixed16 x = fixed16::FromRaw(int32_t(Random()() & 0x7FFFFFFF));
+		uint64_t r = uint64_t(sqrt(x).Raw), scaled = uint64_t(x.Raw) << 16;
+		roots = roots && r * r <= scaled && scaled < (r + 1) * (r + 1);
+	}
+	MATHS_CHECK(roots);
+	MATHS_CHECK(sqrt(fixed16(4)) == fixed16(2) && sqrt(fixed16(0.25)) == fixed16(0.5));
+}
+
+MATHS_TEST(FixedOverflow)
+{
+	// Addition, subtraction, negation, multiplication and integer conversion wrap like
+	// the raw integers
+	fixed16 highest = std::numeric_limits<fixed16>::max(), lowest = std::numeric_limits<fixed16>::lowest();
+	fixed16 step = std::numeric_limits<fixed16>::epsilon();
+	MATHS_CHECK(highest + step == lowest && lowest - step == highest && -lowest == lowest);
+	MATHS_CHECK(fixed16(32767) + fixed16(1) == fixed16(-32768) && fixed16(32768) == lowest && fixed16(65536) == fixed16(0));
+	MATHS_CHECK(fixed16(256) * fixed16(256) == fixed16(0) && fixed16(300) * fixed16(-200) == fixed16(5536));
+
+	// acos saturates its argument to [-1, 1] and sqrt returns 0 for negative values
+	MATHS_CHECK(acos(fixed16(1.5)) == fixed16(0) && acos(fixed16(-3)) == acos(fixed16(-1)));
+	MATHS_CHECK(std::abs(double(acos(fixed16(-1))) - 3.14159265358979) < 1e-5);
+	MATHS_CHECK(sqrt(fixed16(-4)) == fixed16(0) && sqrt(lowest) == fixed16(0));
+}
+
+MATHS_TEST(FixedTransforms)
+{
+	// Components up to the range limits, so products need the full double width and
+	// some results wrap, and a count that leaves a remainder after groups of four
+	constexpr size_t Count = 1003;
+	std::vector<vec3<fixed16>> points(Count), transformed(Count), directions(Count);
+	for (vec3<fixed16>& point : points)
+		point = vec3<fixed16>(fixed16(Uniform(-3.0e4, 3.0e4)), fixed16(Uniform(-100.0, 100.0)), fixed16::FromRaw(int32_t(Random()())));
+
+	mat4<fixed16> matrix;
+	for (fixed16& element : matrix.Elements)
+		element = fixed16(Uniform(-2.0, 2.0));
+	TransformPoints(matrix, points.data(), Count, transformed.data());
+	TransformDirections(matrix, points.data(), Count, directions.data());
+
+	// The exact sum rounded once, keeping the low 32 bits where it overflows
+	bool exact = true;
+	for (size_t i = 0; i < Count; i++)
+	{
+		for (size_t c = 0; c < 3; c++)
+		{
+			int64_t sum = 0;
+			for (size_t k = 0; k < 3; k++)
+				sum += int64_t(matrix.Elements[k * 4 + c].Raw) * points[i][k].Raw;
+			int64_t translation = int64_t(matrix.Elements[12 + c].Raw) * 65536;
+			exact = exact && transformed[i][c].Raw == int32_t(uint32_t(uint64_t(sum + translation + 32768) >> 16));
+			exact = exact && directions[i][c].Raw == int32_t(uint32_t(uint64_t(sum + 32768) >> 16));
+		}
+	}
+	MATHS_CHECK(exact);
+}
+
+MATHS_TEST(AffineInverse)
+{
+	static_assert(std::is_base_of_v<mat4x3<float>, affine<float>> && sizeof(affine<float>) == 12 * sizeof(float));
+
+	MATHS_CHECK(AffineRoundTripError<double>() < 1e-12);
+	MATHS_CHECK(AffineRoundTripError<float>() < 1e-4f);
+
+	// The same inverse as the dense one, the rigid shortcut for rotation and translation,
+	// and the 12 elements unchanged through mat4x3
+	bool agrees = true;
+	for (int i = 0; i < 1000; i++)
+	{
+		affine<double> matrix = RandomAffine<double>();
+		affine<double> dense(mat4<double>::Inverse(affine<double>::ToMat4(matrix)));
+		agrees = agrees && MaxDifference<double>(affine<double>::Inverse(matrix), dense) < 1e-12;
+
+		affine<double> rigid = affine<double>::Translation(matrix.Cols[3]) * affine<double>::Rotation(Uniform(-180.0, 180.0), matrix.Cols[0]);
+		agrees = agrees && MaxDifference<double>(affine<double>::InverseRigid(rigid), affine<double>::Inverse(rigid)) < 1e-12;
+
+		affine<double> copy = affine<double>::ToMat4x3(matrix);
+		agrees = agrees && std::memcmp(copy.Elements, matrix.Elements, sizeof(matrix.Elements)) == 0;
+	}
+	MATHS_CHECK(agrees);
+}
\ No newline at end of file
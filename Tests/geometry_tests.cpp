@@ -0,0 +1,575 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Mesh normals and tangents: closed-form cases (a cube, flat and mirrored UV grids), float
+// against double on a curved grid, and tangents against a direct per-corner evaluation
+// of the MikkTSpace weighting. Light clusters: grid bounds against points unprojected
+// with the general inverse, and light lists against testing every light in every cluster.
+// Ray generation against unprojecting every pixel in double. Orientation and insphere
+// predicates on coplanar and cospherical lattice points, against exact 128-bit integer
+// determinants.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Geometry;
+using namespace Maths::Tests;
+
+namespace {
+
+	struct thread_count_scope
+	{
+		size_t Previous;
+		thread_count_scope(size_t threads) : Previous(Utils::MaxThreads.exchange(threads)) {}
+		~thread_count_scope() { Utils::MaxThreads.store(Previous); }
+	};
+
+	template <typename T>
+	struct test_mesh
+	{
+		std::vector<vec3<T>> Positions;
+		std::vector<vec2<T>> UVs;
+		std::vector<uint32_t> Indices;
+
+		size_t TriangleCount() const { return Indices.size() / 3; }
+		mesh_adjacency Adjacency() const { return mesh_adjacency::Build(Indices.data(), TriangleCount(), Positions.size()); }
+	};
+
+	// side x side quads over [0, 1]^2 with a bumpy height and distorted UVs, or with
+	// uv = (x, y) and a flat z = 0 when flat is set. mirrorU flips U.
+	template <typename T>
+	test_mesh<T> Grid(uint32_t side, bool flat, bool mirrorU = false)
+	{
+		test_mesh<T> mesh;
+		for (uint32_t y = 0; y <= side; y++)
+			for (uint32_t x = 0; x <= side; x++)
+			{
+				double u = double(x) / side, v = double(y) / side;
+				double z = flat ? 0.0 : 0.2 * std::sin(6.0 * u) * std::cos(5.0 * v);
+				mesh.Positions.push_back(vec3<T>(T(u), T(v), T(z)));
+
+				double s = flat ? u : u + 0.1 * std::sin(4.0 * v);
+				double t = flat ? v : v + 0.1 * u * u;
+				mesh.UVs.push_back(vec2<T>(T(mirrorU ? -s : s), T(t)));
+			}
+
+		// Alternate the diagonal so corner angles differ around each vertex
+		for (uint32_t y = 0; y < side; y++)
+			for (uint32_t x = 0; x < side; x++)
+			{
+				uint32_t i = y * (side + 1) + x;
+				uint32_t quad[4] = { i, i + 1, i + side + 2, i + side + 1 };
+				if ((x + y) % 2)
+					mesh.Indices.insert(mesh.Indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+				else
+					mesh.Indices.insert(mesh.Indices.end(), { quad[0], quad[1], quad[3], quad[1], quad[2], quad[3] });
+			}
+		return mesh;
+	}
+
+	template <typename T>
+	bool Close(const vec3<T>& lhs, const vec3<T>& rhs, double tolerance)
+	{
+		return std::abs(double(lhs.X - rhs.X)) < tolerance && std::abs(double(lhs.Y - rhs.Y)) < tolerance && std::abs(double(lhs.Z - rhs.Z)) < tolerance;
+	}
+
+	// MikkTSpace's per-vertex sum written out per corner: each corner's UV derivative and
+	// its edges are flattened onto the vertex's tangent plane, and the derivative is
+	// weighted by the angle between the flattened edges
+	vec4<double> ReferenceTangent(const test_mesh<double>& mesh, const vec3<double>& n, uint32_t vertex)
+	{
+		auto flatten = [&](vec3<double> e)
+		{
+			e -= n * vec3<double>::Dot(n, e);
+			double length = e.Magnitude();
+			return length > 0.0 ? e / length : e;
+		};
+
+		vec3<double> tangent(0.0), bitangent(0.0);
+		for (size_t t = 0; t < mesh.TriangleCount(); t++)
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				if (mesh.Indices[t * 3 + k] != vertex)
+					continue;
+
+				uint32_t i0 = mesh.Indices[t * 3], i1 = mesh.Indices[t * 3 + 1], i2 = mesh.Indices[t * 3 + 2];
+				vec3<double> e1 = mesh.Positions[i1] - mesh.Positions[i0], e2 = mesh.Positions[i2] - mesh.Positions[i0];
+				vec2<double> d1 = mesh.UVs[i1] - mesh.UVs[i0], d2 = mesh.UVs[i2] - mesh.UVs[i0];
+				double area = d1.X * d2.Y - d2.X * d1.Y;
+				vec3<double> dpdu = (e1 * d2.Y - e2 * d1.Y) / area;
+				vec3<double> dpdv = (e2 * d1.X - e1 * d2.X) / area;
+
+				const vec3<double>& p = mesh.Positions[vertex];
+				vec3<double> u = flatten(mesh.Positions[mesh.Indices[t * 3 + (k + 1) % 3]] - p);
+				vec3<double> w = flatten(mesh.Positions[mesh.Indices[t * 3 + (k + 2) % 3]] - p);
+				double angle = std::acos(std::fmin(std::fmax(vec3<double>::Dot(u, w), -1.0), 1.0));
+
+				tangent += flatten(dpdu) * angle;
+				bitangent += flatten(dpdv) * angle;
+			}
+
+		tangent = (tangent - n * vec3<double>::Dot(n, tangent)).Normalise();
+		return vec4<double>(tangent, vec3<double>::Dot(vec3<double>::Cross(n, tangent), bitangent) < 0.0 ? -1.0 : 1.0);
+	}
+
+	// Every light against every cluster, one at a time
+	light_list ReferenceLights(const cluster_grid<float>& grid, const mat4<float>& view, const std::vector<vec3<float>>& positions, const std::vector<float>& radii)
+	{
+		light_list lights;
+		lights.Offsets.push_back(0);
+		const float* m = view.Elements;
+		for (uint32_t cluster = 0; cluster < grid.ClusterCount(); cluster++)
+		{
+			const aabb<float>& box = grid.Bounds[cluster];
+			for (uint32_t light = 0; light < positions.size(); light++)
+			{
+				const vec3<float>& p = positions[light];
+				float x = m[0] * p.X + m[4] * p.Y + m[8] * p.Z + m[12];
+				float y = m[1] * p.X + m[5] * p.Y + m[9] * p.Z + m[13];
+				float z = m[2] * p.X + m[6] * p.Y + m[10] * p.Z + m[14];
+				if (box.IntersectsSphere(vec3<float>(x, y, z), radii[light]))
+					lights.Indices.push_back(light);
+			}
+			lights.Offsets.push_back(uint32_t(lights.Indices.size()));
+		}
+		return lights;
+	}
+
+#if defined(__SIZEOF_INT128__)
+	__extension__ typedef __int128 int128;
+
+	template <typename S>
+	int Sign(S value)
+	{
+		return value > S(0) ? 1 : (value < S(0) ? -1 : 0);
+	}
+
+	template <typename S>
+	S Determinant3(const S (&m)[3][3])
+	{
+		return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+			- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+			+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	}
+
+	// Shewchuk's determinants, exactly: orient3d = |a - d; b - d; c - d| and insphere the
+	// 4x4 with rows (p - e, |p - e|^2) for p = a, b, c, d
+	int ExactOrient3D(const vec3<int64_t>& a, const vec3<int64_t>& b, const vec3<int64_t>& c, const vec3<int64_t>& d)
+	{
+		int128 m[3][3];
+		const vec3<int64_t>* rows[3] = { &a, &b, &c };
+		for (int r = 0; r < 3; r++)
+			for (int k = 0; k < 3; k++)
+				m[r][k] = int128((*rows[r])[k] - d[k]);
+		return Sign(Determinant3(m));
+	}
+
+	// Evaluated in S: int128 for the exact sign, double for the naive one
+	template <typename S>
+	int InSphereSign(const vec3<int64_t>& a, const vec3<int64_t>& b, const vec3<int64_t>& c, const vec3<int64_t>& d, const vec3<int64_t>& e)
+	{
+		S m[4][4];
+		const vec3<int64_t>* rows[4] = { &a, &b, &c, &d };
+		for (int r = 0; r < 4; r++)
+		{
+			m[r][3] = S(0);
+			for (int k = 0; k < 3; k++)
+			{
+				m[r][k] = S((*rows[r])[k] - e[k]);
+				m[r][3] += m[r][k] * m[r][k];
+			}
+		}
+
+		// Expand along the lift column
+		S det = S(0);
+		for (int r = 0; r < 4; r++)
+		{
+			S minor[3][3];
+			for (int i = 0, row = 0; i < 4; i++)
+			{
+				if (i == r)
+					continue;
+				for (int k = 0; k < 3; k++)
+					minor[row][k] = m[i][k];
+				row++;
+			}
+			S term = m[r][3] * Determinant3(minor);
+			det += (r % 2 == 0) ? -term : term;
+		}
+		return Sign(det);
+	}
+
+	int ExactInSphere(const vec3<int64_t>& a, const vec3<int64_t>& b, const vec3<int64_t>& c, const vec3<int64_t>& d, const vec3<int64_t>& e)
+	{
+		return InSphereSign<int128>(a, b, c, d, e);
+	}
+
+	// The determinants in plain double arithmetic, which the lattice cases must defeat
+	// for the exact fallback to matter
+	int NaiveOrient3D(const vec3<int64_t>& a, const vec3<int64_t>& b, const vec3<int64_t>& c, const vec3<int64_t>& d)
+	{
+		double m[3][3];
+		const vec3<int64_t>* rows[3] = { &a, &b, &c };
+		for (int r = 0; r < 3; r++)
+			for (int k = 0; k < 3; k++)
+				m[r][k] = double((*rows[r])[k]) - double(d[k]);
+		double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+		return det > 0.0 ? 1 : (det < 0.0 ? -1 : 0);
+	}
+
+	int NaiveInSphere(const vec3<int64_t>& a, const vec3<int64_t>& b, const vec3<int64_t>& c, const vec3<int64_t>& d, const vec3<int64_t>& e)
+	{
+		return InSphereSign<double>(a, b, c, d, e);
+	}
+
+	template <typename T>
+	vec3<T> Point(const vec3<int64_t>& p)
+	{
+		return vec3<T>(T(p.X), T(p.Y), T(p.Z));
+	}
+
+	int64_t Lattice(int64_t range)
+	{
+		return int64_t(Random()() % uint32_t(2 * range + 1)) - range;
+	}
+#endif
+
+}
+
+MATHS_TEST(MeshNormalsCube)
+{
+	// Unit cube with shared corners and outward counter-clockwise faces
+	test_mesh<float> cube;
+	for (int i = 0; i < 8; i++)
+		cube.Positions.push_back(vec3<float>(float(i & 1), float((i >> 1) & 1), float((i >> 2) & 1)));
+	cube.Positions.push_back(vec3<float>(5.0f));	// Not part of any triangle
+	cube.Indices = {
+		0, 2, 3, 0, 3, 1,	4, 5, 7, 4, 7, 6,	// -Z, +Z
+		0, 1, 5, 0, 5, 4,	2, 6, 7, 2, 7, 3,	// -Y, +Y
+		0, 4, 6, 0, 6, 2,	1, 3, 7, 1, 7, 5 };	// -X, +X
+
+	// Angle weighting does not depend on which diagonal splits each face
+	std::vector<vec3<float>> normals(cube.Positions.size());
+	ComputeNormals(cube.Positions.data(), cube.Indices.data(), cube.TriangleCount(), cube.Adjacency(), normals.data());
+	bool corners = true;
+	for (int i = 0; i < 8; i++)
+	{
+		vec3<float> expected = (cube.Positions[i] * 2.0f - vec3<float>(1.0f)) / std::sqrt(3.0f);
+		corners = corners && Close(normals[i], expected, 1e-6);
+	}
+	MATHS_CHECK(corners);
+	MATHS_CHECK(normals[8] == vec3<float>(0.0f));
+
+	// Area weighting does: corner 0 is on the diagonal of all three of its faces, corner 1
+	// of only one
+	ComputeNormals(cube.Positions.data(), cube.Indices.data(), cube.TriangleCount(), cube.Adjacency(), normals.data(), normal_weighting::Area);
+	MATHS_CHECK(Close(normals[0], vec3<float>(-1.0f) / std::sqrt(3.0f), 1e-6));
+	MATHS_CHECK(!Close(normals[1], vec3<float>(1.0f, -1.0f, -1.0f) / std::sqrt(3.0f), 1e-3));
+}
+
+MATHS_TEST(MeshNormalsGrid)
+{
+	// 2 * 101^2 triangles: several ranges per thread, none a multiple of four long
+	test_mesh<float> mesh = Grid<float>(101, false);
+	test_mesh<double> reference = Grid<double>(101, false);
+	mesh_adjacency adjacency = mesh.Adjacency();
+
+	for (normal_weighting weighting : { normal_weighting::Angle, normal_weighting::Area })
+	{
+		std::vector<vec3<float>> serial(mesh.Positions.size()), threaded(mesh.Positions.size());
+		{
+			thread_count_scope threads(1);
+			ComputeNormals(mesh.Positions.data(), mesh.Indices.data(), mesh.TriangleCount(), adjacency, serial.data(), weighting);
+		}
+		{
+			thread_count_scope threads(4);
+			ComputeNormals(mesh.Positions.data(), mesh.Indices.data(), mesh.TriangleCount(), adjacency, threaded.data(), weighting);
+		}
+		MATHS_CHECK(std::memcmp(serial.data(), threaded.data(), serial.size() * sizeof(vec3<float>)) == 0);
+
+		std::vector<vec3<double>> expected(reference.Positions.size());
+		ComputeNormals(reference.Positions.data(), reference.Indices.data(), reference.TriangleCount(), adjacency, expected.data(), weighting);
+
+		bool close = true;
+		for (size_t v = 0; v < serial.size(); v++)
+		{
+			vec3<double> normal(serial[v].X, serial[v].Y, serial[v].Z);
+			close = close && Close(normal, expected[v], 1e-5) && expected[v].Z > 0.5;
+		}
+		MATHS_CHECK(close);
+	}
+}
+
+MATHS_TEST(MeshTangentsFlat)
+{
+	// uv = (x, y) on the z = 0 plane gives tangent +X; flipping U flips the tangent and
+	// the handedness, while the bitangent stays +Y
+	for (bool mirror : { false, true })
+	{
+		test_mesh<float> mesh = Grid<float>(9, true, mirror);
+		mesh_adjacency adjacency = mesh.Adjacency();
+		std::vector<vec3<float>> normals(mesh.Positions.size());
+		std::vector<vec4<float>> tangents(mesh.Positions.size());
+		ComputeNormals(mesh.Positions.data(), mesh.Indices.data(), mesh.TriangleCount(), adjacency, normals.data());
+		ComputeTangents(mesh.Positions.data(), mesh.UVs.data(), normals.data(), mesh.Indices.data(), mesh.TriangleCount(), adjacency, tangents.data());
+
+		float sign = mirror ? -1.0f : 1.0f;
+		bool correct = true;
+		for (size_t v = 0; v < tangents.size(); v++)
+		{
+			const vec4<float>& t = tangents[v];
+			vec3<float> bitangent = vec3<float>::Cross(normals[v], vec3<float>(t.X, t.Y, t.Z)) * t.W;
+			correct = correct && Close(vec3<float>(t.X, t.Y, t.Z), vec3<float>(sign, 0.0f, 0.0f), 1e-6) && t.W == sign;
+			correct = correct && Close(bitangent, vec3<float>(0.0f, 1.0f, 0.0f), 1e-6);
+		}
+		MATHS_CHECK(correct);
+	}
+
+	// A mirrored copy sharing no vertices, as a split index buffer has at the seam
+	test_mesh<float> left = Grid<float>(4, true), right = Grid<float>(4, true, true);
+	test_mesh<float> both = left;
+	uint32_t offset = uint32_t(left.Positions.size());
+	both.Positions.insert(both.Positions.end(), right.Positions.begin(), right.Positions.end());
+	both.UVs.insert(both.UVs.end(), right.UVs.begin(), right.UVs.end());
+	for (uint32_t index : right.Indices)
+		both.Indices.push_back(index + offset);
+
+	std::vector<vec3<float>> normals(both.Positions.size());
+	std::vector<vec4<float>> tangents(both.Positions.size());
+	mesh_adjacency adjacency = both.Adjacency();
+	ComputeNormals(both.Positions.data(), both.Indices.data(), both.TriangleCount(), adjacency, normals.data());
+	ComputeTangents(both.Positions.data(), both.UVs.data(), normals.data(), both.Indices.data(), both.TriangleCount(), adjacency, tangents.data());
+	bool split = true;
+	for (size_t v = 0; v < tangents.size(); v++)
+		split = split && tangents[v].W == (v < offset ? 1.0f : -1.0f) && std::abs(tangents[v].X) > 0.999999f;
+	MATHS_CHECK(split);
+}
+
+MATHS_TEST(MeshTangentsCurved)
+{
+	test_mesh<float> mesh = Grid<float>(41, false);
+	test_mesh<double> reference = Grid<double>(41, false);
+	mesh_adjacency adjacency = mesh.Adjacency();
+
+	std::vector<vec3<float>> normals(mesh.Positions.size());
+	std::vector<vec4<float>> tangents(mesh.Positions.size());
+	ComputeNormals(mesh.Positions.data(), mesh.Indices.data(), mesh.TriangleCount(), adjacency, normals.data());
+	ComputeTangents(mesh.Positions.data(), mesh.UVs.data(), normals.data(), mesh.Indices.data(), mesh.TriangleCount(), adjacency, tangents.data());
+
+	std::vector<vec3<double>> expectedNormals(reference.Positions.size());
+	ComputeNormals(reference.Positions.data(), reference.Indices.data(), reference.TriangleCount(), adjacency, expectedNormals.data());
+
+	bool orthonormal = true, matches = true;
+	for (uint32_t v = 0; v < tangents.size(); v++)
+	{
+		vec3<float> t(tangents[v].X, tangents[v].Y, tangents[v].Z);
+		orthonormal = orthonormal && std::abs(t.Magnitude() - 1.0f) < 1e-6f && std::abs(vec3<float>::Dot(t, normals[v])) < 1e-6f;
+
+		vec4<double> expected = ReferenceTangent(reference, expectedNormals[v], v);
+		matches = matches && Close(vec3<double>(t.X, t.Y, t.Z), vec3<double>(expected.X, expected.Y, expected.Z), 1e-5) && double(tangents[v].W) == expected.W;
+	}
+	MATHS_CHECK(orthonormal);
+	MATHS_CHECK(matches);
+}
+
+MATHS_TEST(ClusterGridBounds)
+{
+	const double n = 0.1, f = 200.0;
+	const mat4<double> projections[] = {
+		mat4<double>::Perspective(70.0f, 16.0f / 9.0f, float(n), float(f)),
+		mat4<double>::PerspectiveReverseZ(50.0f, 1.0f, float(n), float(f)),
+		mat4<double>::Frustum(-0.03f, 0.09f, -0.05f, 0.04f, float(n), float(f))
+	};
+
+	for (const mat4<double>& projection : projections)
+	{
+		cluster_grid<double> grid = cluster_grid<double>::Build(projection, 12, 7, 16, n, f);
+		MATHS_CHECK(grid.Bounds.size() == grid.ClusterCount() && grid.ClusterCount() == 12 * 7 * 16);
+		MATHS_CHECK(grid.SliceDepth(0) == n && std::abs(grid.SliceDepth(16) - f) < 1e-9 * f);
+
+		// Points at random NDC x, y and view depth must fall in the box of their cluster
+		mat4<double> inverse = mat4<double>::Inverse(projection);
+		bool contained = true;
+		for (int i = 0; i < 2000; i++)
+		{
+			double ndcX = Uniform(-0.999, 0.999), ndcY = Uniform(-0.999, 0.999);
+			double depth = n * std::pow(f / n, Uniform(0.001, 0.999));
+			vec4<double> p = inverse * vec4<double>(ndcX, ndcY, 0.5, 1.0);
+			vec3<double> point = vec3<double>(p.X, p.Y, p.Z) * (depth / -p.Z);
+
+			uint32_t x = uint32_t((ndcX + 1.0) * 0.5 * grid.DimX);
+			uint32_t y = uint32_t((ndcY + 1.0) * 0.5 * grid.DimY);
+			uint32_t z = uint32_t(grid.DimZ * std::log(depth / n) / std::log(f / n));
+			const aabb<double>& box = grid.Bounds[grid.Index(x, y, z)];
+			contained = contained && box.DistanceSquared(point) <= (1e-9 * depth) * (1e-9 * depth);
+		}
+		MATHS_CHECK(contained);
+	}
+}
+
+MATHS_TEST(AssignLightsMatchesReference)
+{
+	cluster_grid<float> grid = cluster_grid<float>::Build(mat4<float>::Perspective(60.0f, 1.5f, 0.1f, 100.0f), 16, 9, 24, 0.1f, 100.0f);
+	mat4<float> view = mat4<float>::LookAt(vec3<float>(3.0f, 2.0f, 10.0f), vec3<float>(0.0f, 0.0f, -20.0f));
+
+	// Not a multiple of four, from point-like to radii spanning many clusters, some
+	// behind the camera or outside the frustum
+	constexpr size_t Count = 1003;
+	std::vector<vec3<float>> positions(Count);
+	std::vector<float> radii(Count);
+	for (size_t i = 0; i < Count; i++)
+	{
+		positions[i] = vec3<float>(Uniform(-60.0f, 60.0f), Uniform(-40.0f, 40.0f), Uniform(-100.0f, 15.0f));
+		radii[i] = i % 10 ? Uniform(0.01f, 3.0f) : Uniform(3.0f, 20.0f);
+	}
+
+	light_list expected = ReferenceLights(grid, view, positions, radii);
+	MATHS_CHECK(expected.Indices.size() > Count && expected.Offsets.back() == expected.Indices.size());
+
+	for (size_t threads : { 1, 4 })
+	{
+		thread_count_scope scope(threads);
+		light_list lights;
+		AssignLights(grid, view, positions.data(), radii.data(), Count, lights);
+		MATHS_CHECK(lights.Offsets == expected.Offsets);
+		MATHS_CHECK(lights.Indices == expected.Indices);
+	}
+
+	// Fewer lights than a lanes4 group only take the scalar tail
+	std::vector<vec3<float>> fewPositions = { positions[0], positions[10], positions[20] };
+	std::vector<float> fewRadii = { radii[0], radii[10], radii[20] };
+	light_list few, fewExpected = ReferenceLights(grid, view, fewPositions, fewRadii);
+	AssignLights(grid, view, fewPositions.data(), fewRadii.data(), fewPositions.size(), few);
+	MATHS_CHECK(few.Offsets == fewExpected.Offsets && few.Indices == fewExpected.Indices && !few.Indices.empty());
+
+	AssignLights(grid, view, positions.data(), radii.data(), 0, few);
+	MATHS_CHECK(few.Indices.empty() && few.Offsets.size() == grid.ClusterCount() + 1 && few.Offsets.back() == 0);
+}
+
+MATHS_TEST(GenerateRaysWideRows)
+{
+	// A wide screen, where stepping from pixel to pixel used to drift along each row
+	constexpr uint32_t Width = 3840, Height = 24;
+	mat4<float> view = mat4<float>::LookAt(vec3<float>(3.0f, 2.0f, 10.0f), vec3<float>(0.0f, 0.0f, -20.0f));
+	mat4<float> inverse = mat4<float>::Inverse(mat4<float>::Perspective(90.0f, 16.0f / 9.0f, 0.1f, 1000.0f) * view);
+	mat4<double> reference;
+	for (size_t i = 0; i < 16; i++)
+		reference.Elements[i] = inverse.Elements[i];
+
+	std::vector<ray<float>> rays(size_t(Width) * Height);
+	GenerateRays(inverse, Width, Height, -1.0f, 1.0f, rays.data());
+
+	double origin = 0.0, direction = 0.0;
+	for (uint32_t row = 0; row < Height; row++)
+	{
+		for (uint32_t col = 0; col < Width; col++)
+		{
+			double x = -1.0 + (col + 0.5) * 2.0 / Width, y = 1.0 - (row + 0.5) * 2.0 / Height;
+			ray<double> expected = UnprojectRay(reference, x, y, -1.0, 1.0);
+			const ray<float>& generated = rays[size_t(row) * Width + col];
+			for (size_t k = 0; k < 3; k++)
+			{
+				origin = std::max(origin, std::abs(generated.Origin[k] - expected.Origin[k]));
+				direction = std::max(direction, std::abs(generated.Direction[k] - expected.Direction[k]));
+			}
+		}
+	}
+	MATHS_CHECK(origin < 1e-5 && direction < 1e-6);
+}
+
+#if defined(__SIZEOF_INT128__)
+MATHS_TEST(Orient3DLattice)
+{
+	// b - a and c - a span a plane; d is a small lattice combination of them, so exactly
+	// coplanar, or one unit off it. Coordinates up to 2^20 keep float inputs exact while
+	// the triple products reach 2^60, past what double holds.
+	int degenerate = 0, naiveWrong = 0;
+	bool correct = true;
+	for (int i = 0; i < 4000; i++)
+	{
+		vec3<int64_t> a(Lattice(1 << 19), Lattice(1 << 19), Lattice(1 << 19));
+		vec3<int64_t> u(Lattice(1 << 18), Lattice(1 << 18), Lattice(1 << 18));
+		vec3<int64_t> v(Lattice(1 << 18), Lattice(1 << 18), Lattice(1 << 18));
+		vec3<int64_t> b = a + u, c = a + v;
+		vec3<int64_t> d = a + u * Lattice(1) + v * (Lattice(1) + 1);
+		if (i % 2)
+			d[size_t(i / 2 % 3)] += (i / 6) % 2 ? 1 : -1;
+
+		int expected = ExactOrient3D(a, b, c, d);
+		degenerate += expected == 0;
+		naiveWrong += NaiveOrient3D(a, b, c, d) != expected;
+
+		correct = correct && Orient3D(Point<double>(a), Point<double>(b), Point<double>(c), Point<double>(d)) == expected;
+		correct = correct && Orient3D(Point<float>(a), Point<float>(b), Point<float>(c), Point<float>(d)) == expected;
+		correct = correct && Orient3D(Point<double>(b), Point<double>(a), Point<double>(c), Point<double>(d)) == -expected;
+		correct = correct && Orient3D(Point<double>(d), Point<double>(b), Point<double>(c), Point<double>(a)) == -expected;
+	}
+	MATHS_CHECK(correct);
+	MATHS_CHECK(degenerate >= 2000 && naiveWrong > 20);
+
+	// d below the counterclockwise triangle a, b, c seen from +z
+	vec3<double> a(0.0, 0.0, 0.0), b(1.0, 0.0, 0.0), c(0.0, 1.0, 0.0);
+	MATHS_CHECK(Orient3D(a, b, c, vec3<double>(0.2, 0.2, -1.0)) == 1 && Orient3D(a, b, c, vec3<double>(0.2, 0.2, 1e-300)) == -1);
+}
+
+MATHS_TEST(InSphereLattice)
+{
+	// Lattice points on the sphere x^2 + y^2 + z^2 = 65^2, scaled by 16383 and moved to
+	// a random centre: any five are cospherical and one unit moves e just off the sphere.
+	// An odd scale keeps the lifted products from being exact in double, so rounding
+	// hides the sign of the degenerate cases.
+	std::vector<vec3<int64_t>> sphere;
+	for (int64_t x = -65; x <= 65; x++)
+		for (int64_t y = -65; y <= 65; y++)
+		{
+			int64_t rest = 65 * 65 - x * x - y * y;
+			int64_t z = int64_t(std::lround(std::sqrt(double(std::max<int64_t>(rest, 0)))));
+			if (rest >= 0 && z * z == rest)
+			{
+				sphere.push_back(vec3<int64_t>(x, y, z) * 16383);
+				if (z != 0)
+					sphere.push_back(vec3<int64_t>(x, y, -z) * 16383);
+			}
+		}
+
+	int degenerate = 0, tested = 0, naiveWrong = 0;
+	bool correct = true;
+	for (int i = 0; i < 3000; i++)
+	{
+		vec3<int64_t> centre(Lattice(1 << 18), Lattice(1 << 18), Lattice(1 << 18));
+		vec3<int64_t> p[5];
+		for (vec3<int64_t>& point : p)
+			point = centre + sphere[Random()() % sphere.size()];
+
+		int orientation = ExactOrient3D(p[0], p[1], p[2], p[3]);
+		if (orientation == 0)
+			continue;
+		if (orientation < 0)
+			std::swap(p[0], p[1]);
+		if (i % 3)
+			p[4][size_t(i % 3)] += (i / 3) % 2 ? 1 : -1;
+
+		int expected = ExactInSphere(p[0], p[1], p[2], p[3], p[4]);
+		degenerate += expected == 0;
+		naiveWrong += NaiveInSphere(p[0], p[1], p[2], p[3], p[4]) != expected;
+		tested++;
+
+		correct = correct && InSphere(Point<double>(p[0]), Point<double>(p[1]), Point<double>(p[2]), Point<double>(p[3]), Point<double>(p[4])) == expected;
+		correct = correct && InSphere(Point<float>(p[0]), Point<float>(p[1]), Point<float>(p[2]), Point<float>(p[3]), Point<float>(p[4])) == expected;
+		correct = correct && InSphere(Point<double>(p[1]), Point<double>(p[0]), Point<double>(p[2]), Point<double>(p[3]), Point<double>(p[4])) == -expected;
+
+		// The centre is inside and a point beyond the radius outside
+		correct = correct && InSphere(Point<double>(p[0]), Point<double>(p[1]), Point<double>(p[2]), Point<double>(p[3]), Point<double>(centre)) == 1;
+		correct = correct && ExactInSphere(p[0], p[1], p[2], p[3], centre) == 1;
+		correct = correct && InSphere(Point<double>(p[0]), Point<double>(p[1]), Point<double>(p[2]), Point<double>(p[3]), Point<double>(centre + vec3<int64_t>(0, 0, 2000000))) == -1;
+	}
+	MATHS_CHECK(correct);
+	MATHS_CHECK(tested > 2000 && degenerate > 500 && degenerate < tested && naiveWrong > 200);
+}
+#endif
\ No newline at end of file
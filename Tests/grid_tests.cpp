@@ -0,0 +1,352 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+// spatial_grid queries against brute force, for both cell orders, after incremental
+// updates, and for point sets spanning more cells than the curve keys can tell apart.
+// The curve keys themselves: bit interleaving, aligned cubes as contiguous key ranges,
+// Hilbert steps between neighbouring cells, the batch encoders and the radix sort.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Tests;
+
+namespace {
+
+	struct thread_count_scope
+	{
+		size_t Previous = Utils::MaxThreads.exchange(4);
+		~thread_count_scope() { Utils::MaxThreads.store(Previous); }
+	};
+
+	// Bit i of x, y and z at bits 3i, 3i + 1 and 3i + 2, one bit at a time
+	uint64_t Interleave(uint64_t x, uint64_t y, uint64_t z, uint32_t bits)
+	{
+		uint64_t key = 0;
+		for (uint32_t i = 0; i < bits; i++)
+			key |= ((x >> i) & 1) << (3 * i) | ((y >> i) & 1) << (3 * i + 1) | ((z >> i) & 1) << (3 * i + 2);
+		return key;
+	}
+
+	// The cells of the side^3 cube at base, ordered by key
+	template <typename Key>
+	std::vector<std::pair<uint64_t, vec3<uint64_t>>> CubeKeys(const vec3<uint64_t>& base, uint64_t side, Key key)
+	{
+		std::vector<std::pair<uint64_t, vec3<uint64_t>>> cells;
+		for (uint64_t z = 0; z < side; z++)
+			for (uint64_t y = 0; y < side; y++)
+				for (uint64_t x = 0; x < side; x++)
+				{
+					vec3<uint64_t> cell(base.X + x, base.Y + y, base.Z + z);
+					cells.push_back({ uint64_t(key(cell.X, cell.Y, cell.Z)), cell });
+				}
+		std::sort(cells.begin(), cells.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+		return cells;
+	}
+
+	// An aligned cube covers one contiguous range of keys; along a Hilbert curve each
+	// key is also a face neighbour of the one before
+	template <typename Key>
+	bool CubeIsRange(const vec3<uint64_t>& base, uint64_t side, Key key, bool adjacent)
+	{
+		std::vector<std::pair<uint64_t, vec3<uint64_t>>> cells = CubeKeys(base, side, key);
+		bool correct = cells.back().first - cells.front().first == cells.size() - 1 && cells.front().first % cells.size() == 0;
+		for (size_t i = 1; i < cells.size() && adjacent; i++)
+		{
+			const vec3<uint64_t>& a = cells[i - 1].second;
+			const vec3<uint64_t>& b = cells[i].second;
+			uint64_t steps = (a.X > b.X ? a.X - b.X : b.X - a.X) + (a.Y > b.Y ? a.Y - b.Y : b.Y - a.Y) + (a.Z > b.Z ? a.Z - b.Z : b.Z - a.Z);
+			correct = correct && cells[i].first == cells[i - 1].first + 1 && steps == 1;
+		}
+		return correct;
+	}
+
+	// The cell Quantise in MortonKeys and HilbertKeys gives, clamping NaN and points
+	// outside the bounds
+	uint32_t Cell(float v, float min, float max, uint32_t maxCell)
+	{
+		float cell = (v - min) * (float(maxCell) / (max - min));
+		if (!(cell > 0.0f))
+			return 0;
+		return cell >= float(maxCell) ? maxCell : uint32_t(cell);
+	}
+
+	std::vector<uint32_t> BruteRadius(const std::vector<vec3<float>>& points, const vec3<float>& centre, float radius)
+	{
+		std::vector<uint32_t> result;
+		for (uint32_t i = 0; i < points.size(); i++)
+		{
+			vec3<float> d = points[i] - centre;
+			if (d.X * d.X + d.Y * d.Y + d.Z * d.Z <= radius * radius)
+				result.push_back(i);
+		}
+		return result;
+	}
+
+	// Distance of the k-th nearest point, so ties at the boundary do not fail the check
+	float KthDistance(const std::vector<vec3<float>>& points, const vec3<float>& centre, size_t k)
+	{
+		std::vector<float> distances;
+		for (const vec3<float>& point : points)
+			distances.push_back(vec3<float>::Dot(point - centre, point - centre));
+		std::nth_element(distances.begin(), distances.begin() + (k - 1), distances.end());
+		return distances[k - 1];
+	}
+
+	bool MatchesBruteForce(const Spatial::spatial_grid<float>& grid, const std::vector<vec3<float>>& points, float extent, float radius)
+	{
+		constexpr uint32_t K = 8;
+
+		bool correct = true;
+		std::vector<uint32_t> found;
+		for (int query = 0; query < 200; query++)
+		{
+			vec3<float> centre(Uniform(-extent, extent), Uniform(-extent, extent), Uniform(-extent, extent));
+
+			grid.QueryRadius(centre, radius, found);
+			std::sort(found.begin(), found.end());
+			correct = correct && found == BruteRadius(points, centre, radius);
+
+			grid.QueryKNearest(centre, K, found);
+			float kth = KthDistance(points, centre, K);
+			correct = correct && found.size() == K;
+			for (uint32_t index : found)
+				correct = correct && vec3<float>::Dot(points[index] - centre, points[index] - centre) <= kth;
+		}
+		return correct;
+	}
+
+}
+
+MATHS_TEST(SpatialGridQueries)
+{
+	constexpr size_t PointCount = 20000;
+	const float Extent = 50.0f;
+
+	std::vector<vec3<float>> points(PointCount);
+	for (vec3<float>& point : points)
+		point = vec3<float>(Uniform(-Extent, Extent), Uniform(-Extent, Extent), Uniform(-Extent, Extent));
+
+	for (Spatial::space_curve curve : { Spatial::space_curve::Morton, Spatial::space_curve::Hilbert })
+	{
+		Spatial::spatial_grid<float> grid(2.0f);
+		grid.CellOrder = curve;
+		grid.RebuildFraction = 0.5f;
+		grid.Build(points.data(), points.size());
+		MATHS_CHECK(MatchesBruteForce(grid, points, Extent, 3.0f));
+
+		// Small moves keep most points in their cell; the rest go to the overflow list
+		std::vector<vec3<float>> moved = points;
+		for (vec3<float>& point : moved)
+			point += vec3<float>(Uniform(-0.1f, 0.1f), Uniform(-0.1f, 0.1f), Uniform(-0.1f, 0.1f));
+		grid.Update(moved.data());
+		MATHS_CHECK(grid.MovedCount() > 0);
+		MATHS_CHECK(MatchesBruteForce(grid, moved, Extent, 3.0f));
+	}
+}
+
+// Cells more than 2^21 apart share curve keys, and each cell must still be one range
+MATHS_TEST(SpatialGridWideRange)
+{
+	std::vector<vec3<float>> points;
+	for (int i = 0; i < 4000; i++)
+	{
+		float offset = float(i % 4) * 4194304.0f;
+		points.push_back(vec3<float>(offset + Uniform(0.0f, 8.0f), Uniform(0.0f, 8.0f), Uniform(0.0f, 8.0f)));
+	}
+
+	Spatial::spatial_grid<float> grid(1.0f);
+	grid.Build(points.data(), points.size());
+
+	bool correct = true;
+	std::vector<uint32_t> found;
+	for (int i = 0; i < 4; i++)
+	{
+		vec3<float> centre(float(i) * 4194304.0f + 4.0f, 4.0f, 4.0f);
+		grid.QueryRadius(centre, 2.5f, found);
+		std::sort(found.begin(), found.end());
+		correct = correct && found == BruteRadius(points, centre, 2.5f);
+	}
+	MATHS_CHECK(correct);
+}
+
+// Queries from far outside the occupied cells, and a sparse set with a large k: the
+// shells must start at the grid bounds instead of walking the empty cells up to them
+MATHS_TEST(SpatialGridOutsideQueries)
+{
+	std::vector<vec3<float>> points;
+	for (int i = 0; i < 1000; i++)
+		points.push_back(vec3<float>(Uniform(0.0f, 8.0f), Uniform(0.0f, 8.0f), Uniform(0.0f, 8.0f)));
+
+	Spatial::spatial_grid<float> grid(1.0f);
+	grid.Build(points.data(), points.size());
+
+	bool correct = true;
+	std::vector<uint32_t> found;
+	for (float distance : { 200.0f, 800.0f, 3000.0f, 1e6f })
+	{
+		for (const vec3<float>& centre : { vec3<float>(distance, 4.0f, 4.0f), vec3<float>(-distance, -distance, 4.0f), vec3<float>(4.0f, 4.0f, -distance) })
+		{
+			grid.QueryKNearest(centre, 8, found);
+			float kth = KthDistance(points, centre, 8);
+			correct = correct && found.size() == 8;
+			for (uint32_t index : found)
+				correct = correct && vec3<float>::Dot(points[index] - centre, points[index] - centre) <= kth;
+		}
+	}
+	MATHS_CHECK(correct);
+
+	// 50 points spread over a 2000 cell wide box, asking for most of them
+	std::vector<vec3<float>> sparse;
+	for (int i = 0; i < 50; i++)
+		sparse.push_back(vec3<float>(Uniform(0.0f, 2000.0f), Uniform(0.0f, 2000.0f), Uniform(0.0f, 2000.0f)));
+	grid.Build(sparse.data(), sparse.size());
+
+	correct = true;
+	for (int query = 0; query < 20; query++)
+	{
+		vec3<float> centre(Uniform(-500.0f, 2500.0f), Uniform(-500.0f, 2500.0f), Uniform(-500.0f, 2500.0f));
+		grid.QueryKNearest(centre, 40, found);
+		float kth = KthDistance(sparse, centre, 40);
+		correct = correct && found.size() == 40;
+		for (uint32_t index : found)
+			correct = correct && vec3<float>::Dot(sparse[index] - centre, sparse[index] - centre) <= kth;
+	}
+	MATHS_CHECK(correct);
+}
+
+MATHS_TEST(CurveKeysInterleave)
+{
+	bool correct = true;
+	for (int i = 0; i < 10000; i++)
+	{
+		uint32_t x = Random()() & 0x3FF, y = Random()() & 0x3FF, z = Random()() & 0x3FF;
+		correct = correct && Spatial::Morton30(x, y, z) == Interleave(x, y, z, 10);
+
+		uint64_t wx = Random()() & 0x1FFFFF, wy = Random()() & 0x1FFFFF, wz = Random()() & 0x1FFFFF;
+		correct = correct && Spatial::Morton63(wx, wy, wz) == Interleave(wx, wy, wz, 21);
+
+		// The 30-bit curves are the 63-bit ones on a grid 2^11 times coarser
+		correct = correct && Spatial::Hilbert30(x, y, z) < (1u << 30) && Spatial::Morton30(x, y, z) == Spatial::Morton63(x, y, z);
+	}
+	MATHS_CHECK(correct);
+	MATHS_CHECK(Spatial::Morton30(1, 0, 0) == 1 && Spatial::Morton30(0, 1, 0) == 2 && Spatial::Morton30(0, 0, 1) == 4);
+	MATHS_CHECK(Spatial::Morton30(0x3FF, 0x3FF, 0x3FF) == (1u << 30) - 1 && Spatial::Morton63(0x1FFFFF, 0x1FFFFF, 0x1FFFFF) == (uint64_t(1) << 63) - 1);
+	MATHS_CHECK(Spatial::Hilbert30(0, 0, 0) == 0 && Spatial::Hilbert63(0, 0, 0) == 0);
+}
+
+MATHS_TEST(CurveKeysLocality)
+{
+	auto morton30 = [](uint64_t x, uint64_t y, uint64_t z) { return Spatial::Morton30(uint32_t(x), uint32_t(y), uint32_t(z)); };
+	auto hilbert30 = [](uint64_t x, uint64_t y, uint64_t z) { return Spatial::Hilbert30(uint32_t(x), uint32_t(y), uint32_t(z)); };
+	auto morton63 = [](uint64_t x, uint64_t y, uint64_t z) { return Spatial::Morton63(x, y, z); };
+	auto hilbert63 = [](uint64_t x, uint64_t y, uint64_t z) { return Spatial::Hilbert63(x, y, z); };
+
+	// The 16^3 cube at the origin holds the first 4096 keys of every curve
+	vec3<uint64_t> origin(0, 0, 0);
+	MATHS_CHECK(CubeIsRange(origin, 16, morton30, false) && CubeIsRange(origin, 16, morton63, false));
+	MATHS_CHECK(CubeIsRange(origin, 16, hilbert30, true) && CubeIsRange(origin, 16, hilbert63, true));
+	MATHS_CHECK(CubeKeys(origin, 16, hilbert30).front().first == 0 && CubeKeys(origin, 16, morton63).back().first == 4095);
+
+	// Aligned cubes anywhere in the grid
+	bool correct = true;
+	for (int i = 0; i < 50; i++)
+	{
+		uint64_t side = uint64_t(1) << (1 + i % 3);
+		vec3<uint64_t> base((Random()() & 0x3FF) & ~(side - 1), (Random()() & 0x3FF) & ~(side - 1), (Random()() & 0x3FF) & ~(side - 1));
+		correct = correct && CubeIsRange(base, side, morton30, false) && CubeIsRange(base, side, hilbert30, true);
+
+		vec3<uint64_t> wide((Random()() & 0x1FFFFF) & ~(side - 1), (Random()() & 0x1FFFFF) & ~(side - 1), (Random()() & 0x1FFFFF) & ~(side - 1));
+		correct = correct && CubeIsRange(wide, side, morton63, false) && CubeIsRange(wide, side, hilbert63, true);
+	}
+	MATHS_CHECK(correct);
+
+	// Morton order is x fastest inside each 2x2x2 block
+	std::vector<std::pair<uint64_t, vec3<uint64_t>>> block = CubeKeys(vec3<uint64_t>(6, 2, 10), 2, morton30);
+	for (uint64_t i = 0; i < 8; i++)
+		MATHS_CHECK(block[i].second == vec3<uint64_t>(6 + (i & 1), 2 + ((i >> 1) & 1), 10 + (i >> 2)));
+}
+
+MATHS_TEST(CurveKeysBatch)
+{
+	// A count that leaves a remainder after groups of four, with points outside the
+	// bounds, infinities and NaN
+	constexpr size_t Count = 1003;
+	std::vector<vec3<float>> points(Count);
+	for (vec3<float>& point : points)
+		point = vec3<float>(Uniform(-12.0f, 12.0f), Uniform(-1.0f, 11.0f), Uniform(-0.5f, 0.5f));
+	points[4].X = std::numeric_limits<float>::quiet_NaN();
+	points[9].Y = std::numeric_limits<float>::infinity();
+	points[10].Z = -std::numeric_limits<float>::infinity();
+	points[Count - 1] = vec3<float>(-10.0f, 0.0f, 0.25f);
+	Geometry::aabb<float> bounds{ vec3<float>(-10.0f, 0.0f, -0.25f), vec3<float>(10.0f, 10.0f, 0.25f) };
+
+	std::vector<uint32_t> morton(Count), hilbert(Count);
+	std::vector<uint64_t> morton63(Count), hilbert63(Count);
+	Spatial::MortonKeys(points.data(), Count, bounds, morton.data());
+	Spatial::HilbertKeys(points.data(), Count, bounds, hilbert.data());
+	Spatial::MortonKeys(points.data(), Count, bounds, morton63.data());
+	Spatial::HilbertKeys(points.data(), Count, bounds, hilbert63.data());
+
+	bool correct = true;
+	for (size_t i = 0; i < Count; i++)
+	{
+		const vec3<float>& p = points[i];
+		uint32_t x = Cell(p.X, bounds.Min.X, bounds.Max.X, 0x3FF), y = Cell(p.Y, bounds.Min.Y, bounds.Max.Y, 0x3FF), z = Cell(p.Z, bounds.Min.Z, bounds.Max.Z, 0x3FF);
+		correct = correct && morton[i] == Spatial::Morton30(x, y, z) && hilbert[i] == Spatial::Hilbert30(x, y, z);
+
+		uint64_t wx = Cell(p.X, bounds.Min.X, bounds.Max.X, 0x1FFFFF), wy = Cell(p.Y, bounds.Min.Y, bounds.Max.Y, 0x1FFFFF), wz = Cell(p.Z, bounds.Min.Z, bounds.Max.Z, 0x1FFFFF);
+		correct = correct && morton63[i] == Spatial::Morton63(wx, wy, wz) && hilbert63[i] == Spatial::Hilbert63(wx, wy, wz);
+	}
+	MATHS_CHECK(correct);
+	MATHS_CHECK((morton[4] & 0x09249249u) == 0);
+	MATHS_CHECK(morton[Count - 1] == Spatial::Morton30(0, 0, 0x3FF));
+}
+
+MATHS_TEST(SortByKeyMatchesStableSort)
+{
+	thread_count_scope threads;
+
+	// Keys differing only in some bytes, so passes are skipped, with many duplicates to
+	// check stability, over enough keys for several chunks
+	constexpr size_t Count = 100003;
+	std::vector<uint64_t> keys(Count);
+	for (uint64_t& key : keys)
+		key = (uint64_t(Random()() % 300) << 40) | (uint64_t(Random()() & 0xF) << 8) | 0xAB000000000000ull;
+
+	std::vector<uint32_t> expected(Count);
+	std::iota(expected.begin(), expected.end(), 0u);
+	std::stable_sort(expected.begin(), expected.end(), [&](uint32_t lhs, uint32_t rhs) { return keys[lhs] < keys[rhs]; });
+
+	std::vector<uint64_t> sorted = keys;
+	std::vector<uint32_t> order(Count);
+	Spatial::SortByKey(sorted.data(), Count, order.data());
+	MATHS_CHECK(order == expected);
+	bool keysMatch = true;
+	for (size_t i = 0; i < Count; i++)
+		keysMatch = keysMatch && sorted[i] == keys[order[i]];
+	MATHS_CHECK(keysMatch && std::is_sorted(sorted.begin(), sorted.end()));
+
+	// 30-bit keys across all four bytes, and the trivial sizes
+	std::vector<uint32_t> small(5000), smallOrder(5000);
+	for (uint32_t& key : small)
+		key = Random()() & 0x3FFFFFFF;
+	std::vector<uint32_t> smallSorted = small;
+	Spatial::SortByKey(smallSorted.data(), small.size(), smallOrder.data());
+	bool smallMatch = std::is_sorted(smallSorted.begin(), smallSorted.end());
+	for (size_t i = 0; i < small.size(); i++)
+		smallMatch = smallMatch && smallSorted[i] == small[smallOrder[i]];
+	MATHS_CHECK(smallMatch);
+
+	uint32_t one = 42, oneOrder = 7;
+	Spatial::SortByKey(&one, 1, &oneOrder);
+	Spatial::SortByKey(&one, 0, &oneOrder);
+	MATHS_CHECK(one == 42 && oneOrder == 0);
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Utils/accuracy.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// Minimal test registry for maths_tests. Tests register themselves with MATHS_TEST and
+// report failed expectations with MATHS_CHECK; accuracy results are collected with
+// ReportAccuracy and printed by main next to the instrumentation counters.
+
+namespace Maths::Tests {
+
+	using test_function = void (*)();
+
+	struct test_case
+	{
+		const char* Name;
+		test_function Run;
+	};
+
+	// One row of the accuracy table. Rows without a limit only report: they cover inputs
+	// such as overflowing magnitudes where a large error is expected.
+	struct accuracy_row
+	{
+		std::string Kernel;
+		std::string Inputs;
+		Utils::ulp_stats Stats;
+		uint64_t Limit;
+	};
+
+	constexpr uint64_t ReportOnly = std::numeric_limits<uint64_t>::max();
+
+	std::vector<test_case>& Registry();
+	std::vector<accuracy_row>& AccuracyRows();
+
+	bool Register(const char* name, test_function run);
+	void Check(bool condition, const char* expression, const char* file, int line);
+
+	// Records the row, and fails the running test when the maximum error exceeds the limit
+	void ReportAccuracy(const std::string& kernel, const std::string& inputs, const Utils::ulp_stats& stats, uint64_t limit);
+
+	// Fixed seed so failures reproduce
+	std::mt19937& Random();
+
+	template <typename T>
+	T Uniform(T min, T max)
+	{
+		return std::uniform_real_distribution<T>(min, max)(Random());
+	}
+
+}
+
+#define MATHS_TEST_CONCAT_IMPL(a, b) a##b
+#define MATHS_TEST_CONCAT(a, b) MATHS_TEST_CONCAT_IMPL(a, b)
+
+#define MATHS_TEST(name) \
+	static void name(); \
+	static const bool MATHS_TEST_CONCAT(name, Registered) = ::Maths::Tests::Register(#name, name); \
+	static void name()
+
+#define MATHS_CHECK(condition) ::Maths::Tests::Check(bool(condition), #condition, __FILE__, __LINE__)
\ No newline at end of file
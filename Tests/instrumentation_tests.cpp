@@ -0,0 +1,68 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace Maths;
+using namespace Maths::Tests;
+
+namespace {
+
+	void InstrumentedKernel()
+	{
+		MATHS_PROFILE_KERNEL("InstrumentationThreadTest", 10, 40);
+	}
+
+	uint64_t InstrumentedCalls()
+	{
+		for (const Instrumentation::kernel_stats& kernel : Instrumentation::Aggregate())
+			if (kernel.Name == "InstrumentationThreadTest")
+				return kernel.Calls;
+		return 0;
+	}
+
+}
+
+// A thread that exits hands its slot to the next one: the registry and the trace thread
+// ids stay bounded however many short-lived threads come and go, and no count is lost
+MATHS_TEST(InstrumentationThreadSlots)
+{
+	constexpr size_t Threads = 500;
+
+	InstrumentedKernel();
+	uint64_t callsBefore = InstrumentedCalls();
+
+	size_t slotsBefore;
+	{
+		Instrumentation::Detail::registry& reg = Instrumentation::Detail::Registry();
+		std::lock_guard<std::mutex> lock(reg.Mutex);
+		slotsBefore = reg.Threads.size();
+	}
+
+	for (size_t i = 0; i < Threads; i++)
+	{
+		std::thread worker([]() { InstrumentedKernel(); InstrumentedKernel(); });
+		worker.join();
+	}
+
+	MATHS_CHECK(InstrumentedCalls() == callsBefore + 2 * Threads);
+
+	{
+		Instrumentation::Detail::registry& reg = Instrumentation::Detail::Registry();
+		std::lock_guard<std::mutex> lock(reg.Mutex);
+		MATHS_CHECK(reg.Threads.size() <= slotsBefore + 1);
+	}
+
+	std::ostringstream trace;
+	Instrumentation::WriteChromeTrace(trace);
+	std::string text = trace.str();
+	size_t largestId = 0;
+	for (size_t at = text.find("\"tid\":"); at != std::string::npos; at = text.find("\"tid\":", at + 1))
+		largestId = std::max<size_t>(largestId, std::stoul(text.substr(at + 6)));
+	MATHS_CHECK(largestId <= slotsBefore);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <cmath>
+
+// Interval arithmetic must enclose the exact result: every sample of the input interval is
+// evaluated in long double and has to land inside the computed bounds.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Tests;
+
+namespace {
+
+	template <typename T, typename F, typename R>
+	bool Encloses(const interval<T>& value, F function, R reference)
+	{
+		interval<T> result = function(value);
+		for (int i = 0; i <= 64; i++)
+		{
+			long double x = (long double)value.Lo + ((long double)value.Hi - (long double)value.Lo) * i / 64;
+			long double exact = reference(x);
+			if (exact < (long double)result.Lo || exact > (long double)result.Hi)
+				return false;
+		}
+		return true;
+	}
+
+	template <typename T>
+	bool IsFullRange(const interval<T>& value)
+	{
+		return value.Lo == T(-1) && value.Hi == T(1);
+	}
+
+	template <typename T>
+	void CheckTrigonometry(T maxMagnitude)
+	{
+		bool enclosed = true;
+		for (int i = 0; i < 20000; i++)
+		{
+			T centre = Uniform(-maxMagnitude, maxMagnitude);
+			T width = Uniform(T(0), T(7));
+			interval<T> value(centre, centre + width * Uniform(T(0), T(1)));
+			enclosed = enclosed && Encloses(value, [](const interval<T>& x) { return sin(x); }, [](long double x) { return std::sin(x); });
+			enclosed = enclosed && Encloses(value, [](const interval<T>& x) { return cos(x); }, [](long double x) { return std::cos(x); });
+		}
+		MATHS_CHECK(enclosed);
+	}
+
+}
+
+MATHS_TEST(IntervalTrigonometry)
+{
+	CheckTrigonometry<float>(100.0f);
+	CheckTrigonometry<double>(1e6);
+}
+
+// From 2^24 (float) or 2^53 (double) on, the search for extrema inside the interval used to
+// step a floating point counter that stopped advancing
+MATHS_TEST(IntervalTrigonometryHuge)
+{
+	const float floats[] = { 16777216.0f, 16777218.0f, 1e20f, std::numeric_limits<float>::max() };
+	for (float x : floats)
+	{
+		MATHS_CHECK(IsFullRange(sin(interval<float>(x, x))));
+		MATHS_CHECK(IsFullRange(cos(interval<float>(-x, -x))));
+	}
+
+	const double doubles[] = { 9007199254740992.0, 9007199254740994.0, 1e300, std::numeric_limits<double>::max() };
+	for (double x : doubles)
+	{
+		MATHS_CHECK(IsFullRange(sin(interval<double>(x, x))));
+		MATHS_CHECK(IsFullRange(cos(interval<double>(-x, -x))));
+	}
+
+	// Just below the cut-off the search still terminates and encloses the result
+	MATHS_CHECK(Encloses(interval<float>(8388608.0f, 8388612.0f),
+		[](const interval<float>& x) { return sin(x); }, [](long double x) { return std::sin(x); }));
+	MATHS_CHECK(Encloses(interval<double>(4503599627370496.0, 4503599627370497.0),
+		[](const interval<double>& x) { return sin(x); }, [](long double x) { return std::sin(x); }));
+}
\ No newline at end of file
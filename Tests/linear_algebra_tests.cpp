@@ -0,0 +1,176 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Dense matx/vecx and sparse csrmat products, including matrix-vector products written over
+// their own input, and the conjugate gradient solve of a small SPD system with both
+
+using namespace Maths;
+using namespace Maths::LinearAlgebra;
+using namespace Maths::Tests;
+
+namespace {
+
+	matx<double> RandomMatx(size_t rows, size_t cols)
+	{
+		matx<double> result(rows, cols);
+		for (double& element : result.Elements)
+			element = Uniform(-1.0, 1.0);
+		return result;
+	}
+
+	vecx<double> RandomVecx(size_t size)
+	{
+		vecx<double> result(size);
+		for (double& element : result.Elements)
+			element = Uniform(-1.0, 1.0);
+		return result;
+	}
+
+	bool Close(const vecx<double>& lhs, const vecx<double>& rhs)
+	{
+		if (lhs.Size() != rhs.Size())
+			return false;
+		for (size_t i = 0; i < lhs.Size(); i++)
+			if (std::abs(lhs[i] - rhs[i]) > 1e-12 * double(lhs.Size()))
+				return false;
+		return true;
+	}
+
+	vecx<double> NaiveMultiply(const matx<double>& matrix, const vecx<double>& vector)
+	{
+		vecx<double> result(matrix.Rows);
+		for (size_t col = 0; col < matrix.Cols; col++)
+			for (size_t row = 0; row < matrix.Rows; row++)
+				result[row] += matrix(row, col) * vector[col];
+		return result;
+	}
+
+	// 2D Poisson stencil on a side x side grid with a shifted diagonal: symmetric positive
+	// definite, and assembled one edge at a time so every diagonal entry arrives duplicated
+	std::vector<triplet<double>> PoissonTriplets(uint32_t side)
+	{
+		std::vector<triplet<double>> triplets;
+		for (uint32_t y = 0; y < side; y++)
+			for (uint32_t x = 0; x < side; x++)
+			{
+				uint32_t i = y * side + x;
+				triplets.push_back({ i, i, 0.1 });
+				if (x + 1 < side)
+				{
+					uint32_t j = i + 1;
+					triplets.insert(triplets.end(), { { i, i, 1.0 }, { j, j, 1.0 }, { i, j, -1.0 }, { j, i, -1.0 } });
+				}
+				if (y + 1 < side)
+				{
+					uint32_t j = i + side;
+					triplets.insert(triplets.end(), { { i, i, 1.0 }, { j, j, 1.0 }, { i, j, -1.0 }, { j, i, -1.0 } });
+				}
+			}
+		return triplets;
+	}
+
+	matx<double> Dense(size_t rows, size_t cols, const std::vector<triplet<double>>& triplets)
+	{
+		matx<double> result(rows, cols);
+		for (const triplet<double>& entry : triplets)
+			result(entry.Row, entry.Col) += entry.Value;
+		return result;
+	}
+
+}
+
+MATHS_TEST(MatxVectorMultiply)
+{
+	// Small enough to run inline and large enough to split across threads
+	for (size_t size : { size_t(7), size_t(300), size_t(2000) })
+	{
+		matx<double> matrix = RandomMatx(size, size);
+		vecx<double> x = RandomVecx(size);
+		vecx<double> expected = NaiveMultiply(matrix, x);
+
+		vecx<double> out;
+		matx<double>::Multiply(matrix, x, out);
+		MATHS_CHECK(Close(out, expected));
+
+		// Aliased: the result replaces the input rather than reading a zeroed vector
+		matx<double>::Multiply(matrix, x, x);
+		MATHS_CHECK(x.Elements == out.Elements);
+	}
+
+	// Non-square into the input vector, which changes size
+	matx<double> wide = RandomMatx(5, 9);
+	vecx<double> x = RandomVecx(9);
+	vecx<double> expected = NaiveMultiply(wide, x);
+	matx<double>::Multiply(wide, x, x);
+	MATHS_CHECK(Close(x, expected));
+}
+
+MATHS_TEST(CsrmatVectorMultiply)
+{
+	// A 300x200 random pattern with repeated entries, against the dense product
+	std::vector<triplet<double>> triplets;
+	for (int i = 0; i < 3000; i++)
+		triplets.push_back({ uint32_t(Random()() % 300), uint32_t(Random()() % 200), Uniform(-1.0, 1.0) });
+	csrmat<double> sparse = csrmat<double>::FromTriplets(300, 200, triplets);
+	matx<double> dense = Dense(300, 200, triplets);
+
+	vecx<double> x = RandomVecx(200);
+	vecx<double> expected = NaiveMultiply(dense, x);
+	MATHS_CHECK(Close(sparse * x, expected));
+
+	// Aliased, changing size
+	sparse.Multiply(x, x);
+	MATHS_CHECK(Close(x, expected));
+
+	// Square and aliased
+	csrmat<double> square = csrmat<double>::FromTriplets(64, 64, PoissonTriplets(8));
+	vecx<double> y = RandomVecx(64);
+	vecx<double> product = square * y;
+	square.Multiply(y, y);
+	MATHS_CHECK(y.Elements == product.Elements);
+
+	// Duplicated diagonal entries are summed
+	matx<double> squareDense = Dense(64, 64, PoissonTriplets(8));
+	vecx<double> diagonal = square.Diagonal();
+	bool summed = true;
+	for (size_t i = 0; i < 64; i++)
+		summed = summed && diagonal[i] == squareDense(i, i);
+	MATHS_CHECK(summed);
+}
+
+MATHS_TEST(ConjugateGradientSolve)
+{
+	constexpr uint32_t Side = 20;
+	constexpr size_t N = Side * Side;
+
+	std::vector<triplet<double>> triplets = PoissonTriplets(Side);
+	csrmat<double> sparse = csrmat<double>::FromTriplets(N, N, triplets);
+	matx<double> dense = Dense(N, N, triplets);
+	MATHS_CHECK(sparse.NonZeros() == N + 4 * Side * (Side - 1));
+
+	vecx<double> solution = RandomVecx(N);
+	vecx<double> b = sparse * solution;
+
+	vecx<double> x;
+	solver_result<double> result = ConjugateGradient(sparse, b, x, 1000, 1e-12);
+	MATHS_CHECK(result.Converged);
+	MATHS_CHECK(result.Iterations > 0 && result.Iterations < N);
+	for (size_t i = 0; i < N; i++)
+		MATHS_CHECK(std::abs(x[i] - solution[i]) < 1e-8);
+
+	// The dense matrix takes the same iterations to the same answer
+	vecx<double> xDense;
+	solver_result<double> denseResult = ConjugateGradient(dense, b, xDense, 1000, 1e-12);
+	MATHS_CHECK(denseResult.Converged);
+	MATHS_CHECK(denseResult.Iterations == result.Iterations);
+	MATHS_CHECK(Close(xDense, x));
+
+	// Starting from the answer needs no iterations
+	result = ConjugateGradient(sparse, b, solution, 1000, 1e-6);
+	MATHS_CHECK(result.Converged && result.Iterations == 0);
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "harness.h"
+
+#include "Utils/instrumentation.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace Maths::Tests {
+
+	namespace {
+
+		const char* CurrentTest = "";
+		size_t Failures = 0;
+
+	}
+
+	std::vector<test_case>& Registry()
+	{
+		static std::vector<test_case> tests;
+		return tests;
+	}
+
+	std::vector<accuracy_row>& AccuracyRows()
+	{
+		static std::vector<accuracy_row> rows;
+		return rows;
+	}
+
+	bool Register(const char* name, test_function run)
+	{
+		Registry().push_back({ name, run });
+		return true;
+	}
+
+	void Check(bool condition, const char* expression, const char* file, int line)
+	{
+		if (condition)
+			return;
+
+		Failures++;
+		std::printf("FAILED %s: %s (%s:%d)\n", CurrentTest, expression, file, line);
+	}
+
+	void ReportAccuracy(const std::string& kernel, const std::string& inputs, const Utils::ulp_stats& stats, uint64_t limit)
+	{
+		AccuracyRows().push_back({ kernel, inputs, stats, limit });
+
+		if (limit != ReportOnly && stats.Max > limit)
+		{
+			Failures++;
+			std::printf("FAILED %s: %s on %s inputs is off by %llu ulp (limit %llu, worst input %zu)\n", CurrentTest,
+				kernel.c_str(), inputs.c_str(), (unsigned long long)stats.Max, (unsigned long long)limit, stats.WorstIndex);
+		}
+	}
+
+	std::mt19937& Random()
+	{
+		static std::mt19937 generator(12345);
+		return generator;
+	}
+
+	// ULP statistics next to the throughput measured by the instrumentation counters for
+	// the kernel of the same name
+	void PrintReport()
+	{
+		std::vector<Instrumentation::kernel_stats> kernels = Instrumentation::Aggregate();
+
+		std::printf("\n%-28s %-14s %10s %10s %10s %12s\n", "Kernel", "Inputs", "Count", "Max ulp", "Mean ulp", "Melem/s");
+		for (const accuracy_row& row : AccuracyRows())
+		{
+			double throughput = 0.0;
+			for (const Instrumentation::kernel_stats& kernel : kernels)
+			{
+				double milliseconds = kernel.EstimatedMilliseconds();
+				if (kernel.Name == row.Kernel && milliseconds > 0.0)
+					throughput = double(kernel.Elements) / (milliseconds * 1e3);
+			}
+
+			char limit[32];
+			if (row.Limit == ReportOnly)
+				std::snprintf(limit, sizeof(limit), "(report)");
+			else
+				std::snprintf(limit, sizeof(limit), "<= %llu", (unsigned long long)row.Limit);
+
+			// Results that are NaN or infinite where the reference is not saturate the error
+			char max[32], mean[32];
+			if (row.Stats.Max == std::numeric_limits<uint64_t>::max())
+			{
+				std::snprintf(max, sizeof(max), "nonfinite");
+				std::snprintf(mean, sizeof(mean), "-");
+			}
+			else
+			{
+				std::snprintf(max, sizeof(max), "%llu", (unsigned long long)row.Stats.Max);
+				std::snprintf(mean, sizeof(mean), "%.3f", row.Stats.Mean());
+			}
+
+			std::printf("%-28s %-14s %10llu %10s %10s %12.1f  %s\n", row.Kernel.c_str(), row.Inputs.c_str(),
+				(unsigned long long)row.Stats.Count, max, mean, throughput, limit);
+		}
+	}
+
+}
+
+// maths_tests [name...] runs the tests whose names contain any of the arguments, or all
+int main(int argc, char** argv)
+{
+	using namespace Maths::Tests;
+
+	for (const test_case& test : Registry())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+			selected = selected || std::strstr(test.Name, argv[i]) != nullptr;
+		if (!selected)
+			continue;
+
+		CurrentTest = test.Name;
+		size_t failuresBefore = Failures;
+		try
+		{
+			test.Run();
+		}
+		catch (const std::exception& e)
+		{
+			Failures++;
+			std::printf("FAILED %s: exception %s\n", test.Name, e.what());
+		}
+		std::printf("%s %s\n", Failures == failuresBefore ? "passed" : "FAILED", test.Name);
+	}
+
+	PrintReport();
+
+	std::printf("\n%zu failure(s)\n", Failures);
+	return Failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// ParallelFor on its persistent workers: every index visited once over many calls in a
+// row, exceptions from a worker range reaching the caller, and nested calls running inline
+
+using namespace Maths;
+using namespace Maths::Tests;
+
+namespace {
+
+	// Runs the test with four threads whatever the machine has, so the pool is used
+	struct thread_count_scope
+	{
+		size_t Previous = Utils::MaxThreads.exchange(4);
+		~thread_count_scope() { Utils::MaxThreads.store(Previous); }
+	};
+
+}
+
+MATHS_TEST(ParallelForCoverage)
+{
+	thread_count_scope threads;
+
+	std::vector<std::atomic<int>> visits(10007);
+	bool covered = true;
+	for (int round = 0; round < 2000; round++)
+	{
+		Utils::ParallelFor(visits.size(), 64, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				visits[i].fetch_add(1, std::memory_order_relaxed);
+		});
+
+		for (std::atomic<int>& visit : visits)
+			covered = covered && visit.exchange(0) == 1;
+	}
+	MATHS_CHECK(covered);
+
+	// Nested calls run inline on the workers rather than waiting on them
+	std::atomic<size_t> inner{ 0 };
+	Utils::ParallelFor(64, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+			Utils::ParallelFor(100, 1, [&](size_t first, size_t last) { inner.fetch_add(last - first); });
+	});
+	MATHS_CHECK(inner.load() == 6400);
+}
+
+// Whichever range throws, the caller gets the exception after every started range has
+// finished, and the pool keeps working afterwards
+MATHS_TEST(ParallelForExceptions)
+{
+	thread_count_scope threads;
+
+	for (size_t thrower = 0; thrower < 4; thrower++)
+	{
+		std::atomic<int> running{ 0 };
+		bool caught = false;
+		try
+		{
+			Utils::ParallelFor(4000, 1000, [&](size_t begin, size_t end)
+			{
+				running.fetch_add(1);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				running.fetch_sub(1);
+				if (begin / 1000 == thrower)
+					throw std::runtime_error("range failed");
+				(void)end;
+			});
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+		MATHS_CHECK(caught);
+		MATHS_CHECK(running.load() == 0);
+	}
+
+	std::atomic<size_t> total{ 0 };
+	Utils::ParallelFor(4000, 1000, [&](size_t begin, size_t end) { total.fetch_add(end - begin); });
+	MATHS_CHECK(total.load() == 4000);
+}
+
+// Cost of an almost empty call, which used to start and join a thread per range
+MATHS_TEST(ParallelForOverhead)
+{
+	thread_count_scope threads;
+
+	constexpr int Calls = 2000;
+	std::atomic<size_t> total{ 0 };
+
+	using clock = std::chrono::steady_clock;
+	clock::time_point start = clock::now();
+	for (int call = 0; call < Calls; call++)
+		Utils::ParallelFor(4, 1, [&](size_t begin, size_t end) { total.fetch_add(end - begin, std::memory_order_relaxed); });
+	double microseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / Calls;
+
+	MATHS_CHECK(total.load() == 4 * size_t(Calls));
+	std::printf("  ParallelFor: %.1f us per call with 4 ranges\n", microseconds);
+}
\ No newline at end of file
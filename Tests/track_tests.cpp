@@ -0,0 +1,185 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// SampleTracks against per-track Sample, bit for bit, over playback, seeks and every
+// interpolation mode, in mixed groups and in groups of four that take the lanes4 path,
+// plus shared tracks sampled from two threads with their own cursors
+
+using namespace Maths;
+using namespace Maths::Animation;
+using namespace Maths::Containers;
+using namespace Maths::Tests;
+
+namespace {
+
+	template <typename V>
+	V RandomValue();
+
+	template <>
+	vec3<float> RandomValue<vec3<float>>()
+	{
+		return vec3<float>(Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f));
+	}
+
+	template <>
+	vec4<float> RandomValue<vec4<float>>()
+	{
+		return vec4<float>(Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f));
+	}
+
+	template <>
+	quat<float> RandomValue<quat<float>>()
+	{
+		return quat<float>::Rotation(Uniform(-180.0f, 180.0f), vec3<float>(Uniform(-1.0f, 1.0f), Uniform(-1.0f, 1.0f), 1.0f));
+	}
+
+	// Tracks with 0 to 40 keys over roughly [0, 10], cycling through the interpolation modes
+	template <typename V>
+	std::vector<track<V>> RandomTracks(size_t count)
+	{
+		std::vector<track<V>> tracks(count);
+		for (size_t n = 0; n < count; n++)
+		{
+			track<V>& track = tracks[n];
+			track.Interpolation = interpolation(n % 3);
+
+			size_t keys = n % 41;
+			float time = Uniform(-0.5f, 0.5f);
+			for (size_t k = 0; k < keys; k++)
+			{
+				track.AddKey(time, RandomValue<V>(), RandomValue<V>(), RandomValue<V>());
+				time += Uniform(0.05f, 0.5f);
+			}
+		}
+		return tracks;
+	}
+
+	// All tracks in one mode, so whole groups of four take the lanes4 path
+	template <typename V>
+	std::vector<track<V>> RandomTracks(size_t count, interpolation mode)
+	{
+		std::vector<track<V>> tracks = RandomTracks<V>(count);
+		for (track<V>& track : tracks)
+			track.Interpolation = mode;
+		return tracks;
+	}
+
+	// Forward playback, then a seek back to the start and a jump forward
+	std::vector<float> PlaybackTimes()
+	{
+		std::vector<float> times;
+		for (float time = -1.0f; time < 12.0f; time += 1.0f / 60.0f)
+			times.push_back(time);
+		times.push_back(0.0f);
+		times.push_back(7.3f);
+		return times;
+	}
+
+	template <typename V>
+	bool BatchMatchesSingle(const std::vector<track<V>>& tracks)
+	{
+		std::vector<size_t> batchCursors(tracks.size(), 0), singleCursors(tracks.size(), 0);
+		std::vector<V> batch(tracks.size()), single(tracks.size());
+
+		bool identical = true;
+		for (float time : PlaybackTimes())
+		{
+			SampleTracks(tracks.data(), tracks.size(), time, batchCursors.data(), batch.data());
+			for (size_t n = 0; n < tracks.size(); n++)
+				single[n] = tracks[n].Sample(time, singleCursors[n]);
+
+			identical = identical && std::memcmp(batch.data(), single.data(), batch.size() * sizeof(V)) == 0;
+			identical = identical && batchCursors == singleCursors;
+		}
+		return identical;
+	}
+
+}
+
+MATHS_TEST(SampleTracksBatch)
+{
+	MATHS_CHECK(BatchMatchesSingle(RandomTracks<vec3<float>>(500)));
+	MATHS_CHECK(BatchMatchesSingle(RandomTracks<quat<float>>(500)));
+	MATHS_CHECK(BatchMatchesSingle(RandomTracks<vec3<float>>(501, interpolation::Linear)));
+	MATHS_CHECK(BatchMatchesSingle(RandomTracks<vec3<float>>(502, interpolation::Cubic)));
+	MATHS_CHECK(BatchMatchesSingle(RandomTracks<vec4<float>>(503, interpolation::Cubic)));
+	MATHS_CHECK(BatchMatchesSingle(RandomTracks<quat<float>>(500, interpolation::Cubic)));
+
+	// Without a cursor Sample searches from scratch and gives the same values
+	std::vector<track<vec3<float>>> tracks = RandomTracks<vec3<float>>(100);
+	bool identical = true;
+	for (const track<vec3<float>>& track : tracks)
+	{
+		size_t cursor = 0;
+		for (float time : PlaybackTimes())
+		{
+			vec3<float> withCursor = track.Sample(time, cursor);
+			vec3<float> without = track.Sample(time);
+			identical = identical && std::memcmp(&withCursor, &without, sizeof(without)) == 0;
+		}
+	}
+	MATHS_CHECK(identical);
+}
+
+// Two playbacks of the same tracks at different times, each with its own cursors
+MATHS_TEST(SampleTracksShared)
+{
+	const std::vector<track<vec3<float>>> tracks = RandomTracks<vec3<float>>(300);
+	std::vector<float> times = PlaybackTimes();
+
+	auto play = [&](float offset, std::vector<vec3<float>>& last)
+	{
+		std::vector<size_t> cursors(tracks.size(), 0);
+		last.resize(tracks.size());
+		for (float time : times)
+			SampleTracks(tracks.data(), tracks.size(), time + offset, cursors.data(), last.data());
+	};
+
+	std::vector<vec3<float>> first, second, expected;
+	std::thread other([&]() { play(3.0f, second); });
+	play(0.0f, first);
+	other.join();
+
+	play(3.0f, expected);
+	MATHS_CHECK(std::memcmp(second.data(), expected.data(), expected.size() * sizeof(vec3<float>)) == 0);
+	play(0.0f, expected);
+	MATHS_CHECK(std::memcmp(first.data(), expected.data(), expected.size() * sizeof(vec3<float>)) == 0);
+}
+
+// Batched sampling of a skeleton's worth of linear tracks against the per-track loop
+MATHS_TEST(SampleTracksThroughput)
+{
+	constexpr size_t TrackCount = 4096;
+	constexpr int Frames = 600;
+
+	std::vector<track<vec3<float>>> tracks(TrackCount);
+	for (track<vec3<float>>& track : tracks)
+		for (int k = 0; k < 32; k++)
+			track.AddKey(float(k) * 0.25f, RandomValue<vec3<float>>());
+
+	using clock = std::chrono::steady_clock;
+	std::vector<vec3<float>> batch(TrackCount), single(TrackCount);
+	std::vector<size_t> batchCursors(TrackCount, 0), singleCursors(TrackCount, 0);
+
+	clock::time_point start = clock::now();
+	for (int frame = 0; frame < Frames; frame++)
+		for (size_t n = 0; n < TrackCount; n++)
+			single[n] = tracks[n].Sample(float(frame) / 75.0f, singleCursors[n]);
+	double singleTime = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+	start = clock::now();
+	for (int frame = 0; frame < Frames; frame++)
+		SampleTracks(tracks.data(), TrackCount, float(frame) / 75.0f, batchCursors.data(), batch.data());
+	double batchTime = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+	MATHS_CHECK(std::memcmp(batch.data(), single.data(), batch.size() * sizeof(vec3<float>)) == 0);
+	std::printf("  SampleTracks: per-track loop %.1f ms, batched %.1f ms (%.0f Msamples/s)\n",
+		singleTime, batchTime, double(TrackCount) * Frames / (batchTime * 1e3));
+}
\ No newline at end of file
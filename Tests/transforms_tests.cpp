@@ -0,0 +1,224 @@
+#include "harness.h"
+
+#include "Maths.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// Cached transforms and cameras: every change must reach the derived products on the
+// next read, and the threaded refresh must leave them as a direct rebuild would.
+// Projection builders: their depth conventions and round trips through the closed-form
+// inverses.
+
+using namespace Maths;
+using namespace Maths::Containers;
+using namespace Maths::Transforms;
+using namespace Maths::Tests;
+
+namespace {
+
+	mat4<double> RandomWorld()
+	{
+		vec3<double> axis(Uniform(-1.0, 1.0), Uniform(-1.0, 1.0), Uniform(-1.0, 1.0) + 3.0);
+		return mat4<double>::Translation(vec3<double>(Uniform(-10.0, 10.0), Uniform(-10.0, 10.0), Uniform(-10.0, 10.0)))
+			* mat4<double>::Rotation(Uniform(-180.0, 180.0), axis)
+			* mat4<double>::Scale(vec3<double>(Uniform(0.5, 2.0), Uniform(0.5, 2.0), Uniform(0.5, 2.0)));
+	}
+
+	template <size_t C, size_t R>
+	bool Close(const mat<C, R, double>& lhs, const mat<C, R, double>& rhs, double tolerance = 1e-9)
+	{
+		for (size_t i = 0; i < C * R; i++)
+			if (std::abs(lhs.Elements[i] - rhs.Elements[i]) > tolerance)
+				return false;
+		return true;
+	}
+
+	bool Same(const mat4<double>& lhs, const mat4<double>& rhs)
+	{
+		return std::memcmp(lhs.Elements, rhs.Elements, sizeof(lhs.Elements)) == 0;
+	}
+
+	// Projects a view space point to NDC
+	vec3<double> Project(const mat4<double>& projection, const vec3<double>& point)
+	{
+		vec4<double> clip = projection * vec4<double>(point, 1.0);
+		return vec3<double>(clip.X / clip.W, clip.Y / clip.W, clip.Z / clip.W);
+	}
+
+	bool Close(const vec3<double>& lhs, const vec3<double>& rhs, double tolerance)
+	{
+		return std::abs(lhs.X - rhs.X) <= tolerance && std::abs(lhs.Y - rhs.Y) <= tolerance && std::abs(lhs.Z - rhs.Z) <= tolerance;
+	}
+
+	struct thread_count_scope
+	{
+		size_t Previous = Utils::MaxThreads.exchange(4);
+		~thread_count_scope() { Utils::MaxThreads.store(Previous); }
+	};
+
+}
+
+MATHS_TEST(CachedTransformInvalidation)
+{
+	cached_transform<double> transform;
+	MATHS_CHECK(transform.IsStale());
+	MATHS_CHECK(Close(transform.Inverse(), mat4<double>(1.0)));
+
+	for (int i = 0; i < 100; i++)
+	{
+		mat4<double> world = RandomWorld();
+		uint64_t version = transform.Version();
+		transform.Set(world);
+		MATHS_CHECK(transform.Version() != version);
+		MATHS_CHECK(transform.IsStale());
+
+		MATHS_CHECK(Close(transform.Inverse() * world, mat4<double>(1.0)));
+		MATHS_CHECK(Close(transform.NormalMatrix(), mat3<double>::Transpose(mat3<double>::Inverse(mat3<double>(world)))));
+		MATHS_CHECK(!transform.IsStale());
+	}
+
+	// Invalidate rebuilds from the same world, and Refresh leaves nothing stale
+	mat4<double> inverse = transform.Inverse();
+	transform.Invalidate();
+	MATHS_CHECK(transform.IsStale());
+	transform.Refresh();
+	MATHS_CHECK(!transform.IsStale());
+	MATHS_CHECK(Same(transform.Inverse(), inverse));
+
+	// A general projective world takes the full 4x4 inverse
+	mat4<double> projective = mat4<double>::Perspective(60.0f, 1.5f, 0.1f, 100.0f) * RandomWorld();
+	transform.Set(projective);
+	MATHS_CHECK(Close(transform.Inverse() * projective, mat4<double>(1.0)));
+}
+
+MATHS_TEST(CachedCameraInvalidation)
+{
+	cached_camera<double> camera;
+	MATHS_CHECK(Close(camera.ViewProjection(), mat4<double>(1.0)));
+
+	for (int i = 0; i < 100; i++)
+	{
+		mat4<double> view = mat4<double>::LookAt(vec3<double>(Uniform(-10.0, 10.0), Uniform(-10.0, 10.0), 20.0), vec3<double>(0.0));
+		mat4<double> projection = mat4<double>::Perspective(Uniform(30.0f, 90.0f), 1.5f, 0.1f, 100.0f);
+
+		// Changing either half must show in both derived products
+		if (i % 2)
+			camera.SetView(view);
+		else
+			camera.SetProjection(projection);
+		MATHS_CHECK(Close(camera.ViewProjection(), camera.Projection() * camera.View()));
+		MATHS_CHECK(Close(camera.InverseViewProjection() * camera.ViewProjection(), mat4<double>(1.0)));
+	}
+
+	// The inverse alone is read after a change, then the product
+	camera.SetView(mat4<double>::Translation(vec3<double>(1.0, 2.0, 3.0)));
+	camera.Refresh();
+	MATHS_CHECK(Close(camera.InverseViewProjection() * (camera.Projection() * camera.View()), mat4<double>(1.0)));
+	MATHS_CHECK(Same(camera.ViewProjection(), camera.Projection() * camera.View()));
+}
+
+MATHS_TEST(RefreshTransformsBatch)
+{
+	thread_count_scope threads;
+
+	constexpr size_t Count = 5000;
+	std::vector<cached_transform<double>> transforms(Count);
+	std::vector<mat4<double>> worlds(Count);
+	for (size_t i = 0; i < Count; i++)
+	{
+		worlds[i] = RandomWorld();
+		transforms[i].Set(worlds[i]);
+	}
+
+	// Change a subset after a first refresh, as a moving parent would
+	RefreshTransforms(transforms.data(), Count);
+	std::vector<uint32_t> moved;
+	for (uint32_t i = 0; i < Count; i += 7)
+		moved.push_back(i);
+	std::vector<mat4<double>> movedWorlds(moved.size());
+	for (size_t i = 0; i < moved.size(); i++)
+		worlds[moved[i]] = movedWorlds[i] = RandomWorld();
+	SetTransforms(transforms.data(), moved.data(), movedWorlds.data(), moved.size());
+	InvalidateTransforms(transforms.data(), moved.data() + 1, 1);
+	RefreshTransforms(transforms.data(), Count);
+
+	bool correct = true;
+	for (size_t i = 0; i < Count; i++)
+	{
+		correct = correct && !transforms[i].IsStale();
+		correct = correct && Same(transforms[i].Inverse(), Transforms::Detail::InverseWorld(worlds[i]));
+	}
+	MATHS_CHECK(correct);
+}
+
+MATHS_TEST(ProjectionDepthRanges)
+{
+	const float n = 0.5f, f = 400.0f;
+	const double infinity = std::numeric_limits<float>::infinity();
+
+	// Where the near and far planes land, from the centre of the view
+	mat4<double> standard = mat4<double>::Perspective(60.0f, 1.5f, n, f);
+	MATHS_CHECK(std::abs(Project(standard, vec3<double>(0.0, 0.0, -n)).Z + 1.0) < 1e-6);
+	MATHS_CHECK(std::abs(Project(standard, vec3<double>(0.0, 0.0, -f)).Z - 1.0) < 1e-6);
+
+	mat4<double> reverse = mat4<double>::PerspectiveReverseZ(60.0f, 1.5f, n, f);
+	MATHS_CHECK(std::abs(Project(reverse, vec3<double>(0.0, 0.0, -n)).Z - 1.0) < 1e-6);
+	MATHS_CHECK(std::abs(Project(reverse, vec3<double>(0.0, 0.0, -f)).Z) < 1e-6);
+
+	// Without a far plane depth only reaches 0 (reverse) or 1 at infinity
+	mat4<double> reverseInfinite = mat4<double>::PerspectiveReverseZ(60.0f, 1.5f, n, float(infinity));
+	MATHS_CHECK(std::abs(Project(reverseInfinite, vec3<double>(0.0, 0.0, -n)).Z - 1.0) < 1e-6);
+	MATHS_CHECK(Project(reverseInfinite, vec3<double>(0.0, 0.0, -1e9)).Z > 0.0 && Project(reverseInfinite, vec3<double>(0.0, 0.0, -1e9)).Z < 1e-9);
+
+	mat4<double> infinite = mat4<double>::PerspectiveInfinite(60.0f, 1.5f, n);
+	MATHS_CHECK(std::abs(Project(infinite, vec3<double>(0.0, 0.0, -n)).Z + 1.0) < 1e-6);
+	MATHS_CHECK(Project(infinite, vec3<double>(0.0, 0.0, -1e9)).Z < 1.0 && Project(infinite, vec3<double>(0.0, 0.0, -1e9)).Z > 1.0 - 1e-8);
+
+	// The infinite projection is the limit of Perspective, and the symmetric frustum equals
+	// it (up to the float arithmetic of the builders)
+	MATHS_CHECK(Close(mat4<double>::Perspective(60.0f, 1.5f, n, 1e30f), infinite, 1e-6));
+	double top = n * std::tan(0.5 * 60.0 * 0.0174533), right = top * 1.5;
+	MATHS_CHECK(Close(mat4<double>::Frustum(float(-right), float(right), float(-top), float(top), n, f), standard, 1e-6));
+
+	// An off-centre frustum puts its near rectangle on the edges of NDC
+	mat4<double> frustum = mat4<double>::Frustum(-0.1f, 0.3f, -0.2f, 0.05f, n, f);
+	MATHS_CHECK(Close(Project(frustum, vec3<double>(-0.1, -0.2, -n)), vec3<double>(-1.0, -1.0, -1.0), 1e-6));
+	MATHS_CHECK(Close(Project(frustum, vec3<double>(0.3, 0.05, -n)), vec3<double>(1.0, 1.0, -1.0), 1e-6));
+	MATHS_CHECK(Close(Project(frustum, vec3<double>(0.3 * f / n, -0.2 * f / n, -f)), vec3<double>(1.0, -1.0, 1.0), 1e-6));
+}
+
+MATHS_TEST(ProjectionInverseRoundTrip)
+{
+	const float n = 0.1f, f = 1000.0f;
+	const mat4<double> projections[] = {
+		mat4<double>::Perspective(75.0f, 16.0f / 9.0f, n, f),
+		mat4<double>::PerspectiveReverseZ(75.0f, 16.0f / 9.0f, n, f),
+		mat4<double>::PerspectiveReverseZ(40.0f, 0.75f, n, std::numeric_limits<float>::infinity()),
+		mat4<double>::PerspectiveInfinite(90.0f, 2.0f, n),
+		mat4<double>::Frustum(-0.05f, 0.15f, -0.02f, 0.08f, n, f)
+	};
+
+	for (const mat4<double>& projection : projections)
+	{
+		mat4<double> inverse = mat4<double>::InversePerspective(projection);
+		MATHS_CHECK(Close(inverse * projection, mat4<double>(1.0)) && Close(projection * inverse, mat4<double>(1.0)));
+		MATHS_CHECK(Close(inverse, mat4<double>::Inverse(projection)));
+
+		// View space points in front of the camera come back from NDC
+		bool roundTrip = true;
+		for (int i = 0; i < 1000; i++)
+		{
+			double depth = Uniform(0.2, 900.0);
+			vec3<double> point(Uniform(-1.0, 1.0) * depth, Uniform(-1.0, 1.0) * depth, -depth);
+			vec4<double> back = inverse * vec4<double>(Project(projection, point), 1.0);
+			roundTrip = roundTrip && Close(vec3<double>(back.X, back.Y, back.Z) / back.W, point, 1e-9 * depth * depth);
+		}
+		MATHS_CHECK(roundTrip);
+	}
+
+	mat4<double> orthographic = mat4<double>::Orthographic(-4.0f, 6.0f, -3.0f, 2.0f, n, f);
+	MATHS_CHECK(Close(mat4<double>::InverseOrthographic(orthographic) * orthographic, mat4<double>(1.0)));
+}
\ No newline at end of file